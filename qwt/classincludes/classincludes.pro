@@ -54,6 +54,9 @@ CLASSHEADERS = \
     QwtPoint3D \
     QwtPointPolar \
     QwtPowerTransform \
+    QwtRenderJob \
+    QwtRenderScheduler \
+    QwtRenderToken \
     QwtRichTextEngine \
     QwtRoundScaleDraw \
     QwtSaturationValueColorMap \
@@ -95,6 +98,7 @@ contains(QWT_CONFIG, QwtPlot) {
         QwtLegendLabel \
         QwtPointMapper \
         QwtMatrixRasterData \
+        QwtWaterfallRasterData \
         QwtOHLCSample \
         QwtPlot \
         QwtPlotAbstractBarChart \
@@ -118,6 +122,7 @@ contains(QWT_CONFIG, QwtPlot) {
         QwtPlotPicker \
         QwtPlotRasterItem \
         QwtPlotRenderer \
+        QwtPlotReplotScheduler \
         QwtPlotRescaler \
         QwtPlotScaleItem \
         QwtPlotSeriesItem \
@@ -141,6 +146,12 @@ contains(QWT_CONFIG, QwtPlot) {
         QwtSetSeriesData \
         QwtSyntheticPointData \
         QwtPointArrayData \
+        QwtPyramidPointData \
+        QwtMappedPointData \
+        QwtMappedRasterData \
+        QwtAppendablePointData \
+        QwtLockFreePointData \
+        QwtSpatialIndex \
         QwtTradingChartData \
         QwtVectorFieldSymbol \
         QwtVectorFieldArrow \
@@ -83,6 +83,12 @@ RandomPlot::RandomPlot( QWidget *parent ):
     setAxisScale( xBottom, 0, c_rangeMax );
     setAxisScale( yLeft, 0, c_rangeMax );
 
+    // the labels are reused, when scrolling the zoomed scales
+    axisScaleDraw( xBottom )->setLabelCacheAttribute(
+        QwtAbstractScaleDraw::PersistentLabels, true );
+    axisScaleDraw( yLeft )->setLabelCacheAttribute(
+        QwtAbstractScaleDraw::PersistentLabels, true );
+
     replot();
 
     // enable zooming
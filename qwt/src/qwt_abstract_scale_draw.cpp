@@ -15,17 +15,78 @@
 
 #include <qpainter.h>
 #include <qpalette.h>
-#include <qmap.h>
+#include <qcache.h>
+#include <qimage.h>
 #include <qlist.h>
 #include <qlocale.h>
 
+#include <cstring>
+
+namespace
+{
+    class QwtLabelCacheKey
+    {
+    public:
+        QwtLabelCacheKey( double value, int font, int format ):
+            value( value ),
+            font( font ),
+            format( format )
+        {
+        }
+
+        inline bool operator==( const QwtLabelCacheKey &other ) const
+        {
+            return ( value == other.value ) && ( font == other.font )
+                && ( format == other.format );
+        }
+
+        double value;
+        int font;
+        int format;
+    };
+
+    inline uint qHash( const QwtLabelCacheKey &key )
+    {
+        // 0.0 and -0.0 are equal, but have different bits
+        const double value = ( key.value == 0.0 ) ? 0.0 : key.value;
+
+        quint64 bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+
+        return ::qHash( bits ) ^ uint( key.font << 8 ) ^ uint( key.format << 16 );
+    }
+
+    class QwtLabelCacheEntry
+    {
+    public:
+        explicit QwtLabelCacheEntry( const QwtText &text ):
+            text( text ),
+            imageColor( 0 ),
+            imageRatio( 0.0 )
+        {
+        }
+
+        QwtText text;
+
+        // pre-rendered, when LabelImages is enabled
+        QImage image;
+        QRgb imageColor;
+        qreal imageRatio;
+    };
+}
+
+static const int qwtMaxLabelFonts = 8;
+
 class QwtAbstractScaleDraw::PrivateData
 {
 public:
     PrivateData():
         spacing( 4.0 ),
         penWidthF( 0.0 ),
-        minExtent( 0.0 )
+        minExtent( 0.0 ),
+        labelCache( 1000 ),
+        labelFormat( 0 ),
+        isLabelFormatValid( false )
     {
         components = QwtAbstractScaleDraw::Backbone
             | QwtAbstractScaleDraw::Ticks
@@ -47,9 +108,59 @@ public:
 
     double minExtent;
 
-    QMap<double, QwtText> labelCache;
+    LabelCacheAttributes labelCacheAttributes;
+
+    QCache<QwtLabelCacheKey, QwtLabelCacheEntry> labelCache;
+    QList<QFont> labelFonts;
+
+    // labelFormat() for the current scale division
+    int labelFormat;
+    bool isLabelFormatValid;
+
+    QwtLabelCacheEntry *cacheEntry( const QwtAbstractScaleDraw *,
+        const QFont &, double value );
 };
 
+QwtLabelCacheEntry *QwtAbstractScaleDraw::PrivateData::cacheEntry(
+    const QwtAbstractScaleDraw *scaleDraw, const QFont &font, double value )
+{
+    if ( !isLabelFormatValid )
+    {
+        labelFormat = scaleDraw->labelFormat();
+        isLabelFormatValid = true;
+    }
+
+    int fontIndex = labelFonts.indexOf( font );
+    if ( fontIndex < 0 )
+    {
+        if ( labelFonts.size() >= qwtMaxLabelFonts )
+        {
+            labelFonts.clear();
+            labelCache.clear();
+        }
+
+        labelFonts += font;
+        fontIndex = labelFonts.size() - 1;
+    }
+
+    const QwtLabelCacheKey key( value, fontIndex, labelFormat );
+
+    QwtLabelCacheEntry *entry = labelCache.object( key );
+    if ( entry == NULL )
+    {
+        QwtText lbl = scaleDraw->label( value );
+        lbl.setRenderFlags( 0 );
+        lbl.setLayoutAttribute( QwtText::MinimumLayout );
+
+        ( void )lbl.textSize( font ); // initialize the internal cache
+
+        entry = new QwtLabelCacheEntry( lbl );
+        labelCache.insert( key, entry );
+    }
+
+    return entry;
+}
+
 /*!
   \brief Constructor
 
@@ -105,7 +216,10 @@ void QwtAbstractScaleDraw::setScaleDiv( const QwtScaleDiv &scaleDiv )
 {
     d_data->scaleDiv = scaleDiv;
     d_data->map.setScaleInterval( scaleDiv.lowerBound(), scaleDiv.upperBound() );
-    d_data->labelCache.clear();
+    d_data->isLabelFormatValid = false;
+
+    if ( !( d_data->labelCacheAttributes & PersistentLabels ) )
+        d_data->labelCache.clear();
 }
 
 /*!
@@ -386,36 +500,165 @@ QwtText QwtAbstractScaleDraw::label( double value ) const
    calculation of the label sizes might be slow (really slow
    for rich text in Qt4), so it's necessary to cache the labels.
 
+   The labels are stored in a LRU cache, that is bounded
+   by labelCacheSize().
+
    \param font Font
    \param value Value
 
    \return Tick label
+
+   \note The reference is valid until the next label is
+         inserted into the cache.
+   \sa setLabelCacheAttribute(), labelFormat()
 */
 const QwtText &QwtAbstractScaleDraw::tickLabel(
     const QFont &font, double value ) const
 {
-    QMap<double, QwtText>::const_iterator it1 = d_data->labelCache.constFind( value );
-    if ( it1 != d_data->labelCache.constEnd() )
-        return *it1;
+    return d_data->cacheEntry( this, font, value )->text;
+}
+
+/*!
+   \brief Tick label, that has been rendered to an image
+
+   The image is rendered with the font, the pen color and the
+   device pixel ratio of the painter and stored together with
+   the tick label, so that it can be blitted without laying out
+   the text again.
+
+   \param painter Painter
+   \param value Value
+
+   \return Tick label as image, or a null image,
+           when LabelImages is not enabled
+
+   \sa tickLabel(), LabelImages
+*/
+QImage QwtAbstractScaleDraw::tickLabelImage(
+    const QPainter *painter, double value ) const
+{
+    if ( !( d_data->labelCacheAttributes & LabelImages ) )
+        return QImage();
+
+    QwtLabelCacheEntry *entry =
+        d_data->cacheEntry( this, painter->font(), value );
+
+    if ( entry->text.isEmpty() )
+        return QImage();
 
-    QwtText lbl = label( value );
-    lbl.setRenderFlags( 0 );
-    lbl.setLayoutAttribute( QwtText::MinimumLayout );
+    const QRgb color = painter->pen().color().rgba();
+    const qreal pixelRatio = QwtPainter::devicePixelRatio( painter->device() );
 
-    ( void )lbl.textSize( font ); // initialize the internal cache
+    if ( entry->image.isNull() || entry->imageColor != color
+        || entry->imageRatio != pixelRatio )
+    {
+        const QSize size = entry->text.textSize( painter->font() ).toSize();
+        if ( size.isEmpty() )
+            return QImage();
+
+#if QT_VERSION >= 0x050000
+        QImage image( size * pixelRatio, QImage::Format_ARGB32_Premultiplied );
+        image.setDevicePixelRatio( pixelRatio );
+#else
+        QImage image( size, QImage::Format_ARGB32_Premultiplied );
+#endif
+        image.fill( 0 );
+
+        QPainter imagePainter( &image );
+        imagePainter.setRenderHints( painter->renderHints() );
+        imagePainter.setFont( painter->font() );
+        imagePainter.setPen( painter->pen() );
+
+        entry->text.draw( &imagePainter, QRect( QPoint( 0, 0 ), size ) );
+        imagePainter.end();
+
+        entry->image = image;
+        entry->imageColor = color;
+        entry->imageRatio = pixelRatio;
+    }
+
+    return entry->image;
+}
+
+/*!
+   \brief Identifier of the format of the labels
 
-    QMap<double, QwtText>::iterator it2 = d_data->labelCache.insert( value, lbl );
-    return *it2;
+   The tick labels are cached for each format. labelFormat() is called
+   once for each scale division and needs to be overloaded, when label()
+   depends on the scale division and PersistentLabels is enabled.
+   F.e. QwtDateScaleDraw returns the interval type of the scale division.
+
+   \return 0
+   \sa PersistentLabels, tickLabel()
+*/
+int QwtAbstractScaleDraw::labelFormat() const
+{
+    return 0;
+}
+
+/*!
+   Change an attribute of the cache for the tick labels
+
+   \param attribute Attribute
+   \param on On/Off
+
+   \sa LabelCacheAttribute, testLabelCacheAttribute()
+*/
+void QwtAbstractScaleDraw::setLabelCacheAttribute(
+    LabelCacheAttribute attribute, bool on )
+{
+    if ( on )
+        d_data->labelCacheAttributes |= attribute;
+    else
+        d_data->labelCacheAttributes &= ~attribute;
+}
+
+/*!
+   \return True, when attribute is enabled
+   \sa LabelCacheAttribute, setLabelCacheAttribute()
+*/
+bool QwtAbstractScaleDraw::testLabelCacheAttribute(
+    LabelCacheAttribute attribute ) const
+{
+    return d_data->labelCacheAttributes & attribute;
+}
+
+/*!
+   \brief Limit the number of cached tick labels
+
+   When the limit is exceeded the labels, that have been
+   used least recently, are removed from the cache.
+
+   \param numLabels Maximum number of cached labels
+   \sa labelCacheSize(), tickLabel()
+
+   \note The default limit is 1000
+*/
+void QwtAbstractScaleDraw::setLabelCacheSize( int numLabels )
+{
+    d_data->labelCache.setMaxCost( qMax( numLabels, 1 ) );
+}
+
+/*!
+   \return Maximum number of cached labels
+   \sa setLabelCacheSize()
+*/
+int QwtAbstractScaleDraw::labelCacheSize() const
+{
+    return d_data->labelCache.maxCost();
 }
 
 /*!
    Invalidate the cache used by tickLabel()
 
-   The cache is invalidated, when a new QwtScaleDiv is set. If
-   the labels need to be changed. while the same QwtScaleDiv is set,
-   invalidateCache() needs to be called manually.
+   Unless PersistentLabels is enabled the cache is invalidated,
+   when a new QwtScaleDiv is set. If the labels need to be changed,
+   while the same QwtScaleDiv is set, invalidateCache() needs
+   to be called manually.
 */
 void QwtAbstractScaleDraw::invalidateCache()
 {
     d_data->labelCache.clear();
+    d_data->labelFonts.clear();
+    d_data->isLabelFormatValid = false;
 }
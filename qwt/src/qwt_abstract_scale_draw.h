@@ -19,6 +19,7 @@ class QPainter;
 class QFont;
 class QwtTransform;
 class QwtScaleMap;
+class QImage;
 
 /*!
   \brief A abstract base class for drawing scales
@@ -51,6 +52,36 @@ public:
     //! Scale components
     typedef QFlags<ScaleComponent> ScaleComponents;
 
+    /*!
+       Attributes of the cache for the tick labels
+       \sa setLabelCacheAttribute(), tickLabel()
+    */
+    enum LabelCacheAttribute
+    {
+        /*!
+          Keep the labels, when a new scale division is assigned.
+
+          Scrolling scales reuse most of their labels from the
+          previous scale division. Enabling PersistentLabels is
+          only possible, when label() depends on the value and
+          labelFormat() only.
+         */
+        PersistentLabels = 0x01,
+
+        /*!
+          Cache the labels also as images, that are blitted instead
+          of laying out and rendering the text again. The images are
+          used for raster paint devices and labels, that are not rotated.
+
+          \note Images can't be rendered with subpixel antialiasing,
+                so the labels might look slightly different.
+         */
+        LabelImages = 0x02
+    };
+
+    //! Label cache attributes
+    typedef QFlags<LabelCacheAttribute> LabelCacheAttributes;
+
     QwtAbstractScaleDraw();
     virtual ~QwtAbstractScaleDraw();
 
@@ -95,6 +126,12 @@ public:
     void setMinimumExtent( double );
     double minimumExtent() const;
 
+    void setLabelCacheAttribute( LabelCacheAttribute, bool on = true );
+    bool testLabelCacheAttribute( LabelCacheAttribute ) const;
+
+    void setLabelCacheSize( int numLabels );
+    int labelCacheSize() const;
+
     void invalidateCache();
 
 protected:
@@ -127,7 +164,10 @@ protected:
     */
     virtual void drawLabel( QPainter *painter, double value ) const = 0;
 
+    virtual int labelFormat() const;
+
     const QwtText &tickLabel( const QFont &, double value ) const;
+    QImage tickLabelImage( const QPainter *, double value ) const;
 
 private:
     Q_DISABLE_COPY(QwtAbstractScaleDraw)
@@ -137,5 +177,6 @@ private:
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS( QwtAbstractScaleDraw::ScaleComponents )
+Q_DECLARE_OPERATORS_FOR_FLAGS( QwtAbstractScaleDraw::LabelCacheAttributes )
 
 #endif
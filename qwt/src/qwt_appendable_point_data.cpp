@@ -0,0 +1,317 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_appendable_point_data.h"
+
+#include <limits>
+
+namespace
+{
+    class QwtBoundsNode
+    {
+    public:
+        inline void reset()
+        {
+            minX = minY = std::numeric_limits<double>::max();
+            maxX = maxY = -std::numeric_limits<double>::max();
+        }
+
+        inline void setPoint( const QPointF &pos )
+        {
+            if ( pos.x() == pos.x() && pos.y() == pos.y() ) // no NaNs
+            {
+                minX = maxX = pos.x();
+                minY = maxY = pos.y();
+            }
+            else
+            {
+                reset();
+            }
+        }
+
+        inline void unite( const QwtBoundsNode &node1,
+            const QwtBoundsNode &node2 )
+        {
+            minX = qMin( node1.minX, node2.minX );
+            maxX = qMax( node1.maxX, node2.maxX );
+            minY = qMin( node1.minY, node2.minY );
+            maxY = qMax( node1.maxY, node2.maxY );
+        }
+
+        inline QRectF toRect() const
+        {
+            if ( minX > maxX )
+                return QRectF( 1.0, 1.0, -2.0, -2.0 ); // invalid
+
+            return QRectF( minX, minY, maxX - minX, maxY - minY );
+        }
+
+        double minX;
+        double maxX;
+        double minY;
+        double maxY;
+    };
+}
+
+class QwtAppendablePointData::PrivateData
+{
+public:
+    PrivateData():
+        capacity( 0 ),
+        head( 0 ),
+        count( 0 ),
+        numLeaves( 0 )
+    {
+    }
+
+    void initTree()
+    {
+        numLeaves = 1;
+        while ( numLeaves < int( capacity ) )
+            numLeaves *= 2;
+
+        tree.resize( 2 * numLeaves );
+        for ( int i = 0; i < tree.size(); i++ )
+            tree[i].reset();
+    }
+
+    // O(log(capacity)): updating the leaf and all its parents
+    inline void updateTree( int slot, const QPointF *pos )
+    {
+        QwtBoundsNode *nodes = tree.data();
+
+        int index = numLeaves + slot;
+
+        if ( pos )
+            nodes[index].setPoint( *pos );
+        else
+            nodes[index].reset();
+
+        for ( index /= 2; index >= 1; index /= 2 )
+            nodes[index].unite( nodes[ 2 * index ], nodes[ 2 * index + 1 ] );
+    }
+
+    size_t capacity;
+
+    QVector<QPointF> samples;
+    int head;
+    int count;
+
+    // segment tree, only in ring buffer mode
+    QVector<QwtBoundsNode> tree;
+    int numLeaves;
+};
+
+/*!
+  \brief Constructor
+
+  \param capacity Maximum number of samples. 0 means unlimited.
+  \sa setCapacity()
+*/
+QwtAppendablePointData::QwtAppendablePointData( size_t capacity )
+{
+    d_data = new PrivateData();
+    setCapacity( capacity );
+}
+
+//! Destructor
+QwtAppendablePointData::~QwtAppendablePointData()
+{
+    delete d_data;
+}
+
+/*!
+  \brief Set the maximum number of samples
+
+  When the capacity is > 0 the samples are stored in a ring buffer,
+  where the oldest samples are discarded, when appending new ones
+  to a full buffer. When reducing the capacity the
+  most recent samples are kept.
+
+  \param capacity Maximum number of samples. 0 means unlimited.
+  \sa capacity(), append()
+*/
+void QwtAppendablePointData::setCapacity( size_t capacity )
+{
+    const int numSamples = d_data->count;
+
+    QVector<QPointF> samples( numSamples );
+    for ( int i = 0; i < numSamples; i++ )
+        samples[i] = sample( i );
+
+    d_data->capacity = capacity;
+    d_data->tree.clear();
+    d_data->numLeaves = 0;
+
+    clear();
+
+    if ( capacity > 0 )
+    {
+        d_data->samples.resize( int( capacity ) );
+        d_data->initTree();
+    }
+
+    int from = 0;
+    if ( capacity > 0 && numSamples > int( capacity ) )
+        from = numSamples - int( capacity );
+
+    append( samples.constData() + from, numSamples - from );
+}
+
+/*!
+  \return Maximum number of samples. 0 means unlimited.
+  \sa setCapacity()
+*/
+size_t QwtAppendablePointData::capacity() const
+{
+    return d_data->capacity;
+}
+
+/*!
+  \brief Append a sample
+
+  \param pos Sample
+  \sa append(), clear(), setCapacity()
+*/
+void QwtAppendablePointData::append( const QPointF &pos )
+{
+    incrementRevision();
+
+    if ( d_data->capacity == 0 )
+    {
+        d_data->samples.append( pos );
+        d_data->count++;
+
+        if ( pos.x() == pos.x() && pos.y() == pos.y() ) // no NaNs
+        {
+            if ( d_boundingRect.width() < 0.0 )
+            {
+                d_boundingRect = QRectF( pos.x(), pos.y(), 0.0, 0.0 );
+            }
+            else
+            {
+                if ( pos.x() < d_boundingRect.left() )
+                    d_boundingRect.setLeft( pos.x() );
+                else if ( pos.x() > d_boundingRect.right() )
+                    d_boundingRect.setRight( pos.x() );
+
+                if ( pos.y() < d_boundingRect.top() )
+                    d_boundingRect.setTop( pos.y() );
+                else if ( pos.y() > d_boundingRect.bottom() )
+                    d_boundingRect.setBottom( pos.y() );
+            }
+        }
+
+        return;
+    }
+
+    const int capacity = int( d_data->capacity );
+
+    int slot = d_data->head + d_data->count;
+    if ( slot >= capacity )
+        slot -= capacity;
+
+    if ( d_data->count == capacity )
+    {
+        // discarding the oldest sample, by overwriting its slot
+
+        d_data->head++;
+        if ( d_data->head >= capacity )
+            d_data->head = 0;
+    }
+    else
+    {
+        d_data->count++;
+    }
+
+    d_data->samples[slot] = pos;
+    d_data->updateTree( slot, &pos );
+}
+
+/*!
+  \brief Append an array of samples
+
+  \param samples Array of samples
+  \param count Number of samples
+*/
+void QwtAppendablePointData::append( const QPointF *samples, size_t count )
+{
+    if ( d_data->capacity == 0 )
+        d_data->samples.reserve( d_data->count + int( count ) );
+
+    for ( size_t i = 0; i < count; i++ )
+        append( samples[i] );
+}
+
+/*!
+  \brief Append an array of samples
+  \param samples Samples
+*/
+void QwtAppendablePointData::append( const QVector<QPointF> &samples )
+{
+    append( samples.constData(), samples.size() );
+}
+
+/*!
+  \brief Remove all samples
+  \note The capacity is not affected
+*/
+void QwtAppendablePointData::clear()
+{
+    incrementRevision();
+
+    d_data->head = 0;
+    d_data->count = 0;
+
+    if ( d_data->capacity == 0 )
+    {
+        d_data->samples.clear();
+    }
+    else
+    {
+        for ( int i = 0; i < d_data->tree.size(); i++ )
+            d_data->tree[i].reset();
+    }
+
+    d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
+}
+
+//! \return Number of samples
+size_t QwtAppendablePointData::size() const
+{
+    return d_data->count;
+}
+
+/*!
+  Return a sample
+
+  \param index Index, where 0 is the oldest sample
+  \return Sample at position index
+*/
+QPointF QwtAppendablePointData::sample( size_t index ) const
+{
+    int slot = d_data->head + int( index );
+    if ( d_data->capacity > 0 && slot >= int( d_data->capacity ) )
+        slot -= int( d_data->capacity );
+
+    return d_data->samples[slot];
+}
+
+/*!
+  \return Bounding rectangle of all samples. As the bounds are
+          updated, when appending samples, this is always
+          an O(1) operation.
+*/
+QRectF QwtAppendablePointData::boundingRect() const
+{
+    if ( d_data->capacity > 0 )
+        return d_data->tree[1].toRect();
+
+    return d_boundingRect;
+}
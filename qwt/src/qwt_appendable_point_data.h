@@ -0,0 +1,64 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_APPENDABLE_POINT_DATA_H
+#define QWT_APPENDABLE_POINT_DATA_H
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+
+/*!
+  \brief Point data for streaming applications
+
+  QwtAppendablePointData is a series of points, where new samples
+  are appended at the end. In opposite to QwtPointSeriesData
+  the bounding rectangle is updated with each append and never
+  needs to be recalculated by iterating over all samples.
+
+  - capacity() == 0\n
+    The series grows without limits. Appending a sample is an
+    amortized O(1) operation and the bounding rectangle is extended by it.
+
+  - capacity() > 0\n
+    The samples are stored in a ring buffer. When the buffer is full
+    the oldest sample is discarded for each new one. The bounds
+    are maintained in a segment tree over the slots of the buffer, what
+    makes appending an O(log(capacity)) and boundingRect() an O(1) operation.
+
+  \note QwtAppendablePointData is not thread safe. Samples have to be
+        appended from the thread, that paints the plot
+  \sa QwtPlotCurve::setData(), QwtPlotDirectPainter
+*/
+class QWT_EXPORT QwtAppendablePointData: public QwtSeriesData<QPointF>
+{
+public:
+    explicit QwtAppendablePointData( size_t capacity = 0 );
+    virtual ~QwtAppendablePointData();
+
+    void setCapacity( size_t capacity );
+    size_t capacity() const;
+
+    void append( const QPointF & );
+    void append( const QPointF *samples, size_t count );
+    void append( const QVector<QPointF> & );
+
+    void clear();
+
+    virtual size_t size() const QWT_OVERRIDE;
+    virtual QPointF sample( size_t index ) const QWT_OVERRIDE;
+    virtual QRectF boundingRect() const QWT_OVERRIDE;
+
+private:
+    Q_DISABLE_COPY(QwtAppendablePointData)
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
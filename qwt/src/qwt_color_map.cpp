@@ -11,6 +11,7 @@
 #include "qwt_interval.h"
 
 #include <qvector.h>
+#include <qnumeric.h>
 
 static inline QRgb qwtHsvToRgb( int h, int s, int v, int a )
 {
@@ -69,6 +70,8 @@ public:
 
     void insert( double pos, const QColor &color );
     QRgb rgb( QwtLinearColorMap::Mode, double pos ) const;
+    void rgbBatch( QwtLinearColorMap::Mode, double minValue, double width,
+        const double *values, QRgb *rgbs, int count ) const;
 
     QVector<double> stops() const;
 
@@ -126,9 +129,23 @@ private:
         double posStep;
     };
 
+    // number of buckets of the lookup table for findUpper()
+    enum { LookupSize = 256 };
+
+    void updateLookupTable();
+
     inline int findUpper( double pos ) const;
+    inline int lookupUpper( double pos ) const;
+
     QVector<ColorStop> d_stops;
     bool d_doAlpha;
+
+    /*
+        d_lookup[i] is the result of findUpper for the lower bound
+        of the bucket i. So finding the upper stop for a position
+        is a table lookup followed by very few comparisons
+     */
+    QVector<int> d_lookup;
 };
 
 void QwtLinearColorMap::ColorStops::insert( double pos, const QColor &color )
@@ -166,6 +183,16 @@ void QwtLinearColorMap::ColorStops::insert( double pos, const QColor &color )
 
     if ( index < d_stops.size() - 1 )
         d_stops[index].updateSteps( d_stops[index+1] );
+
+    updateLookupTable();
+}
+
+void QwtLinearColorMap::ColorStops::updateLookupTable()
+{
+    d_lookup.resize( LookupSize );
+
+    for ( int i = 0; i < LookupSize; i++ )
+        d_lookup[i] = findUpper( double( i ) / LookupSize );
 }
 
 inline QVector<double> QwtLinearColorMap::ColorStops::stops() const
@@ -200,6 +227,21 @@ inline int QwtLinearColorMap::ColorStops::findUpper( double pos ) const
     return index;
 }
 
+inline int QwtLinearColorMap::ColorStops::lookupUpper( double pos ) const
+{
+    // pos is in ]0.0, 1.0[ and scaling by a power of 2 is exact
+    const int bucket = qMin( int( pos * LookupSize ), LookupSize - 1 );
+
+    const ColorStop *stops = d_stops.constData();
+    const int numStops = d_stops.size();
+
+    int index = d_lookup[bucket];
+    while ( index < numStops && stops[index].pos <= pos )
+        index++;
+
+    return index;
+}
+
 inline QRgb QwtLinearColorMap::ColorStops::rgb(
     QwtLinearColorMap::Mode mode, double pos ) const
 {
@@ -208,7 +250,7 @@ inline QRgb QwtLinearColorMap::ColorStops::rgb(
     if ( pos >= 1.0 )
         return d_stops[ d_stops.size() - 1 ].rgb;
 
-    const int index = findUpper( pos );
+    const int index = lookupUpper( pos );
     if ( mode == FixedColors )
     {
         return d_stops[index-1].rgb;
@@ -242,6 +284,19 @@ inline QRgb QwtLinearColorMap::ColorStops::rgb(
     }
 }
 
+void QwtLinearColorMap::ColorStops::rgbBatch(
+    QwtLinearColorMap::Mode mode, double minValue, double width,
+    const double *values, QRgb *rgbs, int count ) const
+{
+    for ( int i = 0; i < count; i++ )
+    {
+        if ( qIsNaN( values[i] ) )
+            rgbs[i] = 0u;
+        else
+            rgbs[i] = rgb( mode, ( values[i] - minValue ) / width );
+    }
+}
+
 /*!
    Constructor
    \param format Format of the color map
@@ -293,6 +348,67 @@ uint QwtColorMap::colorIndex( int numColors,
     return static_cast<unsigned int>( v + 0.5 );
 }
 
+/*!
+  \brief Map an array of values into RGB values
+
+  The default implementation calls rgb() for each value, but color
+  maps, that are used for large images, might want to reimplement
+  rgbBatch() to get rid of a virtual call for each pixel.
+
+  The results have to be the same as calling rgb() for each value.
+  So a class, that reimplements rgb() of a base class with an optimized
+  rgbBatch(), has to reimplement rgbBatch() as well.
+
+  \param interval Range for all values
+  \param values Values to map into RGB values
+  \param rgbs Array for the RGB values
+  \param count Number of values
+
+  \note NaN values have to be mapped to 0u
+  \sa rgb(), colorIndexBatch(), QwtPlotSpectrogram::renderTile()
+*/
+void QwtColorMap::rgbBatch( const QwtInterval &interval,
+    const double *values, QRgb *rgbs, int count ) const
+{
+    for ( int i = 0; i < count; i++ )
+    {
+        if ( qIsNaN( values[i] ) )
+            rgbs[i] = 0u;
+        else
+            rgbs[i] = rgb( interval, values[i] );
+    }
+}
+
+/*!
+  \brief Map an array of values into color indexes
+
+  The default implementation calls colorIndex() for each value.
+
+  The results have to be the same as calling colorIndex() for each value.
+  So a class, that reimplements colorIndex() of a base class with an
+  optimized colorIndexBatch(), has to reimplement colorIndexBatch() as well.
+
+  \param numColors Number of colors
+  \param interval Range for all values
+  \param values Values to map into color indexes
+  \param indexes Array for the color indexes
+  \param count Number of values
+
+  \note NaN values have to be mapped to 0
+  \sa colorIndex(), rgbBatch(), QwtPlotSpectrogram::renderTile()
+*/
+void QwtColorMap::colorIndexBatch( int numColors, const QwtInterval &interval,
+    const double *values, uint *indexes, int count ) const
+{
+    for ( int i = 0; i < count; i++ )
+    {
+        if ( qIsNaN( values[i] ) )
+            indexes[i] = 0;
+        else
+            indexes[i] = colorIndex( numColors, interval, values[i] );
+    }
+}
+
 /*!
    Build and return a color map of 256 colors
 
@@ -508,6 +624,88 @@ uint QwtLinearColorMap::colorIndex( int numColors,
     return static_cast<unsigned int>( ( d_data->mode == FixedColors ) ? v : v + 0.5 );
 }
 
+/*!
+  \brief Map an array of values into RGB values
+
+  The same as calling rgb() for each value, but without the
+  overhead of a virtual call and the lookup of the color stops
+  for each pixel.
+
+  \param interval Range for all values
+  \param values Values to map into RGB values
+  \param rgbs Array for the RGB values
+  \param count Number of values
+
+  \note NaN values are mapped to 0u
+*/
+void QwtLinearColorMap::rgbBatch( const QwtInterval &interval,
+    const double *values, QRgb *rgbs, int count ) const
+{
+    const double width = interval.width();
+    if ( width <= 0.0 )
+    {
+        for ( int i = 0; i < count; i++ )
+            rgbs[i] = 0u;
+
+        return;
+    }
+
+    d_data->colorStops.rgbBatch( d_data->mode,
+        interval.minValue(), width, values, rgbs, count );
+}
+
+/*!
+  \brief Map an array of values into color indexes
+
+  The same as calling colorIndex() for each value
+
+  \param numColors Size of the color table
+  \param interval Range for all values
+  \param values Values to map into color indexes
+  \param indexes Array for the color indexes
+  \param count Number of values
+
+  \note NaN values are mapped to 0
+*/
+void QwtLinearColorMap::colorIndexBatch( int numColors,
+    const QwtInterval &interval, const double *values,
+    uint *indexes, int count ) const
+{
+    const double width = interval.width();
+    if ( width <= 0.0 )
+    {
+        for ( int i = 0; i < count; i++ )
+            indexes[i] = 0;
+
+        return;
+    }
+
+    const double minValue = interval.minValue();
+    const double maxValue = interval.maxValue();
+
+    const uint maxIndex = numColors - 1;
+    const double round = ( d_data->mode == FixedColors ) ? 0.0 : 0.5;
+
+    for ( int i = 0; i < count; i++ )
+    {
+        const double value = values[i];
+
+        if ( value <= minValue || qIsNaN( value ) )
+        {
+            indexes[i] = 0;
+        }
+        else if ( value >= maxValue )
+        {
+            indexes[i] = maxIndex;
+        }
+        else
+        {
+            const double v = ( numColors - 1 ) * ( value - minValue ) / width;
+            indexes[i] = static_cast<unsigned int>( v + round );
+        }
+    }
+}
+
 class QwtAlphaColorMap::PrivateData
 {
 public:
@@ -79,6 +79,12 @@ public:
     virtual uint colorIndex( int numColors,
         const QwtInterval &interval, double value ) const;
 
+    virtual void rgbBatch( const QwtInterval &,
+        const double *values, QRgb *rgbs, int count ) const;
+
+    virtual void colorIndexBatch( int numColors, const QwtInterval &,
+        const double *values, uint *indexes, int count ) const;
+
     QColor color( const QwtInterval &, double value ) const;
     virtual QVector<QRgb> colorTable( int numColors ) const;
     virtual QVector<QRgb> colorTable256() const;
@@ -95,6 +101,12 @@ private:
   A color stop is a color at a specific position. The valid
   range for the positions is [0.0, 1.0]. When mapping a value
   into a color it is translated into this interval according to mode().
+
+  \note rgbBatch() and colorIndexBatch() map the values without calling
+        rgb() or colorIndex(). A derived class, that reimplements rgb()
+        or colorIndex(), also has to reimplement rgbBatch() or
+        colorIndexBatch() - f.e. by calling QwtColorMap::rgbBatch()
+        or QwtColorMap::colorIndexBatch(), that map the values one by one.
 */
 class QWT_EXPORT QwtLinearColorMap: public QwtColorMap
 {
@@ -134,6 +146,12 @@ public:
     virtual uint colorIndex( int numColors,
         const QwtInterval &, double value ) const QWT_OVERRIDE;
 
+    virtual void rgbBatch( const QwtInterval &,
+        const double *values, QRgb *rgbs, int count ) const QWT_OVERRIDE;
+
+    virtual void colorIndexBatch( int numColors, const QwtInterval &,
+        const double *values, uint *indexes, int count ) const QWT_OVERRIDE;
+
     class ColorStops;
 
 private:
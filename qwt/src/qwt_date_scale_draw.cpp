@@ -65,6 +65,7 @@ QwtDateScaleDraw::~QwtDateScaleDraw()
 void QwtDateScaleDraw::setTimeSpec( Qt::TimeSpec timeSpec )
 {
     d_data->timeSpec = timeSpec;
+    invalidateCache();
 }
 
 /*!
@@ -89,6 +90,7 @@ Qt::TimeSpec QwtDateScaleDraw::timeSpec() const
 void QwtDateScaleDraw::setUtcOffset( int seconds )
 {
     d_data->utcOffset = seconds;
+    invalidateCache();
 }
 
 /*!
@@ -115,6 +117,7 @@ int QwtDateScaleDraw::utcOffset() const
 void QwtDateScaleDraw::setWeek0Type( QwtDate::Week0Type week0Type )
 {
     d_data->week0Type = week0Type;
+    invalidateCache();
 }
 
 /*!
@@ -141,6 +144,7 @@ void QwtDateScaleDraw::setDateFormat(
         intervalType <= QwtDate::Year )
     {
         d_data->dateFormats[ intervalType ] = format;
+        invalidateCache();
     }
 }
 
@@ -211,6 +215,20 @@ QwtText QwtDateScaleDraw::label( double value ) const
     return QwtDate::toString( dt, fmt, d_data->week0Type );
 }
 
+/*!
+  \brief Identifier of the format of the labels
+
+  The format of the labels depends on the interval type
+  of the scale division.
+
+  \return intervalType( scaleDiv() )
+  \sa QwtAbstractScaleDraw::PersistentLabels
+*/
+int QwtDateScaleDraw::labelFormat() const
+{
+    return intervalType( scaleDiv() );
+}
+
 /*!
   Find the less detailed datetime unit, where no rounding
   errors happen.
@@ -43,6 +43,12 @@
   The format strings can be modified using setDateFormat()
   or individually for each tick label by overloading dateFormatOfDate(),
 
+  The tick labels are cached for each interval type. For scrolling
+  time axes it is recommended to enable QwtAbstractScaleDraw::PersistentLabels,
+  so that the labels are reused for the following scale divisions.
+  This is possible as long as the labels depend on the value
+  and the interval type only.
+
   Usually QwtDateScaleDraw is used in combination with
   QwtDateScaleEngine, that calculates scales for datetime
   intervals.
@@ -72,6 +78,8 @@ public:
     QDateTime toDateTime( double ) const;
 
 protected:
+    virtual int labelFormat() const QWT_OVERRIDE;
+
     virtual QwtDate::IntervalType
         intervalType( const QwtScaleDiv & ) const;
 
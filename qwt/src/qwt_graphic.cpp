@@ -10,6 +10,7 @@
 #include "qwt_graphic.h"
 #include "qwt_painter_command.h"
 #include "qwt_math.h"
+#include "qwt_render_scheduler.h"
 
 #include <qvector.h>
 #include <qpainter.h>
@@ -621,6 +622,11 @@ qreal QwtGraphic::widthForHeight( qreal height ) const
 
 /*!
   \brief Replay all recorded painter commands
+
+  When the graphic is rendered in the scope of a QwtRenderToken
+  ( see QwtRenderScheduler::Scope ) the remaining commands are skipped,
+  as soon as the token has been cancelled.
+
   \param painter Qt painter
  */
 void QwtGraphic::render( QPainter *painter ) const
@@ -638,10 +644,15 @@ void QwtGraphic::renderGraphic( QPainter* painter, QTransform *initialTransform
 
     const QTransform transform = painter->transform();
 
+    const QwtRenderToken token = QwtRenderScheduler::currentToken();
+
     painter->save();
 
     for ( int i = 0; i < numCommands; i++ )
     {
+        if ( token.isCancelled() )
+            break;
+
         qwtExecCommand( painter, commands[i],
             d_data->renderHints, transform, initialTransform );
     }
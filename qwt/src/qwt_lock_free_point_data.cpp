@@ -0,0 +1,263 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_lock_free_point_data.h"
+#include "qwt_appendable_point_data.h"
+
+#include <qatomic.h>
+
+static inline uint qwtLoadAcquire( const QAtomicInt &value )
+{
+#if QT_VERSION >= 0x050000
+    return uint( value.loadAcquire() );
+#else
+    return uint( const_cast< QAtomicInt & >( value ).fetchAndAddAcquire( 0 ) );
+#endif
+}
+
+static inline void qwtStoreRelease( QAtomicInt &atomic, uint value )
+{
+#if QT_VERSION >= 0x050000
+    atomic.storeRelease( int( value ) );
+#else
+    atomic.fetchAndStoreRelease( int( value ) );
+#endif
+}
+
+class QwtLockFreePointData::PrivateData
+{
+public:
+    PrivateData( size_t capacity, size_t size ):
+        snapshot( capacity ),
+        buffer( NULL ),
+        mask( 0 ),
+        writePos( 0 ),
+        readPos( 0 ),
+        numDropped( 0 )
+    {
+        // a power of 2, so that the positions can wrap around
+
+        uint bufferSize = 2;
+        while ( bufferSize < size && bufferSize < ( 1u << 30 ) )
+            bufferSize *= 2;
+
+        buffer = new QPointF[ bufferSize ];
+        mask = bufferSize - 1;
+    }
+
+    ~PrivateData()
+    {
+        delete[] buffer;
+    }
+
+    // only accessed by the GUI thread
+    QwtAppendablePointData snapshot;
+
+    QPointF *buffer;
+    uint mask;
+
+    /*
+        writePos/readPos are counting all samples, that have been
+        appended/collected and wrap around at 2^32. Each of them is
+        modified by one thread only.
+     */
+    QAtomicInt writePos;
+    QAtomicInt readPos;
+
+    QAtomicInt numDropped;
+};
+
+/*!
+  \brief Constructor
+
+  \param capacity Maximum number of samples in the snapshot.
+                  When exceeding the capacity the oldest samples
+                  are discarded. 0 means unlimited.
+  \param bufferSize Number of samples, that can be appended
+                    between two calls of updateSnapshot() without
+                    dropping samples. The size is rounded up to
+                    a power of 2.
+*/
+QwtLockFreePointData::QwtLockFreePointData(
+    size_t capacity, size_t bufferSize )
+{
+    d_data = new PrivateData( capacity, bufferSize );
+}
+
+//! Destructor
+QwtLockFreePointData::~QwtLockFreePointData()
+{
+    delete d_data;
+}
+
+/*!
+  \return Maximum number of samples in the snapshot. 0 means unlimited.
+*/
+size_t QwtLockFreePointData::capacity() const
+{
+    return d_data->snapshot.capacity();
+}
+
+/*!
+  \return Number of samples, that can be pending in the ring buffer
+*/
+size_t QwtLockFreePointData::bufferSize() const
+{
+    return d_data->mask + 1;
+}
+
+/*!
+  \brief Append a sample
+
+  This method is intended to be called from the producer thread.
+  It never blocks.
+
+  \param pos Sample
+  \return false, when the ring buffer is full and the sample was dropped
+  \sa updateSnapshot(), numDroppedSamples()
+*/
+bool QwtLockFreePointData::append( const QPointF &pos )
+{
+    const uint writePos = qwtLoadAcquire( d_data->writePos );
+    const uint readPos = qwtLoadAcquire( d_data->readPos );
+
+    if ( writePos - readPos > d_data->mask )
+    {
+        d_data->numDropped.fetchAndAddRelaxed( 1 );
+        return false;
+    }
+
+    d_data->buffer[ writePos & d_data->mask ] = pos;
+
+    // publishing the sample to the GUI thread
+    qwtStoreRelease( d_data->writePos, writePos + 1 );
+
+    return true;
+}
+
+/*!
+  \brief Append an array of samples
+
+  This method is intended to be called from the producer thread.
+  It never blocks.
+
+  \param samples Array of samples
+  \param count Number of samples
+  \return Number of samples, that have been appended.
+          The remaining samples have been dropped.
+*/
+size_t QwtLockFreePointData::append( const QPointF *samples, size_t count )
+{
+    const uint writePos = qwtLoadAcquire( d_data->writePos );
+    const uint readPos = qwtLoadAcquire( d_data->readPos );
+
+    const uint numFree = d_data->mask + 1 - ( writePos - readPos );
+
+    size_t numAppended = count;
+    if ( numAppended > numFree )
+    {
+        d_data->numDropped.fetchAndAddRelaxed( int( count - numFree ) );
+        numAppended = numFree;
+    }
+
+    for ( size_t i = 0; i < numAppended; i++ )
+        d_data->buffer[ ( writePos + uint( i ) ) & d_data->mask ] = samples[i];
+
+    qwtStoreRelease( d_data->writePos, writePos + uint( numAppended ) );
+
+    return numAppended;
+}
+
+/*!
+  \brief Collect the pending samples
+
+  All samples, that have been appended since the previous call,
+  are moved from the ring buffer to the snapshot, that is
+  returned by size(), sample() and boundingRect().
+
+  This method is intended to be called from the GUI thread,
+  usually right before replotting.
+
+  \return Number of samples, that have been added to the snapshot
+*/
+size_t QwtLockFreePointData::updateSnapshot()
+{
+    const uint writePos = qwtLoadAcquire( d_data->writePos );
+    const uint readPos = qwtLoadAcquire( d_data->readPos );
+
+    const uint numPending = writePos - readPos;
+    if ( numPending == 0 )
+        return 0;
+
+    const uint mask = d_data->mask;
+    const QPointF *buffer = d_data->buffer;
+
+    const uint from = readPos & mask;
+    const uint to = from + numPending;
+
+    if ( to <= mask + 1 )
+    {
+        d_data->snapshot.append( buffer + from, numPending );
+    }
+    else
+    {
+        d_data->snapshot.append( buffer + from, mask + 1 - from );
+        d_data->snapshot.append( buffer, to - ( mask + 1 ) );
+    }
+
+    // releasing the slots for the producer
+    qwtStoreRelease( d_data->readPos, writePos );
+
+    incrementRevision();
+
+    return numPending;
+}
+
+/*!
+  \return Number of samples, that have been dropped, because the
+          ring buffer was full.
+  \sa append(), bufferSize()
+*/
+int QwtLockFreePointData::numDroppedSamples() const
+{
+    return int( qwtLoadAcquire( d_data->numDropped ) );
+}
+
+/*!
+  \brief Remove all samples from the snapshot
+
+  Samples, that are pending in the ring buffer, will be collected
+  with the next updateSnapshot().
+*/
+void QwtLockFreePointData::clear()
+{
+    d_data->snapshot.clear();
+    incrementRevision();
+}
+
+//! \return Number of samples of the snapshot
+size_t QwtLockFreePointData::size() const
+{
+    return d_data->snapshot.size();
+}
+
+/*!
+  \param index Index, where 0 is the oldest sample of the snapshot
+  \return Sample at position index
+*/
+QPointF QwtLockFreePointData::sample( size_t index ) const
+{
+    return d_data->snapshot.sample( index );
+}
+
+//! \return Bounding rectangle of the snapshot
+QRectF QwtLockFreePointData::boundingRect() const
+{
+    return d_data->snapshot.boundingRect();
+}
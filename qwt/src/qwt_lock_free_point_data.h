@@ -0,0 +1,83 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_LOCK_FREE_POINT_DATA_H
+#define QWT_LOCK_FREE_POINT_DATA_H
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+
+/*!
+  \brief Point data, that is fed by a sampling thread without locking
+
+  QwtLockFreePointData connects one producer thread ( f.e. a
+  QwtSamplingThread ) with the GUI thread, that displays the samples:
+
+  - The producer appends samples to a single-producer/single-consumer
+    ring buffer. append() never blocks: when the ring buffer is full,
+    because the GUI thread did not collect the samples in time,
+    the new sample is dropped and counted ( numDroppedSamples() ).
+
+  - The GUI thread calls updateSnapshot() to move the pending samples
+    from the ring buffer into the snapshot. size(), sample() and
+    boundingRect() always refer to the snapshot, so that the
+    series does not change while it is painted.
+
+  Each snapshot is an epoch of the series: updateSnapshot() returns
+  the number of samples, that have been added since the previous one.
+  This can be used to paint only the new samples incrementally with
+  QwtPlotDirectPainter:
+
+  \code
+    const size_t numNew = data->updateSnapshot();
+    if ( numNew > 0 )
+    {
+        const int to = int( data->size() ) - 1;
+        directPainter->drawSeries( curve, qMax( to - int( numNew ), 0 ), to );
+    }
+  \endcode
+
+  \note Samples must be appended from one thread only and all other
+        methods must be called from the GUI thread.
+
+  \sa QwtSamplingThread, QwtAppendablePointData, QwtPlotDirectPainter
+*/
+class QWT_EXPORT QwtLockFreePointData: public QwtSeriesData<QPointF>
+{
+public:
+    explicit QwtLockFreePointData(
+        size_t capacity = 0, size_t bufferSize = 65536 );
+
+    virtual ~QwtLockFreePointData();
+
+    size_t capacity() const;
+    size_t bufferSize() const;
+
+    // producer thread
+    bool append( const QPointF & );
+    size_t append( const QPointF *samples, size_t count );
+
+    // GUI thread
+    size_t updateSnapshot();
+    int numDroppedSamples() const;
+
+    void clear();
+
+    virtual size_t size() const QWT_OVERRIDE;
+    virtual QPointF sample( size_t index ) const QWT_OVERRIDE;
+    virtual QRectF boundingRect() const QWT_OVERRIDE;
+
+private:
+    Q_DISABLE_COPY(QwtLockFreePointData)
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
@@ -0,0 +1,746 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_mapped_data.h"
+#include "qwt_interval.h"
+
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qdatetime.h>
+#include <qdatastream.h>
+#include <qstringlist.h>
+#include <qmutex.h>
+
+#include <cstring>
+#include <limits>
+
+static const quint32 qwtSidecarMagic = 0x51777443; // "Qwtc"
+static const int qwtRasterHeaderSize = 64;
+
+static inline QString qwtDefaultSidecar( const QString &fileName )
+{
+    return fileName + QLatin1String( ".qwtcache" );
+}
+
+/*
+    The sidecar is only valid for the files it has been
+    calculated from. They are identified by their absolute paths,
+    sizes and modification times.
+ */
+static QByteArray qwtFileStamp( const QStringList &fileNames )
+{
+    QByteArray stamp;
+
+    QDataStream stream( &stamp, QIODevice::WriteOnly );
+    stream.setVersion( QDataStream::Qt_4_6 );
+
+    for ( int i = 0; i < fileNames.size(); i++ )
+    {
+        const QFileInfo info( fileNames[i] );
+
+        stream << info.absoluteFilePath() << qint64( info.size() )
+            << qint64( info.lastModified().toMSecsSinceEpoch() );
+    }
+
+    return stamp;
+}
+
+static bool qwtReadSidecar( const QString &sidecarFileName,
+    const QByteArray &stamp, double *values, int count )
+{
+    if ( sidecarFileName.isEmpty() )
+        return false;
+
+    QFile file( sidecarFileName );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+
+    quint32 magic = 0;
+    QByteArray fileStamp;
+    QVector<double> fileValues;
+
+    stream >> magic >> fileStamp >> fileValues;
+
+    if ( stream.status() != QDataStream::Ok || magic != qwtSidecarMagic
+        || fileStamp != stamp || fileValues.size() != count )
+    {
+        return false;
+    }
+
+    for ( int i = 0; i < count; i++ )
+        values[i] = fileValues[i];
+
+    return true;
+}
+
+static void qwtWriteSidecar( const QString &sidecarFileName,
+    const QByteArray &stamp, const double *values, int count )
+{
+    if ( sidecarFileName.isEmpty() )
+        return;
+
+    // f.e. read only directories: we silently calculate again next time
+
+    QFile file( sidecarFileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        return;
+
+    QVector<double> fileValues( count );
+    for ( int i = 0; i < count; i++ )
+        fileValues[i] = values[i];
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+
+    stream << qwtSidecarMagic << stamp << fileValues;
+}
+
+static const uchar *qwtMapFile( QFile &file, QString &errorString )
+{
+    if ( !file.open( QIODevice::ReadOnly ) )
+    {
+        errorString = file.errorString();
+        return NULL;
+    }
+
+    if ( file.size() == 0 )
+    {
+        // QFile::map() fails for empty files without an error string
+        errorString = QLatin1String( "Empty file" );
+        return NULL;
+    }
+
+    const uchar *data = file.map( 0, file.size() );
+    if ( data == NULL )
+        errorString = file.errorString();
+
+    return data;
+}
+
+static inline void qwtExtendRange( double value, double &min, double &max )
+{
+    // NaN values are gaps, that are ignored
+
+    if ( value < min )
+        min = value;
+
+    if ( value > max )
+        max = value;
+}
+
+template< typename T >
+static QwtInterval qwtValueRange( const T *values, int size )
+{
+    double min = std::numeric_limits<double>::max();
+    double max = -std::numeric_limits<double>::max();
+
+    for ( int i = 0; i < size; i++ )
+        qwtExtendRange( values[i], min, max );
+
+    if ( min > max )
+        return QwtInterval();
+
+    return QwtInterval( min, max );
+}
+
+class QwtMappedPointData::PrivateData
+{
+public:
+    PrivateData():
+        xValues( NULL ),
+        yValues( NULL ),
+        stride( 1 ),
+        size( 0 )
+    {
+    }
+
+    QStringList fileNames;
+    QString sidecarFileName;
+    QString errorString;
+
+    QFile xFile;
+    QFile yFile;
+
+    const double *xValues;
+    const double *yValues;
+    size_t stride;
+    size_t size;
+
+    QMutex mutex;
+};
+
+/*!
+  \brief Constructor for a file with interleaved coordinates
+
+  \param fileName File with x0, y0, x1, y1, ... as raw doubles
+  \sa isValid(), errorString()
+ */
+QwtMappedPointData::QwtMappedPointData( const QString &fileName )
+{
+    d_data = new PrivateData();
+    d_data->fileNames += fileName;
+    d_data->sidecarFileName = qwtDefaultSidecar( fileName );
+
+    d_data->xFile.setFileName( fileName );
+
+    const uchar *data = qwtMapFile( d_data->xFile, d_data->errorString );
+    if ( data )
+    {
+        const qint64 numPoints = d_data->xFile.size() / ( 2 * sizeof( double ) );
+
+        if ( numPoints > std::numeric_limits<int>::max() )
+        {
+            d_data->errorString = QLatin1String( "Too many values" );
+            return;
+        }
+
+        d_data->xValues = reinterpret_cast< const double * >( data );
+        d_data->yValues = d_data->xValues + 1;
+        d_data->stride = 2;
+        d_data->size = size_t( numPoints );
+    }
+}
+
+/*!
+  \brief Constructor for separate files for the x and y coordinates
+
+  When the files have different sizes, the number of points
+  is limited by the smaller one.
+
+  \param xFileName File with x0, x1, ... as raw doubles
+  \param yFileName File with y0, y1, ... as raw doubles
+
+  \sa isValid(), errorString()
+ */
+QwtMappedPointData::QwtMappedPointData(
+    const QString &xFileName, const QString &yFileName )
+{
+    d_data = new PrivateData();
+    d_data->fileNames << xFileName << yFileName;
+    d_data->sidecarFileName = qwtDefaultSidecar( xFileName );
+
+    d_data->xFile.setFileName( xFileName );
+    d_data->yFile.setFileName( yFileName );
+
+    const uchar *xData = qwtMapFile( d_data->xFile, d_data->errorString );
+    const uchar *yData = qwtMapFile( d_data->yFile, d_data->errorString );
+
+    if ( xData && yData )
+    {
+        const qint64 numPoints = qMin( d_data->xFile.size(),
+            d_data->yFile.size() ) / sizeof( double );
+
+        if ( numPoints > std::numeric_limits<int>::max() )
+        {
+            d_data->errorString = QLatin1String( "Too many values" );
+            return;
+        }
+
+        d_data->xValues = reinterpret_cast< const double * >( xData );
+        d_data->yValues = reinterpret_cast< const double * >( yData );
+        d_data->size = size_t( numPoints );
+    }
+}
+
+//! Destructor
+QwtMappedPointData::~QwtMappedPointData()
+{
+    delete d_data;
+}
+
+/*!
+  \return True, when the files could be mapped into memory
+  \sa errorString()
+ */
+bool QwtMappedPointData::isValid() const
+{
+    return d_data->errorString.isEmpty();
+}
+
+/*!
+  \return Description of the last error, when mapping the files
+  \sa isValid()
+ */
+QString QwtMappedPointData::errorString() const
+{
+    return d_data->errorString;
+}
+
+/*!
+  \brief Set the file, where to store the bounding rectangle
+
+  The default setting is the name of the ( first ) file with
+  ".qwtcache" appended. An empty name disables the sidecar.
+
+  \param fileName Name of the sidecar file
+  \sa sidecarFileName(), boundingRect()
+ */
+void QwtMappedPointData::setSidecarFileName( const QString &fileName )
+{
+    d_data->sidecarFileName = fileName;
+}
+
+/*!
+  \return Name of the file, where to store the bounding rectangle
+  \sa setSidecarFileName()
+ */
+QString QwtMappedPointData::sidecarFileName() const
+{
+    return d_data->sidecarFileName;
+}
+
+//! \return Number of points
+size_t QwtMappedPointData::size() const
+{
+    return d_data->size;
+}
+
+/*!
+  Return the sample at position i
+
+  \param index Index
+  \return Sample at position i
+ */
+QPointF QwtMappedPointData::sample( size_t index ) const
+{
+    const size_t pos = index * d_data->stride;
+    return QPointF( d_data->xValues[pos], d_data->yValues[pos] );
+}
+
+/*!
+  \brief Calculate the bounding rectangle
+
+  The bounding rectangle is taken from the sidecar file, when
+  it is valid for the mapped files. Otherwise all points are
+  iterated and the result is written to the sidecar.
+  NaN coordinates are ignored.
+
+  \return Bounding rectangle
+  \sa setSidecarFileName()
+ */
+QRectF QwtMappedPointData::boundingRect() const
+{
+    QMutexLocker locker( &d_data->mutex );
+
+    if ( d_boundingRect.width() >= 0.0 )
+        return d_boundingRect;
+
+    const QByteArray stamp = qwtFileStamp( d_data->fileNames );
+
+    double r[4];
+    if ( !qwtReadSidecar( d_data->sidecarFileName, stamp, r, 4 ) )
+    {
+        double minX = std::numeric_limits<double>::max();
+        double maxX = -std::numeric_limits<double>::max();
+        double minY = minX;
+        double maxY = maxX;
+
+        const double *x = d_data->xValues;
+        const double *y = d_data->yValues;
+        const size_t stride = d_data->stride;
+
+        for ( size_t i = 0; i < d_data->size; i++ )
+        {
+            const size_t pos = i * stride;
+
+            qwtExtendRange( x[pos], minX, maxX );
+            qwtExtendRange( y[pos], minY, maxY );
+        }
+
+        if ( minX > maxX || minY > maxY )
+        {
+            // something invalid, like QwtPointSeriesData for empty series
+            r[0] = r[1] = 1.0;
+            r[2] = r[3] = -2.0;
+        }
+        else
+        {
+            r[0] = minX;
+            r[1] = minY;
+            r[2] = maxX - minX;
+            r[3] = maxY - minY;
+        }
+
+        qwtWriteSidecar( d_data->sidecarFileName, stamp, r, 4 );
+    }
+
+    d_boundingRect = QRectF( r[0], r[1], r[2], r[3] );
+    return d_boundingRect;
+}
+
+/*!
+  \param xData Pointer, where to return the address of the x values
+  \param yData Pointer, where to return the address of the y values
+  \return True, when the coordinates are stored in separate files
+  \sa QwtPointSeriesData::contiguousDoubleData()
+*/
+bool QwtMappedPointData::contiguousDoubleData(
+    const double **xData, const double **yData ) const
+{
+    if ( d_data->stride != 1 || d_data->xValues == NULL )
+        return false;
+
+    *xData = d_data->xValues;
+    *yData = d_data->yValues;
+
+    return true;
+}
+
+class QwtMappedRasterData::PrivateData
+{
+public:
+    PrivateData():
+        values( NULL ),
+        hasZInterval( false )
+    {
+    }
+
+    QString fileName;
+    QString sidecarFileName;
+    QString errorString;
+
+    QFile file;
+    const void *values;
+
+    QwtMatrixRasterData matrix;
+
+    bool hasZInterval;
+    QwtInterval zInterval;
+
+    QMutex mutex;
+};
+
+/*!
+  \brief Constructor
+
+  \param fileName File with a header followed by the matrix of values
+  \sa isValid(), errorString()
+ */
+QwtMappedRasterData::QwtMappedRasterData( const QString &fileName )
+{
+    d_data = new PrivateData();
+    d_data->fileName = fileName;
+    d_data->sidecarFileName = qwtDefaultSidecar( fileName );
+
+    d_data->file.setFileName( fileName );
+
+    const uchar *data = qwtMapFile( d_data->file, d_data->errorString );
+    if ( data == NULL )
+        return;
+
+    const qint64 fileSize = d_data->file.size();
+
+    quint32 header[4];
+    double rect[4];
+
+    if ( fileSize < qwtRasterHeaderSize
+        || std::memcmp( data, "QWTRASTR", 8 ) != 0 )
+    {
+        d_data->errorString = QLatin1String( "Missing header" );
+        return;
+    }
+
+    std::memcpy( header, data + 8, sizeof( header ) );
+    std::memcpy( rect, data + 24, sizeof( rect ) );
+
+    // a file with a different byte order fails here too
+
+    int valueSize = 0;
+    switch( header[0] )
+    {
+        case QwtMatrixRasterData::Double:
+            valueSize = sizeof( double );
+            break;
+
+        case QwtMatrixRasterData::Float:
+            valueSize = sizeof( float );
+            break;
+
+        case QwtMatrixRasterData::Int16:
+        case QwtMatrixRasterData::UInt16:
+            valueSize = sizeof( qint16 );
+            break;
+
+        default:
+        {
+            d_data->errorString = QLatin1String( "Unsupported value type" );
+            return;
+        }
+    }
+
+    const qint64 numValues = qint64( header[1] ) * header[2];
+
+    if ( numValues > std::numeric_limits<int>::max() )
+    {
+        d_data->errorString = QLatin1String( "Too many values" );
+        return;
+    }
+
+    if ( fileSize < qwtRasterHeaderSize + numValues * valueSize )
+    {
+        d_data->errorString = QLatin1String( "Truncated file" );
+        return;
+    }
+
+    QwtMatrixRasterData &matrix = d_data->matrix;
+
+    matrix.setInterval( Qt::XAxis, QwtInterval( rect[0], rect[1] ) );
+    matrix.setInterval( Qt::YAxis, QwtInterval( rect[2], rect[3] ) );
+
+    d_data->values = data + qwtRasterHeaderSize;
+
+    // the file is unmapped by the destructor of PrivateData
+    matrix.setRawValueMatrix(
+        static_cast< QwtMatrixRasterData::ValueType >( header[0] ),
+        d_data->values, int( header[1] ), int( header[2] ) );
+}
+
+//! Destructor
+QwtMappedRasterData::~QwtMappedRasterData()
+{
+    delete d_data;
+}
+
+/*!
+  \return True, when the file could be mapped into memory
+  \sa errorString()
+ */
+bool QwtMappedRasterData::isValid() const
+{
+    return d_data->errorString.isEmpty();
+}
+
+/*!
+  \return Description of the last error, when mapping the file
+  \sa isValid()
+ */
+QString QwtMappedRasterData::errorString() const
+{
+    return d_data->errorString;
+}
+
+/*!
+  \brief Set the file, where to store the range of the values
+
+  The default setting is the name of the file with
+  ".qwtcache" appended. An empty name disables the sidecar.
+
+  \param fileName Name of the sidecar file
+  \sa sidecarFileName(), interval()
+ */
+void QwtMappedRasterData::setSidecarFileName( const QString &fileName )
+{
+    d_data->sidecarFileName = fileName;
+}
+
+/*!
+  \return Name of the file, where to store the range of the values
+  \sa setSidecarFileName()
+ */
+QString QwtMappedRasterData::sidecarFileName() const
+{
+    return d_data->sidecarFileName;
+}
+
+/*!
+  \brief Set the resampling algorithm
+
+  \param mode Resampling mode
+  \sa resampleMode(), QwtMatrixRasterData::setResampleMode()
+*/
+void QwtMappedRasterData::setResampleMode(
+    QwtMatrixRasterData::ResampleMode mode )
+{
+    d_data->matrix.setResampleMode( mode );
+}
+
+/*!
+  \return resampling algorithm
+  \sa setResampleMode()
+*/
+QwtMatrixRasterData::ResampleMode QwtMappedRasterData::resampleMode() const
+{
+    return d_data->matrix.resampleMode();
+}
+
+//! \return Type of the values, as found in the header of the file
+QwtMatrixRasterData::ValueType QwtMappedRasterData::valueType() const
+{
+    return d_data->matrix.valueType();
+}
+
+//! \return Number of columns of the value matrix
+int QwtMappedRasterData::numColumns() const
+{
+    return d_data->matrix.numColumns();
+}
+
+//! \return Number of rows of the value matrix
+int QwtMappedRasterData::numRows() const
+{
+    return d_data->matrix.numRows();
+}
+
+/*!
+  \brief Overrule a bounding interval
+
+  The intervals of the X and Y axes are initialized from the header
+  of the file. Assigning an interval for the Z axis avoids calculating
+  the range of the values.
+
+  \param axis X, Y or Z axis
+  \param interval Interval
+
+  \sa interval()
+*/
+void QwtMappedRasterData::setInterval(
+    Qt::Axis axis, const QwtInterval &interval )
+{
+    if ( axis == Qt::ZAxis )
+    {
+        QMutexLocker locker( &d_data->mutex );
+
+        d_data->zInterval = interval;
+        d_data->hasZInterval = true;
+    }
+    else
+    {
+        d_data->matrix.setInterval( axis, interval );
+    }
+}
+
+/*!
+  \return Bounding interval for an axis
+
+  Unless it has been assigned explicitly, the interval of the
+  Z axis is the range of the values - NaN values are ignored.
+  It is taken from the sidecar file, when it is valid for the
+  mapped file. Otherwise all values are iterated and the result
+  is written to the sidecar.
+
+  \sa setInterval(), setSidecarFileName()
+ */
+QwtInterval QwtMappedRasterData::interval( Qt::Axis axis ) const
+{
+    if ( axis != Qt::ZAxis )
+        return d_data->matrix.interval( axis );
+
+    QMutexLocker locker( &d_data->mutex );
+
+    if ( d_data->hasZInterval )
+        return d_data->zInterval;
+
+    if ( !isValid() )
+        return QwtInterval();
+
+    const QByteArray stamp = qwtFileStamp( QStringList( d_data->fileName ) );
+
+    double r[2];
+    if ( qwtReadSidecar( d_data->sidecarFileName, stamp, r, 2 ) )
+    {
+        d_data->zInterval = QwtInterval( r[0], r[1] );
+    }
+    else
+    {
+        const QwtMatrixRasterData &matrix = d_data->matrix;
+
+        const void *values = d_data->values;
+        const int size = matrix.numColumns() * matrix.numRows();
+
+        QwtInterval range;
+        switch( matrix.valueType() )
+        {
+            case QwtMatrixRasterData::Float:
+                range = qwtValueRange( static_cast< const float * >( values ), size );
+                break;
+
+            case QwtMatrixRasterData::Int16:
+                range = qwtValueRange( static_cast< const qint16 * >( values ), size );
+                break;
+
+            case QwtMatrixRasterData::UInt16:
+                range = qwtValueRange( static_cast< const quint16 * >( values ), size );
+                break;
+
+            case QwtMatrixRasterData::Double:
+            default:
+                range = qwtValueRange( static_cast< const double * >( values ), size );
+        }
+
+        d_data->zInterval = range;
+
+        r[0] = range.minValue();
+        r[1] = range.maxValue();
+
+        qwtWriteSidecar( d_data->sidecarFileName, stamp, r, 2 );
+    }
+
+    d_data->hasZInterval = true;
+    return d_data->zInterval;
+}
+
+/*!
+   \brief Pixel hint
+
+   \param area Requested area, ignored
+   \return Bounding rectangle of a pixel
+   \sa QwtMatrixRasterData::pixelHint()
+*/
+QRectF QwtMappedRasterData::pixelHint( const QRectF &area ) const
+{
+    return d_data->matrix.pixelHint( area );
+}
+
+/*!
+   \return the value at a raster position
+   \param x X value in plot coordinates
+   \param y Y value in plot coordinates
+
+   \sa QwtMatrixRasterData::value()
+*/
+double QwtMappedRasterData::value( double x, double y ) const
+{
+    return d_data->matrix.value( x, y );
+}
+
+/*!
+   \brief Calculate the values for a row of positions
+
+   \param x Array of x values in plot coordinates
+   \param y y value in plot coordinates
+   \param result Array, where to store the values
+   \param count Number of values
+
+   \sa QwtMatrixRasterData::values()
+*/
+void QwtMappedRasterData::values( const double *x, double y,
+    double *result, int count ) const
+{
+    d_data->matrix.values( x, y, result, count );
+}
+
+/*!
+   \brief Calculate the values for a grid of positions
+
+   \param x Array of x values in plot coordinates
+   \param numX Number of x values
+   \param y Array of y values in plot coordinates
+   \param numY Number of y values
+   \param result Array for numX * numY values, row by row
+
+   \sa QwtMatrixRasterData::blockValues()
+*/
+void QwtMappedRasterData::blockValues( const double *x, int numX,
+    const double *y, int numY, double *result ) const
+{
+    d_data->matrix.blockValues( x, numX, y, numY, result );
+}
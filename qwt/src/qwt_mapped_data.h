@@ -0,0 +1,149 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_MAPPED_DATA_H
+#define QWT_MAPPED_DATA_H
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+#include "qwt_raster_data.h"
+#include "qwt_matrix_raster_data.h"
+
+class QString;
+
+/*!
+  \brief Point data, that is read from memory mapped files
+
+  QwtMappedPointData displays binary files without loading them
+  into memory. The operating system pages in the parts of the files,
+  that are accessed, what makes it possible to plot files, that
+  are much larger than the physical memory.
+
+  The following layouts of raw doubles ( native byte order,
+  no header ) are supported:
+
+  - One file with interleaved x/y coordinates: x0, y0, x1, y1, ...
+  - Two files with the x and y coordinates: x0, x1, ... and y0, y1, ...
+
+  For separate files the coordinates are offered as contiguous
+  arrays to QwtPointMapper ( see contiguousDoubleData() ).
+
+  As the samples are indexed by int, the number of points is limited
+  to std::numeric_limits<int>::max(). Larger files are rejected
+  with the error "Too many values" ( see isValid(), errorString() ).
+
+  Calculating the bounding rectangle needs to read the complete
+  files. It is done, when boundingRect() is called the first time
+  and the result is stored in a small sidecar file, so that it
+  does not need to be calculated again, when the same files are
+  opened later. The sidecar is invalidated, when the size or the
+  modification time of one of the files has changed.
+
+  For time series it is recommended to enable
+  QwtSeriesData::setXSorted(), so that QwtPlotCurve accesses
+  only the visible part of the files.
+
+  \sa QwtMappedRasterData, QwtCPointerData
+*/
+class QWT_EXPORT QwtMappedPointData: public QwtPointSeriesData
+{
+public:
+    explicit QwtMappedPointData( const QString &fileName );
+    QwtMappedPointData( const QString &xFileName, const QString &yFileName );
+
+    virtual ~QwtMappedPointData();
+
+    bool isValid() const;
+    QString errorString() const;
+
+    void setSidecarFileName( const QString & );
+    QString sidecarFileName() const;
+
+    virtual size_t size() const QWT_OVERRIDE;
+    virtual QPointF sample( size_t index ) const QWT_OVERRIDE;
+    virtual QRectF boundingRect() const QWT_OVERRIDE;
+
+    virtual bool contiguousDoubleData(
+        const double **xData, const double **yData ) const QWT_OVERRIDE;
+
+private:
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+/*!
+  \brief Raster data, that is read from a memory mapped file
+
+  QwtMappedRasterData maps a file with a row-major matrix of values
+  into memory and offers it with the resampling algorithms of
+  QwtMatrixRasterData.
+
+  The file starts with a header of 64 bytes ( native byte order ):
+
+  <table>
+    <tr><th>Offset</th><th>Type</th><th>Content</th></tr>
+    <tr><td>0</td><td>char[8]</td><td>"QWTRASTR"</td></tr>
+    <tr><td>8</td><td>quint32</td><td>QwtMatrixRasterData::ValueType</td></tr>
+    <tr><td>12</td><td>quint32</td><td>Number of columns</td></tr>
+    <tr><td>16</td><td>quint32</td><td>Number of rows</td></tr>
+    <tr><td>20</td><td>quint32</td><td>Reserved ( 0 )</td></tr>
+    <tr><td>24</td><td>double[4]</td><td>x1, x2, y1, y2</td></tr>
+    <tr><td>56</td><td>char[8]</td><td>Reserved ( 0 )</td></tr>
+  </table>
+
+  It is followed by the values, row by row. x1, x2, y1, y2 are the
+  bounding intervals of the X and Y axes ( see QwtMatrixRasterData::setInterval() ).
+
+  Unless an interval has been assigned explicitly, the interval
+  of the Z axis is the range of the values, what is calculated,
+  when interval( Qt::ZAxis ) is called the first time.
+  Like in QwtMappedPointData the result is stored in a sidecar file.
+
+  \note The number of values is limited to 2^31 - 1.
+  \sa QwtMappedPointData, QwtMatrixRasterData::setRawValueMatrix()
+*/
+class QWT_EXPORT QwtMappedRasterData: public QwtRasterData
+{
+public:
+    explicit QwtMappedRasterData( const QString &fileName );
+    virtual ~QwtMappedRasterData();
+
+    bool isValid() const;
+    QString errorString() const;
+
+    void setSidecarFileName( const QString & );
+    QString sidecarFileName() const;
+
+    void setResampleMode( QwtMatrixRasterData::ResampleMode );
+    QwtMatrixRasterData::ResampleMode resampleMode() const;
+
+    QwtMatrixRasterData::ValueType valueType() const;
+
+    int numColumns() const;
+    int numRows() const;
+
+    void setInterval( Qt::Axis, const QwtInterval & );
+    virtual QwtInterval interval( Qt::Axis ) const QWT_OVERRIDE;
+
+    virtual QRectF pixelHint( const QRectF & ) const QWT_OVERRIDE;
+
+    virtual double value( double x, double y ) const QWT_OVERRIDE;
+
+    virtual void values( const double *x, double y,
+        double *result, int count ) const QWT_OVERRIDE;
+
+    virtual void blockValues( const double *x, int numX,
+        const double *y, int numY, double *result ) const QWT_OVERRIDE;
+
+private:
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
@@ -14,6 +14,14 @@
 #include <qnumeric.h>
 #include <qrect.h>
 
+#include <limits>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) \
+    || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define QWT_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 static inline double qwtHermiteInterpolate(
     double A, double B, double C, double D, double t )
 {
@@ -43,29 +51,591 @@ static inline double qwtBicubicInterpolate(
     return qwtHermiteInterpolate( v0, v1, v2, v3, dy );
 }
 
+namespace
+{
+    // what is needed for resampling the values of a matrix
+    class QwtMatrixGeometry
+    {
+    public:
+        QwtMatrixRasterData::ResampleMode resampleMode;
+
+        QwtInterval xInterval;
+        QwtInterval yInterval;
+
+        int numColumns;
+        int numRows;
+
+        double dx;
+        double dy;
+    };
+}
+
+template< typename T >
+static double qwtResampledValue( const QwtMatrixGeometry &m,
+    const T *values, double x, double y )
+{
+    const QwtInterval &xInterval = m.xInterval;
+    const QwtInterval &yInterval = m.yInterval;
+
+    if ( !( xInterval.contains(x) && yInterval.contains(y) ) )
+        return qQNaN();
+
+    double value;
+
+    switch( m.resampleMode )
+    {
+        case QwtMatrixRasterData::BicubicInterpolation:
+        {
+            const double colF = ( x - xInterval.minValue() ) / m.dx;
+            const double rowF = ( y - yInterval.minValue() ) / m.dy;
+
+            const int col = qRound( colF );
+            const int row = qRound( rowF );
+
+            int col0 = col - 2;
+            int col1 = col - 1;
+            int col2 = col;
+            int col3 = col + 1;
+
+            if ( col1 < 0 )
+                col1 = col2;
+
+            if ( col0 < 0 )
+                col0 = col1;
+
+            if ( col2 >= m.numColumns )
+                col2 = col1;
+
+            if ( col3 >= m.numColumns )
+                col3 = col2;
+
+            int row0 = row - 2;
+            int row1 = row - 1;
+            int row2 = row;
+            int row3 = row + 1;
+
+            if ( row1 < 0 )
+                row1 = row2;
+
+            if ( row0 < 0 )
+                row0 = row1;
+
+            if ( row2 >= m.numRows )
+                row2 = row1;
+
+            if ( row3 >= m.numRows )
+                row3 = row2;
+
+            const T *line0 = values + row0 * m.numColumns;
+            const T *line1 = values + row1 * m.numColumns;
+            const T *line2 = values + row2 * m.numColumns;
+            const T *line3 = values + row3 * m.numColumns;
+
+            value = qwtBicubicInterpolate(
+                line0[col0], line0[col1], line0[col2], line0[col3],
+                line1[col0], line1[col1], line1[col2], line1[col3],
+                line2[col0], line2[col1], line2[col2], line2[col3],
+                line3[col0], line3[col1], line3[col2], line3[col3],
+                colF - col + 0.5, rowF - row + 0.5 );
+
+            break;
+        }
+        case QwtMatrixRasterData::BilinearInterpolation:
+        {
+            int col1 = qRound( ( x - xInterval.minValue() ) / m.dx ) - 1;
+            int row1 = qRound( ( y - yInterval.minValue() ) / m.dy ) - 1;
+            int col2 = col1 + 1;
+            int row2 = row1 + 1;
+
+            if ( col1 < 0 )
+                col1 = col2;
+            else if ( col2 >= m.numColumns )
+                col2 = col1;
+
+            if ( row1 < 0 )
+                row1 = row2;
+            else if ( row2 >= m.numRows )
+                row2 = row1;
+
+            const double v11 = values[ row1 * m.numColumns + col1 ];
+            const double v21 = values[ row1 * m.numColumns + col2 ];
+            const double v12 = values[ row2 * m.numColumns + col1 ];
+            const double v22 = values[ row2 * m.numColumns + col2 ];
+
+            const double x2 = xInterval.minValue() + ( col2 + 0.5 ) * m.dx;
+            const double y2 = yInterval.minValue() + ( row2 + 0.5 ) * m.dy;
+
+            const double rx = ( x2 - x ) / m.dx;
+            const double ry = ( y2 - y ) / m.dy;
+
+            const double vr1 = rx * v11 + ( 1.0 - rx ) * v21;
+            const double vr2 = rx * v12 + ( 1.0 - rx ) * v22;
+
+            value = ry * vr1 + ( 1.0 - ry ) * vr2;
+
+            break;
+        }
+        case QwtMatrixRasterData::NearestNeighbour:
+        default:
+        {
+            int row = int( ( y - yInterval.minValue() ) / m.dy );
+            int col = int( ( x - xInterval.minValue() ) / m.dx );
+
+            // In case of intervals, where the maximum is included
+            // we get out of bound for row/col, when the value for the
+            // maximum is requested. Instead we return the value
+            // from the last row/col
+
+            if ( row >= m.numRows )
+                row = m.numRows - 1;
+
+            if ( col >= m.numColumns )
+                col = m.numColumns - 1;
+
+            value = values[ row * m.numColumns + col ];
+        }
+    }
+
+    return value;
+}
+
+// weights of the hermite interpolation, see qwtHermiteInterpolate
+static inline void qwtHermiteWeights( double t, double *w )
+{
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+
+    w[0] = -0.5 * t3 + t2 - 0.5 * t;
+    w[1] = 1.5 * t3 - 2.5 * t2 + 1.0;
+    w[2] = -1.5 * t3 + 2.0 * t2 + 0.5 * t;
+    w[3] = 0.5 * t3 - 0.5 * t2;
+}
+
+namespace
+{
+    /*
+        The columns of the matrix and their weights for resampling
+        the values at a row of x coordinates. It is calculated once
+        and shared by all rows of a block.
+
+        Each position has numTaps columns/weights, that are stored
+        tap by tap: columns[ tap * count + i ]
+     */
+    class QwtColumnTable
+    {
+    public:
+        QwtColumnTable( const QwtMatrixGeometry &, const double *x, int count );
+
+        int count;
+        int numTaps;
+
+        QVector<int> columns;
+        QVector<double> weights;
+
+        // positions outside of the matrix
+        QVector<int> outside;
+
+        // range of the columns, that are in use
+        int minColumn;
+        int maxColumn;
+    };
+}
+
+QwtColumnTable::QwtColumnTable(
+        const QwtMatrixGeometry &m, const double *x, int numX ):
+    count( numX ),
+    minColumn( m.numColumns ),
+    maxColumn( -1 )
+{
+    switch( m.resampleMode )
+    {
+        case QwtMatrixRasterData::BicubicInterpolation:
+            numTaps = 4;
+            break;
+
+        case QwtMatrixRasterData::BilinearInterpolation:
+            numTaps = 2;
+            break;
+
+        default:
+            numTaps = 1;
+    }
+
+    columns.resize( numTaps * count );
+    weights.resize( numTaps * count );
+
+    const QwtInterval &xInterval = m.xInterval;
+    const double x0 = xInterval.minValue();
+    const int numColumns = m.numColumns;
+
+    for ( int i = 0; i < count; i++ )
+    {
+        int c[4] = { 0, 0, 0, 0 };
+        double w[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+        if ( !xInterval.contains( x[i] ) )
+        {
+            outside += i;
+        }
+        else
+        {
+            // the same calculations as in qwtResampledValue
+
+            switch( m.resampleMode )
+            {
+                case QwtMatrixRasterData::BicubicInterpolation:
+                {
+                    const double colF = ( x[i] - x0 ) / m.dx;
+                    const int col = qRound( colF );
+
+                    c[0] = col - 2;
+                    c[1] = col - 1;
+                    c[2] = col;
+                    c[3] = col + 1;
+
+                    if ( c[1] < 0 )
+                        c[1] = c[2];
+
+                    if ( c[0] < 0 )
+                        c[0] = c[1];
+
+                    if ( c[2] >= numColumns )
+                        c[2] = c[1];
+
+                    if ( c[3] >= numColumns )
+                        c[3] = c[2];
+
+                    qwtHermiteWeights( colF - col + 0.5, w );
+                    break;
+                }
+                case QwtMatrixRasterData::BilinearInterpolation:
+                {
+                    c[0] = qRound( ( x[i] - x0 ) / m.dx ) - 1;
+                    c[1] = c[0] + 1;
+
+                    if ( c[0] < 0 )
+                        c[0] = c[1];
+                    else if ( c[1] >= numColumns )
+                        c[1] = c[0];
+
+                    const double x2 = x0 + ( c[1] + 0.5 ) * m.dx;
+
+                    w[0] = ( x2 - x[i] ) / m.dx;
+                    w[1] = 1.0 - w[0];
+                    break;
+                }
+                case QwtMatrixRasterData::NearestNeighbour:
+                default:
+                {
+                    c[0] = int( ( x[i] - x0 ) / m.dx );
+                    if ( c[0] >= numColumns )
+                        c[0] = numColumns - 1;
+
+                    w[0] = 1.0;
+                }
+            }
+
+            for ( int tap = 0; tap < numTaps; tap++ )
+            {
+                minColumn = qMin( minColumn, c[tap] );
+                maxColumn = qMax( maxColumn, c[tap] );
+            }
+        }
+
+        for ( int tap = 0; tap < numTaps; tap++ )
+        {
+            columns[ tap * count + i ] = c[tap];
+            weights[ tap * count + i ] = w[tap];
+        }
+    }
+}
+
+/*
+    Interpolate between matrix rows:
+
+        result[col] = w[0] * lines[0][col] + w[1] * lines[1][col] ...
+
+    As the number of columns of the matrix is usually much
+    smaller than the number of pixels, it is cheaper to do
+    this vertical pass first and then interpolate the pixels
+    from the result.
+ */
+template< typename T >
+static void qwtBlendRows( const T * const *lines, const double *w,
+    int numLines, int from, int to, double *result )
+{
+    for ( int col = from; col < to; col++ )
+    {
+        double v = 0.0;
+        for ( int k = 0; k < numLines; k++ )
+            v += w[k] * lines[k][col];
+
+        result[col] = v;
+    }
+}
+
+static void qwtBlendRows( const double * const *lines, const double *w,
+    int numLines, int from, int to, double *result )
+{
+    int col = from;
+
+#if QWT_USE_SSE2
+    for ( ; col + 2 <= to; col += 2 )
+    {
+        __m128d v = _mm_setzero_pd();
+
+        for ( int k = 0; k < numLines; k++ )
+        {
+            v = _mm_add_pd( v, _mm_mul_pd(
+                _mm_set1_pd( w[k] ), _mm_loadu_pd( lines[k] + col ) ) );
+        }
+
+        _mm_storeu_pd( result + col, v );
+    }
+#endif
+
+    for ( ; col < to; col++ )
+    {
+        double v = 0.0;
+        for ( int k = 0; k < numLines; k++ )
+            v += w[k] * lines[k][col];
+
+        result[col] = v;
+    }
+}
+
+// interpolate the pixels of a row from the result of qwtBlendRows
+static void qwtBlendColumns( const QwtColumnTable &table,
+    const double *values, double *result )
+{
+    const int count = table.count;
+    const int numTaps = table.numTaps;
+
+    const int *columns = table.columns.constData();
+    const double *weights = table.weights.constData();
+
+    int i = 0;
+
+#if QWT_USE_SSE2
+    for ( ; i + 2 <= count; i += 2 )
+    {
+        __m128d v = _mm_setzero_pd();
+
+        for ( int tap = 0; tap < numTaps; tap++ )
+        {
+            const int *c = columns + tap * count + i;
+            const double *w = weights + tap * count + i;
+
+            const __m128d tapValues = _mm_set_pd( values[ c[1] ], values[ c[0] ] );
+            v = _mm_add_pd( v, _mm_mul_pd( _mm_loadu_pd( w ), tapValues ) );
+        }
+
+        _mm_storeu_pd( result + i, v );
+    }
+#endif
+
+    for ( ; i < count; i++ )
+    {
+        double v = 0.0;
+        for ( int tap = 0; tap < numTaps; tap++ )
+        {
+            const int k = tap * count + i;
+            v += weights[k] * values[ columns[k] ];
+        }
+
+        result[i] = v;
+    }
+}
+
+template< typename T >
+static void qwtResampledBlock( const QwtMatrixGeometry &m, const T *values,
+    const double *x, int numX, const double *y, int numY, double *result )
+{
+    const QwtInterval &yInterval = m.yInterval;
+    const int numColumns = m.numColumns;
+    const int numRows = m.numRows;
+
+    const QwtColumnTable table( m, x, numX );
+
+    QVector<double> buffer;
+    if ( table.numTaps > 1 )
+        buffer.resize( numColumns );
+
+    const int *columns = table.columns.constData();
+
+    for ( int j = 0; j < numY; j++ )
+    {
+        double *out = result + j * numX;
+
+        if ( !yInterval.contains( y[j] ) )
+        {
+            for ( int i = 0; i < numX; i++ )
+                out[i] = qQNaN();
+
+            continue;
+        }
+
+        switch( m.resampleMode )
+        {
+            case QwtMatrixRasterData::BicubicInterpolation:
+            {
+                const double rowF = ( y[j] - yInterval.minValue() ) / m.dy;
+                const int row = qRound( rowF );
+
+                int rows[4] = { row - 2, row - 1, row, row + 1 };
+
+                if ( rows[1] < 0 )
+                    rows[1] = rows[2];
+
+                if ( rows[0] < 0 )
+                    rows[0] = rows[1];
+
+                if ( rows[2] >= numRows )
+                    rows[2] = rows[1];
+
+                if ( rows[3] >= numRows )
+                    rows[3] = rows[2];
+
+                const T *lines[4];
+                for ( int k = 0; k < 4; k++ )
+                    lines[k] = values + rows[k] * numColumns;
+
+                double w[4];
+                qwtHermiteWeights( rowF - row + 0.5, w );
+
+                qwtBlendRows( lines, w, 4,
+                    table.minColumn, table.maxColumn + 1, buffer.data() );
+                qwtBlendColumns( table, buffer.constData(), out );
+
+                break;
+            }
+            case QwtMatrixRasterData::BilinearInterpolation:
+            {
+                int row1 = qRound( ( y[j] - yInterval.minValue() ) / m.dy ) - 1;
+                int row2 = row1 + 1;
+
+                if ( row1 < 0 )
+                    row1 = row2;
+                else if ( row2 >= numRows )
+                    row2 = row1;
+
+                const double y2 = yInterval.minValue() + ( row2 + 0.5 ) * m.dy;
+
+                const T *lines[2] =
+                    { values + row1 * numColumns, values + row2 * numColumns };
+
+                double w[2];
+                w[0] = ( y2 - y[j] ) / m.dy;
+                w[1] = 1.0 - w[0];
+
+                qwtBlendRows( lines, w, 2,
+                    table.minColumn, table.maxColumn + 1, buffer.data() );
+                qwtBlendColumns( table, buffer.constData(), out );
+
+                break;
+            }
+            case QwtMatrixRasterData::NearestNeighbour:
+            default:
+            {
+                int row = int( ( y[j] - yInterval.minValue() ) / m.dy );
+                if ( row >= numRows )
+                    row = numRows - 1;
+
+                const T *line = values + row * numColumns;
+
+                for ( int i = 0; i < numX; i++ )
+                    out[i] = line[ columns[i] ];
+            }
+        }
+
+        for ( int i = 0; i < table.outside.size(); i++ )
+            out[ table.outside[i] ] = qQNaN();
+    }
+}
+
+template< typename T >
+static inline void qwtSetValue( QVector<T> &values, int index, double value )
+{
+    values.data()[ index ] = static_cast< T >( value );
+}
+
+template< typename T >
+static inline void qwtSetIntValue( QVector<T> &values, int index, double value )
+{
+    // rounded and bounded to the range of T
+
+    const double min = std::numeric_limits<T>::min();
+    const double max = std::numeric_limits<T>::max();
+
+    values.data()[ index ] = static_cast< T >( qRound( qBound( min, value, max ) ) );
+}
+
+template< typename T >
+static QVector<double> qwtToDoubles( const T *values, int size )
+{
+    QVector<double> doubles( size );
+    for ( int i = 0; i < size; i++ )
+        doubles[i] = values[i];
+
+    return doubles;
+}
+
 class QwtMatrixRasterData::PrivateData
 {
 public:
     PrivateData():
-        resampleMode(QwtMatrixRasterData::NearestNeighbour),
-        numColumns(0)
+        valueType( QwtMatrixRasterData::Double ),
+        rawValues( NULL ),
+        size( 0 ),
+        cleanupFunction( NULL ),
+        cleanupInfo( NULL )
+    {
+        geometry.resampleMode = QwtMatrixRasterData::NearestNeighbour;
+        geometry.numColumns = 0;
+        geometry.numRows = 0;
+        geometry.dx = 0.0;
+        geometry.dy = 0.0;
+    }
+
+    ~PrivateData()
     {
+        reset();
     }
 
-    inline double value(int row, int col) const
+    void reset()
     {
-        return values.data()[ row * numColumns + col ];
+        if ( cleanupFunction )
+            cleanupFunction( cleanupInfo );
+
+        cleanupFunction = NULL;
+        cleanupInfo = NULL;
+
+        values.clear();
+        floatValues.clear();
+        int16Values.clear();
+        uint16Values.clear();
+
+        rawValues = NULL;
+        size = 0;
     }
 
     QwtInterval intervals[3];
-    QwtMatrixRasterData::ResampleMode resampleMode;
+    QwtMatrixGeometry geometry;
 
+    QwtMatrixRasterData::ValueType valueType;
+
+    // only one of them is in use
     QVector<double> values;
-    int numColumns;
-    int numRows;
+    QVector<float> floatValues;
+    QVector<qint16> int16Values;
+    QVector<quint16> uint16Values;
+
+    // the values of the vector above or external memory
+    const void *rawValues;
+    int size;
 
-    double dx;
-    double dy;
+    QwtMatrixRasterData::CleanupFunction cleanupFunction;
+    void *cleanupInfo;
 };
 
 //! Constructor
@@ -89,7 +659,7 @@ QwtMatrixRasterData::~QwtMatrixRasterData()
 */
 void QwtMatrixRasterData::setResampleMode( ResampleMode mode )
 {
-    d_data->resampleMode = mode;
+    d_data->geometry.resampleMode = mode;
 }
 
 /*!
@@ -98,7 +668,7 @@ void QwtMatrixRasterData::setResampleMode( ResampleMode mode )
 */
 QwtMatrixRasterData::ResampleMode QwtMatrixRasterData::resampleMode() const
 {
-    return d_data->resampleMode;
+    return d_data->geometry.resampleMode;
 }
 
 /*!
@@ -147,6 +717,9 @@ QwtInterval QwtMatrixRasterData::interval( Qt::Axis axis ) const
    rectangles ( pixels ). Each value corresponds to the center of
    a pixel.
 
+   As QVector is implicitly shared, the values are not copied
+   as long as they are not modified.
+
    \param values Vector of values
    \param numColumns Number of columns
 
@@ -155,36 +728,226 @@ QwtInterval QwtMatrixRasterData::interval( Qt::Axis axis ) const
 void QwtMatrixRasterData::setValueMatrix(
     const QVector<double> &values, int numColumns )
 {
+    d_data->reset();
+
+    d_data->valueType = Double;
     d_data->values = values;
-    d_data->numColumns = qMax( numColumns, 0 );
+    d_data->rawValues = d_data->values.constData();
+    d_data->size = d_data->values.size();
+
+    d_data->geometry.numColumns = qMax( numColumns, 0 );
+    update();
+}
+
+/*!
+   \brief Assign a value matrix of floats
+
+   The values are stored as floats, what needs half of the memory
+   compared to doubles.
+
+   \param values Vector of values
+   \param numColumns Number of columns
+
+   \sa setValueMatrix(), valueType()
+*/
+void QwtMatrixRasterData::setValueMatrix(
+    const QVector<float> &values, int numColumns )
+{
+    d_data->reset();
+
+    d_data->valueType = Float;
+    d_data->floatValues = values;
+    d_data->rawValues = d_data->floatValues.constData();
+    d_data->size = d_data->floatValues.size();
+
+    d_data->geometry.numColumns = qMax( numColumns, 0 );
+    update();
+}
+
+/*!
+   \brief Assign a value matrix of 16 bit integers
+
+   \param values Vector of values
+   \param numColumns Number of columns
+
+   \sa setValueMatrix(), valueType()
+*/
+void QwtMatrixRasterData::setValueMatrix(
+    const QVector<qint16> &values, int numColumns )
+{
+    d_data->reset();
+
+    d_data->valueType = Int16;
+    d_data->int16Values = values;
+    d_data->rawValues = d_data->int16Values.constData();
+    d_data->size = d_data->int16Values.size();
+
+    d_data->geometry.numColumns = qMax( numColumns, 0 );
+    update();
+}
+
+/*!
+   \brief Assign a value matrix of unsigned 16 bit integers
+
+   \param values Vector of values
+   \param numColumns Number of columns
+
+   \sa setValueMatrix(), valueType()
+*/
+void QwtMatrixRasterData::setValueMatrix(
+    const QVector<quint16> &values, int numColumns )
+{
+    d_data->reset();
+
+    d_data->valueType = UInt16;
+    d_data->uint16Values = values;
+    d_data->rawValues = d_data->uint16Values.constData();
+    d_data->size = d_data->uint16Values.size();
+
+    d_data->geometry.numColumns = qMax( numColumns, 0 );
+    update();
+}
+
+/*!
+   \brief Assign a value matrix in external memory
+
+   The values are not copied and the memory has to stay valid until
+   another matrix is assigned or the raster data object is deleted.
+   Then cleanupFunction is called with cleanupInfo, when
+   cleanupFunction is not NULL.
+
+   Modifying the memory is possible, but the plot items, that are
+   displaying the data, need to be updated explicitly.
+
+   \param type Type of the values
+   \param values Values, row by row
+   \param numColumns Number of columns
+   \param numRows Number of rows
+   \param cleanupFunction Function, that is called, when
+          the memory is not in use anymore
+   \param cleanupInfo Parameter for cleanupFunction
+
+   \sa setValueMatrix(), valueType()
+   \note setValue() has no effect for external memory
+*/
+void QwtMatrixRasterData::setRawValueMatrix( ValueType type,
+    const void *values, int numColumns, int numRows,
+    CleanupFunction cleanupFunction, void *cleanupInfo )
+{
+    d_data->reset();
+
+    numColumns = qMax( numColumns, 0 );
+    numRows = qMax( numRows, 0 );
+
+    d_data->valueType = type;
+    d_data->rawValues = values;
+    d_data->size = ( values != NULL ) ? numColumns * numRows : 0;
+    d_data->cleanupFunction = cleanupFunction;
+    d_data->cleanupInfo = cleanupInfo;
+
+    d_data->geometry.numColumns = numColumns;
     update();
 }
 
 /*!
-   \return Value matrix
+   \return Type of the values of the matrix
+   \sa setValueMatrix(), setRawValueMatrix()
+*/
+QwtMatrixRasterData::ValueType QwtMatrixRasterData::valueType() const
+{
+    return d_data->valueType;
+}
+
+/*!
+   \return Value matrix, converted to doubles when
+           the values are stored in another type
    \sa setValueMatrix(), numColumns(), numRows(), setInterval()
 */
 const QVector<double> QwtMatrixRasterData::valueMatrix() const
 {
-    return d_data->values;
+    const void *values = d_data->rawValues;
+
+    if ( values == d_data->values.constData() )
+        return d_data->values;
+
+    switch( d_data->valueType )
+    {
+        case Float:
+            return qwtToDoubles( static_cast< const float * >( values ), d_data->size );
+
+        case Int16:
+            return qwtToDoubles( static_cast< const qint16 * >( values ), d_data->size );
+
+        case UInt16:
+            return qwtToDoubles( static_cast< const quint16 * >( values ), d_data->size );
+
+        case Double:
+        default:
+            return qwtToDoubles( static_cast< const double * >( values ), d_data->size );
+    }
 }
 
 /*!
   \brief Change a single value in the matrix
 
+  For integer types the value is rounded and bounded.
+
   \param row Row index
   \param col Column index
   \param value New value
 
   \sa value(), setValueMatrix()
+  \note Values in external memory can't be modified by setValue()
 */
 void QwtMatrixRasterData::setValue( int row, int col, double value )
 {
-    if ( row >= 0 && row < d_data->numRows &&
-        col >= 0 && col < d_data->numColumns )
+    const QwtMatrixGeometry &m = d_data->geometry;
+
+    if ( row >= 0 && row < m.numRows && col >= 0 && col < m.numColumns )
     {
-        const int index = row * d_data->numColumns + col;
-        d_data->values.data()[ index ] = value;
+        const int index = row * m.numColumns + col;
+
+        // modifying might detach a vector
+
+        switch( d_data->valueType )
+        {
+            case Float:
+            {
+                if ( d_data->rawValues == d_data->floatValues.constData() )
+                {
+                    qwtSetValue( d_data->floatValues, index, value );
+                    d_data->rawValues = d_data->floatValues.constData();
+                }
+                break;
+            }
+            case Int16:
+            {
+                if ( d_data->rawValues == d_data->int16Values.constData() )
+                {
+                    qwtSetIntValue( d_data->int16Values, index, value );
+                    d_data->rawValues = d_data->int16Values.constData();
+                }
+                break;
+            }
+            case UInt16:
+            {
+                if ( d_data->rawValues == d_data->uint16Values.constData() )
+                {
+                    qwtSetIntValue( d_data->uint16Values, index, value );
+                    d_data->rawValues = d_data->uint16Values.constData();
+                }
+                break;
+            }
+            case Double:
+            default:
+            {
+                if ( d_data->rawValues == d_data->values.constData() )
+                {
+                    qwtSetValue( d_data->values, index, value );
+                    d_data->rawValues = d_data->values.constData();
+                }
+            }
+        }
     }
 }
 
@@ -194,7 +957,7 @@ void QwtMatrixRasterData::setValue( int row, int col, double value )
 */
 int QwtMatrixRasterData::numColumns() const
 {
-    return d_data->numColumns;
+    return d_data->geometry.numColumns;
 }
 
 /*!
@@ -203,7 +966,7 @@ int QwtMatrixRasterData::numColumns() const
 */
 int QwtMatrixRasterData::numRows() const
 {
-    return d_data->numRows;
+    return d_data->geometry.numRows;
 }
 
 /*!
@@ -231,14 +994,14 @@ QRectF QwtMatrixRasterData::pixelHint( const QRectF &area ) const
     Q_UNUSED( area )
 
     QRectF rect;
-    if ( d_data->resampleMode == NearestNeighbour )
+    if ( d_data->geometry.resampleMode == NearestNeighbour )
     {
         const QwtInterval intervalX = interval( Qt::XAxis );
         const QwtInterval intervalY = interval( Qt::YAxis );
         if ( intervalX.isValid() && intervalY.isValid() )
         {
             rect = QRectF( intervalX.minValue(), intervalY.minValue(),
-                d_data->dx, d_data->dy );
+                d_data->geometry.dx, d_data->geometry.dy );
         }
     }
 
@@ -255,163 +1018,127 @@ QRectF QwtMatrixRasterData::pixelHint( const QRectF &area ) const
 */
 double QwtMatrixRasterData::value( double x, double y ) const
 {
-    const QwtInterval xInterval = interval( Qt::XAxis );
-    const QwtInterval yInterval = interval( Qt::YAxis );
+    const QwtMatrixGeometry &m = d_data->geometry;
+    const void *values = d_data->rawValues;
 
-    if ( !( xInterval.contains(x) && yInterval.contains(y) ) )
+    if ( values == NULL || m.numRows <= 0 )
         return qQNaN();
 
-    double value;
-
-    switch( d_data->resampleMode )
+    switch( d_data->valueType )
     {
-        case BicubicInterpolation:
-        {
-            const double colF = ( x - xInterval.minValue() ) / d_data->dx;
-            const double rowF = ( y - yInterval.minValue() ) / d_data->dy;
-
-            const int col = qRound( colF );
-            const int row = qRound( rowF );
-
-            int col0 = col - 2;
-            int col1 = col - 1;
-            int col2 = col;
-            int col3 = col + 1;
-
-            if ( col1 < 0 )
-                col1 = col2;
+        case Float:
+            return qwtResampledValue( m, static_cast< const float * >( values ), x, y );
 
-            if ( col0 < 0 )
-                col0 = col1;
-
-            if ( col2 >= d_data->numColumns )
-                col2 = col1;
-
-            if ( col3 >= d_data->numColumns )
-                col3 = col2;
+        case Int16:
+            return qwtResampledValue( m, static_cast< const qint16 * >( values ), x, y );
 
-            int row0 = row - 2;
-            int row1 = row - 1;
-            int row2 = row;
-            int row3 = row + 1;
+        case UInt16:
+            return qwtResampledValue( m, static_cast< const quint16 * >( values ), x, y );
 
-            if ( row1 < 0 )
-                row1 = row2;
+        case Double:
+        default:
+            return qwtResampledValue( m, static_cast< const double * >( values ), x, y );
+    }
+}
 
-            if ( row0 < 0 )
-                row0 = row1;
-            
-            if ( row2 >= d_data->numRows )
-                row2 = row1;
-            
-            if ( row3 >= d_data->numRows )
-                row3 = row2;
+/*!
+   \brief Find the values for a row of raster positions
 
-            // First row
-            const double v00 = d_data->value( row0, col0 );
-            const double v10 = d_data->value( row0, col1 );
-            const double v20 = d_data->value( row0, col2 );
-            const double v30 = d_data->value( row0, col3 );
-
-            // Second row
-            const double v01 = d_data->value( row1, col0 );
-            const double v11 = d_data->value( row1, col1 );
-            const double v21 = d_data->value( row1, col2 );
-            const double v31 = d_data->value( row1, col3 );
-
-            // Third row
-            const double v02 = d_data->value( row2, col0 );
-            const double v12 = d_data->value( row2, col1 );
-            const double v22 = d_data->value( row2, col2 );
-            const double v32 = d_data->value( row2, col3 );
-
-            // Fourth row
-            const double v03 = d_data->value( row3, col0 );
-            const double v13 = d_data->value( row3, col1 );
-            const double v23 = d_data->value( row3, col2 );
-            const double v33 = d_data->value( row3, col3 );
+   The same as calling blockValues() for a single row.
 
-            value = qwtBicubicInterpolate(
-                v00, v10, v20, v30, v01, v11, v21, v31,
-                v02, v12, v22, v32, v03, v13, v23, v33,
-                colF - col + 0.5, rowF - row + 0.5 );
+   \param x Array of x values in plot coordinates
+   \param y Y value in plot coordinates
+   \param result Array for the values
+   \param count Number of values
 
-            break;
-        }
-        case BilinearInterpolation:
-        {
-            int col1 = qRound( ( x - xInterval.minValue() ) / d_data->dx ) - 1;
-            int row1 = qRound( ( y - yInterval.minValue() ) / d_data->dy ) - 1;
-            int col2 = col1 + 1;
-            int row2 = row1 + 1;
+   \sa value(), blockValues(), ResampleMode
+*/
+void QwtMatrixRasterData::values( const double *x, double y,
+    double *result, int count ) const
+{
+    QwtMatrixRasterData::blockValues( x, count, &y, 1, result );
+}
 
-            if ( col1 < 0 )
-                col1 = col2;
-            else if ( col2 >= d_data->numColumns )
-                col2 = col1;
+/*!
+   \brief Find the values for a grid of raster positions
 
-            if ( row1 < 0 )
-                row1 = row2;
-            else if ( row2 >= d_data->numRows )
-                row2 = row1;
+   The columns of the matrix and the interpolation weights for
+   the x coordinates are calculated once for all rows of the block.
+   For BilinearInterpolation and BicubicInterpolation the rows of the
+   matrix are interpolated first, so that each value is interpolated
+   from 2 or 4 values only. When available SSE2 instructions are used.
 
-            const double v11 = d_data->value( row1, col1 );
-            const double v21 = d_data->value( row1, col2 );
-            const double v12 = d_data->value( row2, col1 );
-            const double v22 = d_data->value( row2, col2 );
+   The results might differ from value() by rounding errors.
 
-            const double x2 = xInterval.minValue() + ( col2 + 0.5 ) * d_data->dx;
-            const double y2 = yInterval.minValue() + ( row2 + 0.5 ) * d_data->dy;
+   \param x Array of x values in plot coordinates
+   \param numX Number of x values
+   \param y Array of y values in plot coordinates
+   \param numY Number of y values
+   \param result Array for numX * numY values, row by row
 
-            const double rx = ( x2 - x ) / d_data->dx;
-            const double ry = ( y2 - y ) / d_data->dy;
+   \sa value(), values(), ResampleMode
+*/
+void QwtMatrixRasterData::blockValues( const double *x, int numX,
+    const double *y, int numY, double *result ) const
+{
+    const QwtMatrixGeometry &m = d_data->geometry;
+    const void *values = d_data->rawValues;
 
-            const double vr1 = rx * v11 + ( 1.0 - rx ) * v21;
-            const double vr2 = rx * v12 + ( 1.0 - rx ) * v22;
+    if ( values == NULL || m.numRows <= 0 )
+    {
+        for ( int i = 0; i < numX * numY; i++ )
+            result[i] = qQNaN();
 
-            value = ry * vr1 + ( 1.0 - ry ) * vr2;
+        return;
+    }
 
+    switch( d_data->valueType )
+    {
+        case Float:
+        {
+            qwtResampledBlock( m, static_cast< const float * >( values ),
+                x, numX, y, numY, result );
+            break;
+        }
+        case Int16:
+        {
+            qwtResampledBlock( m, static_cast< const qint16 * >( values ),
+                x, numX, y, numY, result );
+            break;
+        }
+        case UInt16:
+        {
+            qwtResampledBlock( m, static_cast< const quint16 * >( values ),
+                x, numX, y, numY, result );
             break;
         }
-        case NearestNeighbour:
+        case Double:
         default:
         {
-            int row = int( ( y - yInterval.minValue() ) / d_data->dy );
-            int col = int( ( x - xInterval.minValue() ) / d_data->dx );
-
-            // In case of intervals, where the maximum is included
-            // we get out of bound for row/col, when the value for the
-            // maximum is requested. Instead we return the value
-            // from the last row/col
-
-            if ( row >= d_data->numRows )
-                row = d_data->numRows - 1;
-
-            if ( col >= d_data->numColumns )
-                col = d_data->numColumns - 1;
-
-            value = d_data->value( row, col );
+            qwtResampledBlock( m, static_cast< const double * >( values ),
+                x, numX, y, numY, result );
         }
     }
-
-    return value;
 }
 
 void QwtMatrixRasterData::update()
 {
-    d_data->numRows = 0;
-    d_data->dx = 0.0;
-    d_data->dy = 0.0;
+    QwtMatrixGeometry &m = d_data->geometry;
 
-    if ( d_data->numColumns > 0 )
+    m.xInterval = interval( Qt::XAxis );
+    m.yInterval = interval( Qt::YAxis );
+
+    m.numRows = 0;
+    m.dx = 0.0;
+    m.dy = 0.0;
+
+    if ( m.numColumns > 0 )
     {
-        d_data->numRows = d_data->values.size() / d_data->numColumns;
-
-        const QwtInterval xInterval = interval( Qt::XAxis );
-        const QwtInterval yInterval = interval( Qt::YAxis );
-        if ( xInterval.isValid() )
-            d_data->dx = xInterval.width() / d_data->numColumns;
-        if ( yInterval.isValid() )
-            d_data->dy = yInterval.width() / d_data->numRows;
+        m.numRows = d_data->size / m.numColumns;
+
+        if ( m.xInterval.isValid() )
+            m.dx = m.xInterval.width() / m.numColumns;
+        if ( m.yInterval.isValid() && m.numRows > 0 )
+            m.dy = m.yInterval.width() / m.numRows;
     }
 }
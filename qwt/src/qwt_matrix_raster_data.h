@@ -24,6 +24,15 @@ template <typename T> class QVector;
   equidistant values, that can be used by a QwtPlotRasterItem.
   It implements a couple of resampling algorithms, to provide
   values for positions, that or not on the value matrix.
+
+  The values might be stored as double, float or 16 bit integers,
+  or can be located in external memory ( f.e. a memory mapped file ).
+
+  \note values() and blockValues() resample the matrix without calling
+        value(). A derived class, that reimplements value(), also has
+        to reimplement values() and blockValues() - f.e. by calling
+        QwtRasterData::values() and QwtRasterData::blockValues(),
+        that call value() for each position.
 */
 class QWT_EXPORT QwtMatrixRasterData: public QwtRasterData
 {
@@ -53,6 +62,32 @@ public:
         BicubicInterpolation
     };
 
+    /*!
+      \brief Type of the values in the matrix
+      \sa setValueMatrix(), setRawValueMatrix()
+     */
+    enum ValueType
+    {
+        //! double
+        Double,
+
+        //! float
+        Float,
+
+        //! qint16
+        Int16,
+
+        //! quint16
+        UInt16
+    };
+
+    /*!
+      Function, that is called, when external memory
+      is not in use anymore.
+      \sa setRawValueMatrix()
+     */
+    typedef void ( *CleanupFunction )( void * );
+
     QwtMatrixRasterData();
     virtual ~QwtMatrixRasterData();
 
@@ -63,6 +98,16 @@ public:
     virtual QwtInterval interval( Qt::Axis axis) const QWT_OVERRIDE QWT_FINAL;
 
     void setValueMatrix( const QVector<double> &values, int numColumns );
+    void setValueMatrix( const QVector<float> &values, int numColumns );
+    void setValueMatrix( const QVector<qint16> &values, int numColumns );
+    void setValueMatrix( const QVector<quint16> &values, int numColumns );
+
+    void setRawValueMatrix( ValueType, const void *values,
+        int numColumns, int numRows,
+        CleanupFunction cleanupFunction = NULL, void *cleanupInfo = NULL );
+
+    ValueType valueType() const;
+
     const QVector<double> valueMatrix() const;
 
     void setValue( int row, int col, double value );
@@ -74,6 +119,12 @@ public:
 
     virtual double value( double x, double y ) const QWT_OVERRIDE;
 
+    virtual void values( const double *x, double y,
+        double *result, int count ) const QWT_OVERRIDE;
+
+    virtual void blockValues( const double *x, int numX,
+        const double *y, int numY, double *result ) const QWT_OVERRIDE;
+
 private:
     void update();
 
@@ -17,13 +17,30 @@
 #include "qwt_legend.h"
 #include "qwt_legend_data.h"
 #include "qwt_plot_canvas.h"
+#include "qwt_painter.h"
+#include "qwt_graphic.h"
+#include "qwt_painter_command.h"
+#include "qwt_plot_replot_scheduler.h"
+#include "qwt_render_scheduler.h"
 #include "qwt_math.h"
 
 #include <qpainter.h>
+#include <qpaintengine.h>
+#include <qimage.h>
 #include <qpointer.h>
 #include <qapplication.h>
 #include <qcoreevent.h>
 
+#if !defined(QT_NO_QFUTURE)
+#define QWT_USE_THREADS 1
+#endif
+
+#if QWT_USE_THREADS
+#include <qfuture.h>
+#include <qfuturewatcher.h>
+#include <qtconcurrentrun.h>
+#endif
+
 static inline void qwtEnableLegendItems( QwtPlot *plot, bool on )
 {
     // gcc seems to have problems with const char sig[] in combination with certain options
@@ -84,6 +101,243 @@ static void qwtSetTabOrder(
     }
 }
 
+namespace
+{
+    class QwtPlotCacheLayer
+    {
+    public:
+        QwtPlotCacheLayer():
+            layer( -1 ),
+            isValid( false ),
+            generation( 0 ),
+            renderGeneration( 0 ),
+            renderJob( NULL )
+        {
+        }
+
+        int layer;
+        QwtPlotItemList items;
+
+        // an invalid image is painted, until the new one is available
+        QImage image;
+        bool isValid;
+
+        // the canvas maps, the image has been rendered for
+        QwtScaleMap imageMaps[QwtPlot::axisCnt];
+
+        // incremented, whenever the layer gets invalidated
+        int generation;
+
+        // the generation, the running render job has been started for
+        int renderGeneration;
+        QwtScaleMap renderMaps[QwtPlot::axisCnt];
+        QObject *renderJob;
+
+        // cancelled, when the result of the running job is outdated
+        QwtRenderToken renderToken;
+
+        inline void invalidate()
+        {
+            isValid = false;
+            generation++;
+
+            renderToken.cancel();
+        }
+
+        inline void setImageMaps( const QwtScaleMap maps[QwtPlot::axisCnt] )
+        {
+            for ( int axisId = 0; axisId < QwtPlot::axisCnt; axisId++ )
+                imageMaps[axisId] = maps[axisId];
+        }
+    };
+}
+
+/*
+    Offset in paint device coordinates, when map has been
+    translated to newMap. Returns false, when the maps
+    differ by more than a translation
+ */
+static bool qwtTranslation( const QwtScaleMap &map,
+    const QwtScaleMap &newMap, double &offset )
+{
+    const double eps = 1e-6 * qAbs( map.pDist() ) + 1e-9;
+
+    const double d1 = newMap.transform( map.s1() ) - map.p1();
+    const double d2 = newMap.transform( map.s2() ) - map.p2();
+
+    if ( qAbs( d1 - d2 ) > eps )
+        return false;
+
+    // catching different transformations with the same boundaries
+    const double p = 0.5 * ( map.p1() + map.p2() );
+    const double d3 = newMap.transform( map.invTransform( p ) ) - p;
+
+    if ( qAbs( d1 - d3 ) > eps )
+        return false;
+
+    offset = d1;
+    return true;
+}
+
+/*
+    Position of an outdated image of a cache layer. When the scales
+    of its items have been translated since the image has been rendered,
+    it is shifted by the same offset. Returns false, when the image
+    can't be aligned to the current maps.
+ */
+static bool qwtImagePosition( const QwtPlotCacheLayer &layer,
+    const QwtScaleMap maps[QwtPlot::axisCnt], const QRectF &canvasRect,
+    QPointF &pos )
+{
+    bool isUsed[QwtPlot::axisCnt] = { false };
+
+    for ( int i = 0; i < layer.items.size(); i++ )
+    {
+        const QwtPlotItem *item = layer.items[i];
+
+        isUsed[item->xAxis()] = true;
+        isUsed[item->yAxis()] = true;
+    }
+
+    double delta[2] = { 0.0, 0.0 };
+    bool hasDelta[2] = { false, false };
+
+    for ( int axisId = 0; axisId < QwtPlot::axisCnt; axisId++ )
+    {
+        if ( !isUsed[axisId] )
+            continue;
+
+        double offset;
+        if ( !qwtTranslation( layer.imageMaps[axisId], maps[axisId], offset ) )
+            return false;
+
+        const bool isXAxis =
+            ( axisId == QwtPlot::xBottom ) || ( axisId == QwtPlot::xTop );
+
+        const int idx = isXAxis ? 0 : 1;
+
+        if ( hasDelta[idx] && qAbs( delta[idx] - offset ) > 1e-6 )
+            return false;
+
+        delta[idx] = offset;
+        hasDelta[idx] = true;
+    }
+
+    pos = canvasRect.topLeft() + QPointF( delta[0], delta[1] );
+    return true;
+}
+
+static QImage qwtLayerImage( const QSize &imageSize, qreal pixelRatio )
+{
+    QImage image( imageSize, QImage::Format_ARGB32_Premultiplied );
+#if QT_VERSION >= 0x050000
+    image.setDevicePixelRatio( pixelRatio );
+#else
+    Q_UNUSED( pixelRatio )
+#endif
+    image.fill( Qt::transparent );
+
+    return image;
+}
+
+#if QWT_USE_THREADS
+
+static QImage qwtRenderGraphic( const QwtGraphic &graphic,
+    const QSize &imageSize, qreal pixelRatio, const QRectF &canvasRect,
+    const QwtRenderToken &token )
+{
+    // QwtGraphic::render() stops, when the token gets cancelled
+    QwtRenderScheduler::Scope scope( token, QwtRenderScheduler::LowPriority );
+
+    if ( token.isCancelled() )
+        return QImage();
+
+    QImage image = qwtLayerImage( imageSize, pixelRatio );
+
+    QPainter painter( &image );
+    painter.translate( -canvasRect.topLeft() );
+
+    graphic.render( &painter );
+
+    return image;
+}
+
+static bool qwtHasPixmaps( const QwtGraphic &graphic )
+{
+    // QPixmap is not supposed to be used outside of the GUI thread
+
+    const QVector<QwtPainterCommand> &commands = graphic.commands();
+    for ( int i = 0; i < commands.size(); i++ )
+    {
+        if ( commands[i].type() == QwtPainterCommand::Pixmap )
+            return true;
+    }
+
+    return false;
+}
+
+#endif
+
+static void qwtDrawItem( QPainter *painter, const QwtPlotItem *item,
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRectF &canvasRect )
+{
+    painter->save();
+
+    painter->setRenderHint( QPainter::Antialiasing,
+        item->testRenderHint( QwtPlotItem::RenderAntialiased ) );
+
+#if QT_VERSION < 0x050100
+    painter->setRenderHint( QPainter::HighQualityAntialiasing,
+        item->testRenderHint( QwtPlotItem::RenderAntialiased ) );
+#endif
+
+    item->draw( painter, xMap, yMap, canvasRect );
+
+    painter->restore();
+}
+
+static void qwtDrawItems( QPainter *painter, const QwtPlotItemList &items,
+    const QwtScaleMap maps[QwtPlot::axisCnt], const QRectF &canvasRect )
+{
+    for ( int i = 0; i < items.size(); i++ )
+    {
+        const QwtPlotItem *item = items[i];
+
+        qwtDrawItem( painter, item,
+            maps[item->xAxis()], maps[item->yAxis()], canvasRect );
+    }
+}
+
+static bool qwtHasCacheLayers( const QwtPlotItemList &items )
+{
+    for ( QwtPlotItemIterator it = items.begin(); it != items.end(); ++it )
+    {
+        if ( ( *it )->cacheLayer() >= 0 )
+            return true;
+    }
+
+    return false;
+}
+
+static bool qwtIsRasterDevice( const QPainter *painter )
+{
+    // caching doesn't make sense, when the canvas is not painted to screen
+
+    switch ( painter->paintEngine()->type() )
+    {
+        case QPaintEngine::SVG:
+        case QPaintEngine::Pdf:
+#if QT_VERSION < 0x060000
+        case QPaintEngine::PostScript:
+#endif
+        case QPaintEngine::MacPrinter:
+        case QPaintEngine::Picture:
+            return false;
+        default:
+            return true;
+    }
+}
+
 class QwtPlot::PrivateData
 {
 public:
@@ -94,6 +348,14 @@ public:
     QwtPlotLayout *layout;
 
     bool autoReplot;
+    bool asyncRendering;
+    bool isInteractive;
+
+    QPointer<QwtPlotReplotScheduler> replotScheduler;
+
+    // geometry and scales, the cache layers have been rendered for
+    QVector<double> cacheKey;
+    QList<QwtPlotCacheLayer> cacheLayers;
 };
 
 /*!
@@ -120,6 +382,8 @@ QwtPlot::QwtPlot( const QwtText &title, QWidget *parent ):
 //! Destructor
 QwtPlot::~QwtPlot()
 {
+    invalidateCacheLayers(); // cancelling running render jobs
+
     setAutoReplot( false );
     detachItems( QwtPlotItem::Rtti_PlotItem, autoDelete() );
 
@@ -138,6 +402,8 @@ void QwtPlot::initPlot( const QwtText &title )
 
     d_data->layout = new QwtPlotLayout;
     d_data->autoReplot = false;
+    d_data->asyncRendering = false;
+    d_data->isInteractive = false;
 
     // title
     d_data->titleLabel = new QwtTextLabel( this );
@@ -253,7 +519,10 @@ bool QwtPlot::event( QEvent *event )
   The plot handles the following events for the canvas:
 
   - QEvent::Resize
-    The canvas margins might depend on its size
+    The canvas margins might depend on its size. Items with
+    QwtPlotItem::ScaleInterest are notified by QwtPlotItem::updateScaleDiv(),
+    as their representation might depend on the geometry of the canvas
+    ( f.e. a series reduced to the pixel columns of the canvas ).
 
   - QEvent::ContentsRectChange
     The layout needs to be recalculated
@@ -272,6 +541,18 @@ bool QwtPlot::eventFilter( QObject *object, QEvent *event )
         if ( event->type() == QEvent::Resize )
         {
             updateCanvasMargins();
+
+            const QwtPlotItemList& itmList = itemList();
+            for ( QwtPlotItemIterator it = itmList.begin();
+                it != itmList.end(); ++it )
+            {
+                QwtPlotItem *item = *it;
+                if ( item->testItemInterest( QwtPlotItem::ScaleInterest ) )
+                {
+                    item->updateScaleDiv( axisScaleDiv( item->xAxis() ),
+                        axisScaleDiv( item->yAxis() ) );
+                }
+            }
         }
         else if ( event->type() == QEvent::ContentsRectChange )
         {
@@ -282,13 +563,58 @@ bool QwtPlot::eventFilter( QObject *object, QEvent *event )
     return QFrame::eventFilter( object, event );
 }
 
-//! Replots the plot if autoReplot() is \c true.
+/*!
+  Replots the plot if autoReplot() is \c true.
+  \sa scheduleReplot()
+ */
 void QwtPlot::autoRefresh()
 {
     if ( d_data->autoReplot )
+        scheduleReplot();
+}
+
+/*!
+  \brief Request a replot
+
+  When a replot scheduler has been assigned, the request is passed
+  to it, so that it gets coalesced with other requests. Otherwise
+  replot() is called immediately.
+
+  \sa setReplotScheduler(), replot(), autoRefresh()
+ */
+void QwtPlot::scheduleReplot()
+{
+    if ( d_data->replotScheduler )
+        d_data->replotScheduler->requestReplot( this );
+    else
         replot();
 }
 
+/*!
+  \brief Assign a scheduler for coalescing replots
+
+  The requests of scheduleReplot() and the replots, that are triggered
+  by autoReplot(), are delayed until the next frame of the scheduler.
+  The scheduler is not owned by the plot and might be shared
+  with other plots.
+
+  \param scheduler Replot scheduler, or NULL to replot immediately
+  \sa replotScheduler(), scheduleReplot(), QwtPlotReplotScheduler
+ */
+void QwtPlot::setReplotScheduler( QwtPlotReplotScheduler *scheduler )
+{
+    d_data->replotScheduler = scheduler;
+}
+
+/*!
+  \return Scheduler for coalescing replots
+  \sa setReplotScheduler()
+ */
+QwtPlotReplotScheduler *QwtPlot::replotScheduler() const
+{
+    return d_data->replotScheduler;
+}
+
 /*!
   \brief Set or reset the autoReplot option
 
@@ -318,6 +644,80 @@ bool QwtPlot::autoReplot() const
     return d_data->autoReplot;
 }
 
+/*!
+  \brief En/Disable rasterizing the cache layers in a background thread
+
+  When asynchronous rendering is enabled, the items of an invalid
+  cache layer are recorded into a QwtGraphic - a snapshot of the
+  paint commands - which is rasterized into the image of the layer
+  in a background thread. Until the new image is available
+  the previous image of the layer is painted - shifted by the offset,
+  when the scales have been scrolled. When the scales have been changed
+  otherwise ( f.e. zooming ) the layer remains empty in the meantime.
+
+  Only the rasterization is done in the background: the items are
+  still drawn - including mapping their points - in the GUI thread,
+  when recording the paint commands, as plot items are not thread safe.
+  So asynchronous rendering helps with items, where painting the
+  recorded commands is the expensive part ( f.e. antialiased lines or
+  wide pens ), but not with items, that spend most of their time
+  in QwtPlotItem::draw().
+
+  Only one render job is running for each layer. When the layer
+  gets invalidated again, while the job is running, the job is cancelled
+  between two paint commands ( see QwtRenderToken ) and a new job
+  is started for the current state, when it has finished.
+
+  Items without a cache layer are always painted synchronously.
+  The default setting is false.
+
+  \param on Enabled, when true
+  \sa asyncRendering(), QwtPlotItem::setCacheLayer()
+
+  \note Layers with items, that paint pixmaps ( f.e. QwtSymbol::Pixmap )
+        are rendered in the GUI thread, as QPixmap is not thread safe.
+*/
+void QwtPlot::setAsyncRendering( bool on )
+{
+    d_data->asyncRendering = on;
+}
+
+/*!
+  \return true, when cache layers are rendered in a background thread
+  \sa setAsyncRendering()
+*/
+bool QwtPlot::asyncRendering() const
+{
+    return d_data->asyncRendering;
+}
+
+/*!
+  \brief Indicate, that the user is interacting with the plot
+
+  The interactive hint is set by navigation tools like QwtPlotMagnifier,
+  while the scales are modified in quick succession.
+  Items might reduce the quality of their rendering, while the hint
+  is set - f.e. QwtPlotRasterItem::ProgressiveRendering.
+
+  Resetting the hint does not replot the plot.
+  \param on Hint, that the user is interacting with the plot
+
+  \sa isInteractive(), QwtPlotRasterItem::ProgressiveRendering
+*/
+void QwtPlot::setInteractive( bool on )
+{
+    d_data->isInteractive = on;
+}
+
+/*!
+  \return Hint, that the user is interacting with the plot
+  \sa setInteractive()
+*/
+bool QwtPlot::isInteractive() const
+{
+    return d_data->isInteractive;
+}
+
 /*!
   Change the plot's title
   \param title New title
@@ -720,10 +1120,14 @@ void QwtPlot::updateCanvasMargins()
   Redraw the canvas.
   \param painter Painter used for drawing
 
+  When some of the items are assigned to a cache layer, the items
+  are painted using the cached images of the layers instead
+  of calling drawItems().
+
   \warning drawCanvas calls drawItems what is also used
            for printing. Applications that like to add individual
            plot items better overload drawItems()
-  \sa drawItems()
+  \sa drawItems(), QwtPlotItem::setCacheLayer()
 */
 void QwtPlot::drawCanvas( QPainter *painter )
 {
@@ -731,7 +1135,297 @@ void QwtPlot::drawCanvas( QPainter *painter )
     for ( int axisId = 0; axisId < axisCnt; axisId++ )
         maps[axisId] = canvasMap( axisId );
 
-    drawItems( painter, d_data->canvas->contentsRect(), maps );
+    const QRectF canvasRect = d_data->canvas->contentsRect();
+
+    if ( qwtHasCacheLayers( itemList() ) && qwtIsRasterDevice( painter ) )
+        drawCacheLayers( painter, canvasRect, maps );
+    else
+        drawItems( painter, canvasRect, maps );
+}
+
+/*!
+  \brief Invalidate the images of a cache layer
+
+  The items of the layer will be rendered again with the next
+  repaint of the canvas.
+
+  \param layer Cache layer
+  \sa QwtPlotItem::setCacheLayer(), invalidateCacheLayers()
+*/
+void QwtPlot::invalidateCacheLayer( int layer )
+{
+    QList<QwtPlotCacheLayer> &cacheLayers = d_data->cacheLayers;
+
+    for ( int i = 0; i < cacheLayers.size(); i++ )
+    {
+        QwtPlotCacheLayer &cacheLayer = cacheLayers[i];
+        if ( cacheLayer.layer == layer )
+            cacheLayer.invalidate();
+    }
+}
+
+/*!
+  \brief Invalidate the images of all cache layers
+  \sa QwtPlotItem::setCacheLayer(), invalidateCacheLayer()
+*/
+void QwtPlot::invalidateCacheLayers()
+{
+    QList<QwtPlotCacheLayer> &cacheLayers = d_data->cacheLayers;
+    for ( int i = 0; i < cacheLayers.size(); i++ )
+        cacheLayers[i].renderToken.cancel();
+
+    cacheLayers.clear();
+}
+
+/*
+  Draw the items of the canvas, when some of them are assigned
+  to cache layers. Items without a cache layer are painted directly,
+  while the items of a cache layer are painted from an image,
+  that is rendered, when it is not valid anymore.
+ */
+void QwtPlot::drawCacheLayers( QPainter *painter, const QRectF &canvasRect,
+    const QwtScaleMap maps[axisCnt] )
+{
+    const qreal pixelRatio = QwtPainter::devicePixelRatio( painter->device() );
+    const QSize imageSize = ( canvasRect.size() * pixelRatio ).toSize();
+
+    QVector<double> cacheKey;
+    cacheKey.reserve( 5 + 4 * axisCnt );
+
+    cacheKey << canvasRect.x() << canvasRect.y()
+        << canvasRect.width() << canvasRect.height() << pixelRatio;
+
+    for ( int axisId = 0; axisId < axisCnt; axisId++ )
+    {
+        const QwtScaleMap &map = maps[axisId];
+        cacheKey << map.s1() << map.s2() << map.p1() << map.p2();
+    }
+
+    if ( cacheKey != d_data->cacheKey )
+    {
+        d_data->cacheKey = cacheKey;
+
+        QList<QwtPlotCacheLayer> &cacheLayers = d_data->cacheLayers;
+        for ( int i = 0; i < cacheLayers.size(); i++ )
+        {
+            QwtPlotCacheLayer &cacheLayer = cacheLayers[i];
+            cacheLayer.invalidate();
+
+            // an outdated image can only be displayed in the same size
+            if ( cacheLayer.image.size() != imageSize )
+                cacheLayer.image = QImage();
+        }
+    }
+
+    // collecting the items in sequences of the same cache layer
+
+    QList<QwtPlotCacheLayer> layers;
+
+    const QwtPlotItemList& itmList = itemList();
+    for ( QwtPlotItemIterator it = itmList.begin();
+        it != itmList.end(); ++it )
+    {
+        QwtPlotItem *item = *it;
+        if ( item == NULL || !item->isVisible() )
+            continue;
+
+        const int layer = item->cacheLayer();
+
+        if ( layer < 0 || layers.isEmpty() || layers.last().layer != layer )
+        {
+            layers += QwtPlotCacheLayer();
+            layers.last().layer = layer;
+        }
+
+        layers.last().items += item;
+    }
+
+    for ( int i = 0; i < layers.size(); i++ )
+    {
+        QwtPlotCacheLayer &layer = layers[i];
+
+        if ( layer.layer < 0 )
+        {
+            const QwtPlotItem *item = layer.items.first();
+
+            qwtDrawItem( painter, item,
+                maps[item->xAxis()], maps[item->yAxis()], canvasRect );
+
+            continue;
+        }
+
+        for ( int j = 0; j < d_data->cacheLayers.size(); j++ )
+        {
+            const QwtPlotCacheLayer &cacheLayer = d_data->cacheLayers[j];
+
+            if ( cacheLayer.layer == layer.layer
+                && cacheLayer.items == layer.items )
+            {
+                layer = cacheLayer;
+                break;
+            }
+        }
+
+        if ( !layer.isValid && layer.renderJob == NULL )
+        {
+#if QWT_USE_THREADS
+            if ( d_data->asyncRendering )
+            {
+                // recording a snapshot of the items
+
+                QwtGraphic graphic;
+
+                QPainter p( &graphic );
+                p.setFont( painter->font() );
+                qwtDrawItems( &p, layer.items, maps, canvasRect );
+                p.end();
+
+                layer.renderToken = QwtRenderToken();
+
+                if ( qwtHasPixmaps( graphic ) )
+                {
+                    layer.image = qwtRenderGraphic( graphic,
+                        imageSize, pixelRatio, canvasRect, layer.renderToken );
+                    layer.setImageMaps( maps );
+                    layer.isValid = true;
+                }
+                else
+                {
+                    QFutureWatcher<QImage> *watcher =
+                        new QFutureWatcher<QImage>( this );
+
+                    connect( watcher, SIGNAL(finished()),
+                        SLOT(updateCacheLayer()) );
+
+                    // the threads of QwtRenderScheduler, cancelled by the token
+#if QT_VERSION >= 0x050400
+                    watcher->setFuture( QtConcurrent::run(
+                        QwtRenderScheduler::threadPool(), &qwtRenderGraphic,
+                        graphic, imageSize, pixelRatio, canvasRect,
+                        layer.renderToken ) );
+#else
+                    watcher->setFuture( QtConcurrent::run( &qwtRenderGraphic,
+                        graphic, imageSize, pixelRatio, canvasRect,
+                        layer.renderToken ) );
+#endif
+
+                    layer.renderJob = watcher;
+                    layer.renderGeneration = layer.generation;
+
+                    for ( int axisId = 0; axisId < axisCnt; axisId++ )
+                        layer.renderMaps[axisId] = maps[axisId];
+                }
+            }
+            else
+#endif
+            {
+                layer.image = qwtLayerImage( imageSize, pixelRatio );
+
+                QPainter p( &layer.image );
+                p.setFont( painter->font() );
+                p.translate( -canvasRect.topLeft() );
+                qwtDrawItems( &p, layer.items, maps, canvasRect );
+                p.end();
+
+                layer.setImageMaps( maps );
+                layer.isValid = true;
+            }
+        }
+
+        if ( layer.image.isNull() )
+            continue;
+
+        if ( layer.isValid )
+        {
+            painter->drawImage( canvasRect.topLeft(), layer.image );
+        }
+        else
+        {
+            /*
+                The outdated image is displayed, while the render job
+                is running. When the scales have been scrolled it is
+                shifted like the backing store of the canvas. Otherwise
+                it would be misleading and the layer remains empty,
+                until the new image is available.
+             */
+            QPointF pos;
+            if ( qwtImagePosition( layer, maps, canvasRect, pos ) )
+            {
+                painter->save();
+                painter->setClipRect( canvasRect, Qt::IntersectClip );
+                painter->drawImage( pos, layer.image );
+                painter->restore();
+            }
+        }
+    }
+
+    // cancelling the jobs of layers, that do not exist anymore
+
+    QList<QwtPlotCacheLayer> &cacheLayers = d_data->cacheLayers;
+    for ( int i = 0; i < cacheLayers.size(); i++ )
+    {
+        QwtPlotCacheLayer &cacheLayer = cacheLayers[i];
+        if ( cacheLayer.renderJob == NULL )
+            continue;
+
+        bool isObsolete = true;
+        for ( int j = 0; j < layers.size(); j++ )
+        {
+            if ( layers[j].renderJob == cacheLayer.renderJob )
+            {
+                isObsolete = false;
+                break;
+            }
+        }
+
+        if ( isObsolete )
+            cacheLayer.renderToken.cancel();
+    }
+
+    d_data->cacheLayers = layers;
+}
+
+/*
+  A render job of a cache layer has been finished. When the layer
+  has not been invalidated in the meantime its image gets replaced.
+  Otherwise the result is outdated and the repaint of the canvas
+  starts a new render job.
+ */
+void QwtPlot::updateCacheLayer()
+{
+#if QWT_USE_THREADS
+    QFutureWatcher<QImage> *watcher =
+        static_cast< QFutureWatcher<QImage> * >( sender() );
+
+    QList<QwtPlotCacheLayer> &cacheLayers = d_data->cacheLayers;
+
+    for ( int i = 0; i < cacheLayers.size(); i++ )
+    {
+        QwtPlotCacheLayer &cacheLayer = cacheLayers[i];
+
+        if ( cacheLayer.renderJob == watcher )
+        {
+            cacheLayer.renderJob = NULL;
+
+            if ( cacheLayer.renderGeneration == cacheLayer.generation )
+            {
+                cacheLayer.image = watcher->result();
+                cacheLayer.setImageMaps( cacheLayer.renderMaps );
+                cacheLayer.isValid = true;
+            }
+        }
+    }
+
+    watcher->deleteLater();
+
+    if ( d_data->canvas )
+    {
+        const bool ok = QMetaObject::invokeMethod(
+            d_data->canvas, "replot", Qt::DirectConnection );
+        if ( !ok )
+            d_data->canvas->update( d_data->canvas->contentsRect() );
+    }
+#endif
 }
 
 /*!
@@ -757,21 +1451,8 @@ void QwtPlot::drawItems( QPainter *painter, const QRectF &canvasRect,
         QwtPlotItem *item = *it;
         if ( item && item->isVisible() )
         {
-            painter->save();
-
-            painter->setRenderHint( QPainter::Antialiasing,
-                item->testRenderHint( QwtPlotItem::RenderAntialiased ) );
-
-#if QT_VERSION < 0x050100
-            painter->setRenderHint( QPainter::HighQualityAntialiasing,
-                item->testRenderHint( QwtPlotItem::RenderAntialiased ) );
-#endif
-
-            item->draw( painter,
-                maps[item->xAxis()], maps[item->yAxis()],
-                canvasRect );
-
-            painter->restore();
+            qwtDrawItem( painter, item,
+                maps[item->xAxis()], maps[item->yAxis()], canvasRect );
         }
     }
 }
@@ -1095,6 +1776,9 @@ void QwtPlot::attachItem( QwtPlotItem *plotItem, bool on )
     else
         removeItem( plotItem );
 
+    if ( plotItem->cacheLayer() >= 0 )
+        invalidateCacheLayer( plotItem->cacheLayer() );
+
     Q_EMIT itemAttached( plotItem, on );
 
     if ( plotItem->testItemAttribute( QwtPlotItem::Legend ) )
@@ -25,6 +25,7 @@ class QwtScaleDraw;
 class QwtTextLabel;
 class QwtInterval;
 class QwtText;
+class QwtPlotReplotScheduler;
 template <typename T> class QList;
 
 /*!
@@ -242,6 +243,18 @@ public:
     virtual void updateLayout();
     virtual void drawCanvas( QPainter * );
 
+    Q_INVOKABLE void invalidateCacheLayer( int layer );
+    void invalidateCacheLayers();
+
+    void setAsyncRendering( bool );
+    bool asyncRendering() const;
+
+    void setReplotScheduler( QwtPlotReplotScheduler * );
+    QwtPlotReplotScheduler *replotScheduler() const;
+
+    void setInteractive( bool );
+    bool isInteractive() const;
+
     void updateAxes();
     void updateCanvasMargins();
 
@@ -282,6 +295,7 @@ Q_SIGNALS:
 
 public Q_SLOTS:
     virtual void replot();
+    void scheduleReplot();
     void autoRefresh();
 
 protected:
@@ -293,6 +307,8 @@ private Q_SLOTS:
     void updateLegendItems( const QVariant &itemInfo,
         const QList<QwtLegendData> &legendData );
 
+    void updateCacheLayer();
+
 private:
     friend class QwtPlotItem;
     void attachItem( QwtPlotItem *, bool );
@@ -303,6 +319,9 @@ private:
 
     void initPlot( const QwtText &title );
 
+    void drawCacheLayers( QPainter *, const QRectF &,
+        const QwtScaleMap maps[axisCnt] );
+
     class AxisData;
     AxisData *d_axisData[axisCnt];
 
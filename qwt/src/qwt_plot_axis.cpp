@@ -153,6 +153,9 @@ void QwtPlot::setAxisScaleEngine( int axisId, QwtScaleEngine *scaleEngine )
 
         d.isValid = false;
 
+        // the maps might be the same, but with a different transformation
+        invalidateCacheLayers();
+
         autoRefresh();
     }
 }
@@ -10,6 +10,7 @@
 #include "qwt_plot_canvas.h"
 #include "qwt_painter.h"
 #include "qwt_plot.h"
+#include "qwt_scale_map.h"
 
 #ifndef QWT_NO_OPENGL
 
@@ -48,6 +49,49 @@ typedef QGLWidget QwtPlotCanvasSurfaceGL;
 #include <qpainterpath.h>
 #include <qevent.h>
 
+// pixels, that are painted again on both sides of a scrolled strip
+static const int qwtScrollOverlap = 2;
+
+static inline bool qwtIsXAxis( int axisId )
+{
+    return ( axisId == QwtPlot::xBottom ) || ( axisId == QwtPlot::xTop );
+}
+
+/*
+    Offset in paint device coordinates, when map has been
+    translated to newMap. Returns false, when the maps
+    differ by more than a translation
+ */
+static bool qwtScrollOffset( const QwtScaleMap &map,
+    const QwtScaleMap &newMap, double &offset )
+{
+    const double eps = 1e-6 * qAbs( map.pDist() ) + 1e-9;
+
+    const double d1 = newMap.transform( map.s1() ) - map.p1();
+    const double d2 = newMap.transform( map.s2() ) - map.p2();
+
+    if ( qAbs( d1 - d2 ) > eps )
+        return false;
+
+    // catching different transformations with the same boundaries
+    const double p = 0.5 * ( map.p1() + map.p2() );
+    const double d3 = newMap.transform( map.invTransform( p ) ) - p;
+
+    if ( qAbs( d1 - d3 ) > eps )
+        return false;
+
+    offset = d1;
+    return true;
+}
+
+static inline QwtScaleMap qwtShiftedMap( const QwtScaleMap &map, double offset )
+{
+    QwtScaleMap shiftedMap = map;
+    shiftedMap.setPaintInterval( map.p1() + offset, map.p2() + offset );
+
+    return shiftedMap;
+}
+
 class QwtPlotCanvas::PrivateData
 {
 public:
@@ -55,7 +99,8 @@ public:
 #ifndef QWT_NO_OPENGL
         surfaceGL( NULL ),
 #endif
-        backingStore( NULL )
+        backingStore( NULL ),
+        isScrollable( false )
     {
     }
 
@@ -75,6 +120,12 @@ public:
 #endif
 
     QPixmap *backingStore;
+
+    // what the content of the backing store has been painted for
+    bool isScrollable;
+    QRect scrollRect;
+    QwtPlotItemList scrollItems;
+    QwtScaleMap scrollMaps[QwtPlot::axisCnt];
 };
 
 /*!
@@ -181,6 +232,8 @@ void QwtPlotCanvas::invalidateBackingStore()
 {
     if ( d_data->backingStore )
         *d_data->backingStore = QPixmap();
+
+    d_data->isScrollable = false;
 }
 
 /*!
@@ -228,6 +281,7 @@ void QwtPlotCanvas::paintEvent( QPaintEvent *event )
         if ( bs.size() != size() * QwtPainter::devicePixelRatio( &bs ) )
         {
             bs = QwtPainter::backingStore( this, size() );
+            d_data->isScrollable = false;
 
 #ifndef QWT_NO_OPENGL
             if ( testPaintAttribute( OpenGLBuffer ) )
@@ -251,6 +305,8 @@ void QwtPlotCanvas::paintEvent( QPaintEvent *event )
                     QwtPainter::fillPixmap( this, bs );
                     p.begin( &bs );
                     drawCanvas( &p );
+
+                    updateScrollState();
                 }
                 else
                 {
@@ -353,11 +409,16 @@ void QwtPlotCanvas::resizeEvent( QResizeEvent *event )
 
 /*!
    Invalidate the paint cache and repaint the canvas
-   \sa invalidatePaintCache()
+
+   In ScrollBackingStore mode the backing store is shifted instead,
+   when the scales have only been translated.
+
+   \sa invalidatePaintCache(), ScrollBackingStore
 */
 void QwtPlotCanvas::replot()
 {
-    invalidateBackingStore();
+    if ( !( testPaintAttribute( ScrollBackingStore ) && scrollBackingStore() ) )
+        invalidateBackingStore();
 
     if ( testPaintAttribute( QwtPlotCanvas::ImmediatePaint ) )
         repaint( contentsRect() );
@@ -365,6 +426,205 @@ void QwtPlotCanvas::replot()
         update( contentsRect() );
 }
 
+/*
+   Remember the maps and items, the backing store has been painted for
+ */
+void QwtPlotCanvas::updateScrollState()
+{
+    d_data->isScrollable = false;
+
+    const QwtPlot *plot = this->plot();
+    if ( plot == NULL || !testPaintAttribute( ScrollBackingStore ) )
+        return;
+
+#ifndef QWT_NO_OPENGL
+    if ( testPaintAttribute( OpenGLBuffer ) )
+        return;
+#endif
+
+    d_data->scrollRect = contentsRect();
+    d_data->scrollItems.clear();
+
+    const QwtPlotItemList &items = plot->itemList();
+    for ( int i = 0; i < items.size(); i++ )
+    {
+        if ( items[i]->isVisible() )
+            d_data->scrollItems += items[i];
+    }
+
+    for ( int axisId = 0; axisId < QwtPlot::axisCnt; axisId++ )
+        d_data->scrollMaps[axisId] = plot->canvasMap( axisId );
+
+    d_data->isScrollable = true;
+}
+
+/*
+   Shift the content of the backing store, when the maps of the
+   axes have been translated and paint the exposed strips.
+   Returns false, when a complete repaint is necessary.
+ */
+bool QwtPlotCanvas::scrollBackingStore()
+{
+    QPixmap *bs = d_data->backingStore;
+    if ( bs == NULL || bs->isNull() || !d_data->isScrollable )
+        return false;
+
+    const QwtPlot *plot = this->plot();
+    if ( plot == NULL )
+        return false;
+
+    const QRect rect = contentsRect();
+    const qreal pixelRatio = QwtPainter::devicePixelRatio( bs );
+
+    if ( rect != d_data->scrollRect
+        || bs->size() != size() * pixelRatio
+        || testAttribute( Qt::WA_StyledBackground ) || borderRadius() > 0.0 )
+    {
+        return false;
+    }
+
+    QwtPlotItemList items;
+    bool isUsed[QwtPlot::axisCnt] = { false, false, false, false };
+
+    const QwtPlotItemList &itemList = plot->itemList();
+    for ( int i = 0; i < itemList.size(); i++ )
+    {
+        const QwtPlotItem *item = itemList[i];
+        if ( item->isVisible() )
+        {
+            items += itemList[i];
+
+            isUsed[ item->xAxis() ] = true;
+            isUsed[ item->yAxis() ] = true;
+        }
+    }
+
+    if ( items != d_data->scrollItems )
+        return false;
+
+    // the offsets of all x axes and of all y axes have to be the same
+
+    QwtScaleMap maps[QwtPlot::axisCnt];
+
+    double dx = 0.0;
+    double dy = 0.0;
+    bool hasX = false;
+    bool hasY = false;
+
+    for ( int axisId = 0; axisId < QwtPlot::axisCnt; axisId++ )
+    {
+        maps[axisId] = plot->canvasMap( axisId );
+
+        if ( !isUsed[axisId] )
+            continue;
+
+        double offset;
+        if ( !qwtScrollOffset( d_data->scrollMaps[axisId], maps[axisId], offset ) )
+            return false;
+
+        double &delta = qwtIsXAxis( axisId ) ? dx : dy;
+        bool &hasDelta = qwtIsXAxis( axisId ) ? hasX : hasY;
+
+        if ( hasDelta && qAbs( delta - offset ) > 1e-6 )
+            return false;
+
+        delta = offset;
+        hasDelta = true;
+    }
+
+    // shifting by device pixels
+
+    const int shiftX = qRound( dx * pixelRatio );
+    const int shiftY = qRound( dy * pixelRatio );
+
+    if ( shiftX == 0 && shiftY == 0 )
+        return false;
+
+    const QRect deviceRect = QRectF( QPointF( rect.topLeft() ) * pixelRatio,
+        QSizeF( rect.size() ) * pixelRatio ).toAlignedRect();
+
+    if ( qAbs( shiftX ) >= deviceRect.width() / 2
+        || qAbs( shiftY ) >= deviceRect.height() / 2 )
+    {
+        // not worth the effort
+        return false;
+    }
+
+    bs->scroll( shiftX, shiftY, deviceRect );
+
+    const double sx = shiftX / pixelRatio;
+    const double sy = shiftY / pixelRatio;
+
+    // the strips, that have been exposed
+
+    QList<QRect> strips;
+
+    if ( shiftX != 0 )
+    {
+        QRectF r( rect );
+        if ( shiftX < 0 )
+            r.setLeft( rect.x() + rect.width() + sx - qwtScrollOverlap );
+        else
+            r.setWidth( sx + qwtScrollOverlap );
+
+        strips += r.toAlignedRect() & rect;
+    }
+
+    if ( shiftY != 0 )
+    {
+        QRectF r( rect );
+        if ( shiftY < 0 )
+            r.setTop( rect.y() + rect.height() + sy - qwtScrollOverlap );
+        else
+            r.setHeight( sy + qwtScrollOverlap );
+
+        strips += r.toAlignedRect() & rect;
+    }
+
+    QPainter painter( bs );
+
+    QRegion exposed;
+
+    for ( int i = 0; i < strips.size(); i++ )
+    {
+        const QRect &r = strips[i];
+
+        QPixmap background = QwtPainter::backingStore( this, r.size() );
+        QwtPainter::fillPixmap( this, background, r.topLeft() );
+
+        painter.drawPixmap( r.topLeft(), background );
+
+        exposed += r;
+    }
+
+    // the items find the strips as clip rectangle
+
+    painter.setClipRegion( exposed );
+    drawCanvas( &painter );
+
+    painter.end();
+
+    /*
+        The content has been shifted by the rounded offsets. Keeping
+        the maps of the content avoids accumulating the rounding errors.
+     */
+
+    for ( int axisId = 0; axisId < QwtPlot::axisCnt; axisId++ )
+    {
+        if ( isUsed[axisId] )
+        {
+            d_data->scrollMaps[axisId] = qwtShiftedMap(
+                d_data->scrollMaps[axisId], qwtIsXAxis( axisId ) ? sx : sy );
+        }
+        else
+        {
+            d_data->scrollMaps[axisId] = maps[axisId];
+        }
+    }
+
+    return true;
+}
+
 /*!
    Calculate the painter path for a styled or rounded border
 
@@ -123,7 +123,42 @@ public:
 
           \sa QwtPlotOpenGLCanvas, QwtPlotGLCanvas
          */
-        OpenGLBuffer = 16
+        OpenGLBuffer = 16,
+
+        /*!
+          \brief Scroll the backing store, when the scales have been translated
+
+          When replot() finds, that the maps of the axes have only been
+          translated since the backing store has been painted, the
+          content of the backing store is shifted by the pixel delta.
+          Only the newly exposed strip is painted by the plot items,
+          that find it as clip rectangle of the painter.
+
+          This mode is intended for strip charts with scrolling time axes,
+          where the cost of a replot is reduced roughly by the ratio
+          between the width of the canvas and the scroll step.
+          For those charts QwtAbstractScaleDraw::PersistentLabels should
+          be enabled for the scrolling axes too, so that their tick labels
+          are not rendered again for each scale division.
+
+          The delta is rounded to device pixels, what might result in
+          an offset of less than half a pixel between the shifted
+          content and the exposed strip.
+
+          \note The content, that has been shifted, is not painted again.
+                So the items must not change their visual appearance
+                beside in the exposed strip - what is f.e. violated by
+                items at fixed canvas positions like QwtPlotTextLabel.
+                invalidateBackingStore() enforces a complete repaint
+                of the following replot().
+
+          \note Scrolling is not available for canvases with rounded
+                borders, styled backgrounds or the OpenGLBuffer mode.
+                It requires BackingStore.
+
+          \sa replot(), QwtPlotCurve::drawSeries()
+         */
+        ScrollBackingStore = 32
     };
 
     //! Paint attributes
@@ -154,6 +189,9 @@ protected:
 private:
     QImage toImageFBO( const QSize &size );
 
+    void updateScrollState();
+    bool scrollBackingStore();
+
     class PrivateData;
     PrivateData *d_data;
 };
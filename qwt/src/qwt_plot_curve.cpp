@@ -9,6 +9,7 @@
 
 #include "qwt_plot_curve.h"
 #include "qwt_point_data.h"
+#include "qwt_pyramid_point_data.h"
 #include "qwt_math.h"
 #include "qwt_clipper.h"
 #include "qwt_painter.h"
@@ -17,11 +18,16 @@
 #include "qwt_spline_curve_fitter.h"
 #include "qwt_symbol.h"
 #include "qwt_point_mapper.h"
+#include "qwt_spatial_index.h"
 #include "qwt_text.h"
 #include "qwt_graphic.h"
+#include "qwt_color_map.h"
+#include "qwt_interval.h"
 
 #include <qpainter.h>
 #include <qpainterpath.h>
+#include <qpaintdevice.h>
+#include <qnumeric.h>
 
 static inline QRectF qwtIntersectedClipRect( const QRectF &rect, QPainter *painter )
 {
@@ -69,6 +75,125 @@ static int qwtVerifyRange( int size, int &i1, int &i2 )
     return ( i2 - i1 + 1 );
 }
 
+/*
+    For series with increasing x coordinates: narrow [from, to] to the samples
+    inside of [x1, x2] - plus one sample on each side, so that the lines
+    to the neighbours outside are not lost.
+ */
+static void qwtCullSortedRange( const QwtSeriesData<QPointF> *series,
+    double x1, double x2, int &from, int &to )
+{
+    // first sample with x >= x1
+
+    int lower = from;
+    int n = to - from + 1;
+
+    while ( n > 0 )
+    {
+        const int half = n >> 1;
+        const int mid = lower + half;
+
+        if ( series->sample( mid ).x() < x1 )
+        {
+            lower = mid + 1;
+            n -= half + 1;
+        }
+        else
+        {
+            n = half;
+        }
+    }
+
+    // first sample with x > x2
+
+    int upper = lower;
+    n = to - lower + 1;
+
+    while ( n > 0 )
+    {
+        const int half = n >> 1;
+        const int mid = upper + half;
+
+        if ( series->sample( mid ).x() <= x2 )
+        {
+            upper = mid + 1;
+            n -= half + 1;
+        }
+        else
+        {
+            n = half;
+        }
+    }
+
+    from = qMax( from, lower - 1 );
+    to = qMin( to, upper );
+}
+
+static inline QwtPointMapper::TransformationFlag qwtAggregationFlag(
+    Qt::Orientation orientation )
+{
+    // a vertical curve is a function of x: y = f( x )
+    return ( orientation == Qt::Vertical )
+        ? QwtPointMapper::AggregateColumns : QwtPointMapper::AggregateRows;
+}
+
+/*
+    Aggregated polylines contain NaN points, that indicate gaps
+    ( see QwtPointMapper::AggregateColumns ). The segments between
+    the gaps are clipped and painted separately.
+ */
+static QVector<QPolygonF> qwtSplitAtGaps( const QPolygonF &polyline )
+{
+    QVector<QPolygonF> segments;
+
+    const QPointF *points = polyline.constData();
+    const int numPoints = polyline.size();
+
+    int from = 0;
+    for ( int i = 0; i <= numPoints; i++ )
+    {
+        if ( i == numPoints
+            || qIsNaN( points[i].x() ) || qIsNaN( points[i].y() ) )
+        {
+            if ( i > from )
+            {
+                if ( from == 0 && i == numPoints )
+                    segments += polyline;
+                else
+                    segments += polyline.mid( from, i - from );
+            }
+
+            from = i + 1;
+        }
+    }
+
+    return segments;
+}
+
+static inline void qwtSetStepPoint( QPointF *points, int ip,
+    double xi, double yi, bool inverted )
+{
+    if ( ip > 0 )
+    {
+        const QPointF &p0 = points[ip - 2];
+        QPointF &p = points[ip - 1];
+
+        if ( inverted )
+        {
+            p.rx() = p0.x();
+            p.ry() = yi;
+        }
+        else
+        {
+            p.rx() = xi;
+            p.ry() = p0.y();
+        }
+    }
+
+    points[ip].rx() = xi;
+    points[ip].ry() = yi;
+}
+
 class QwtPlotCurve::PrivateData
 {
 public:
@@ -76,8 +201,14 @@ public:
         style( QwtPlotCurve::Lines ),
         baseline( 0.0 ),
         symbol( NULL ),
+        densityColorMap( NULL ),
+        densityScaling( QwtPlotCurve::LogarithmicDensity ),
         pen( Qt::black ),
-        paintAttributes( QwtPlotCurve::ClipPolygons | QwtPlotCurve::FilterPoints )
+        paintAttributes( QwtPlotCurve::ClipPolygons | QwtPlotCurve::FilterPoints ),
+        spatialIndexEnabled( false ),
+        spatialIndex( NULL ),
+        spatialIndexRevision( 0 ),
+        reducedSeries( NULL )
     {
         curveFitter = new QwtSplineCurveFitter;
     }
@@ -86,6 +217,8 @@ public:
     {
         delete symbol;
         delete curveFitter;
+        delete densityColorMap;
+        delete spatialIndex;
     }
 
     QwtPlotCurve::CurveStyle style;
@@ -94,6 +227,9 @@ public:
     const QwtSymbol *symbol;
     QwtCurveFitter *curveFitter;
 
+    QwtColorMap *densityColorMap;
+    QwtPlotCurve::DensityScaling densityScaling;
+
     QPen pen;
     QBrush brush;
 
@@ -101,6 +237,13 @@ public:
     QwtPlotCurve::PaintAttributes paintAttributes;
 
     QwtPlotCurve::LegendAttributes legendAttributes;
+
+    bool spatialIndexEnabled;
+    QwtSpatialIndex *spatialIndex; // built on demand
+    uint spatialIndexRevision;
+
+    // series reduced for the paint operation in progress
+    const QwtSeriesData<QPointF> *reducedSeries;
 };
 
 /*!
@@ -376,13 +519,49 @@ const QBrush& QwtPlotCurve::brush() const
   \param to Index of the last point to be painted. If to < 0 the
          curve will be painted to its last point.
 
+  \note When the series is sorted by its x coordinates
+        ( QwtSeriesData::isXSorted() ) the range of samples is narrowed
+        to the samples inside the canvas ( + one neighbour on each side )
+        using a binary search.
+  \note When painting a QwtPyramidPointData with a map, that differs from
+        the map of the canvas - f.e. when rendering to a printer - the
+        series is reduced for this paint operation only
+        ( QwtPyramidPointData::reducedSamples() ).
+
   \sa drawCurve(), drawSymbols(),
 */
 void QwtPlotCurve::drawSeries( QPainter *painter,
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
     const QRectF &canvasRect, int from, int to ) const
 {
-    const size_t numSamples = dataSize();
+    if ( from == 0 && to < 0 && d_data->reducedSeries == NULL )
+    {
+        const QwtPyramidPointData *pyramidData =
+            dynamic_cast< const QwtPyramidPointData * >( data() );
+
+        if ( pyramidData && !pyramidData->isReducedFor( xMap ) )
+        {
+            /*
+                The pixel columns of the reduced series are the ones
+                of the canvas. When rendering to a different paint device
+                the series is reduced for this paint operation only,
+                leaving the series of the canvas unchanged.
+             */
+
+            const QwtPointSeriesData reducedData(
+                pyramidData->reducedSamples( xMap ) );
+
+            d_data->reducedSeries = &reducedData;
+            drawSeries( painter, xMap, yMap, canvasRect, from, to );
+            d_data->reducedSeries = NULL;
+
+            return;
+        }
+    }
+
+    const QwtSeriesData<QPointF> *series = paintSeries();
+
+    const size_t numSamples = series ? series->size() : 0;
 
     if ( !painter || numSamples <= 0 )
         return;
@@ -392,6 +571,32 @@ void QwtPlotCurve::drawSeries( QPainter *painter,
 
     if ( qwtVerifyRange( numSamples, from, to ) > 0 )
     {
+        if ( series->isXSorted() && canvasRect.isValid() )
+        {
+            /*
+                samples outside the canvas might still have
+                visible parts of their symbols or lines. The clip rectangle
+                of the painter is respected, so that only the samples of
+                a strip are painted, when a scrolled canvas gets updated.
+             */
+
+            const QRectF cullRect = qwtIntersectedClipRect( canvasRect, painter );
+
+            double margin = QwtPainter::effectivePenWidth( d_data->pen );
+            if ( d_data->symbol &&
+                ( d_data->symbol->style() != QwtSymbol::NoSymbol ) )
+            {
+                margin += d_data->symbol->boundingRect().width();
+            }
+
+            double x1 = xMap.invTransform( cullRect.left() - margin );
+            double x2 = xMap.invTransform( cullRect.right() + margin );
+            if ( x1 > x2 )
+                qSwap( x1, x2 );
+
+            qwtCullSortedRange( series, x1, x2, from, to );
+        }
+
         painter->save();
         painter->setPen( d_data->pen );
 
@@ -415,6 +620,31 @@ void QwtPlotCurve::drawSeries( QPainter *painter,
     }
 }
 
+/*!
+  \brief Update the item to changes of the axes scale division
+
+  Beside assigning the "rectangle of interest" the map of the x axis
+  is passed to a QwtPyramidPointData, so that it can offer a level of
+  detail according to the pixel columns of the canvas. The plot also
+  calls updateScaleDiv(), when the canvas has been resized.
+
+  \param xScaleDiv Scale division of the x-axis
+  \param yScaleDiv Scale division of the y-axis
+
+  \sa QwtPlotSeriesItem::updateScaleDiv(), QwtPyramidPointData::setXScaleMap()
+*/
+void QwtPlotCurve::updateScaleDiv(
+    const QwtScaleDiv &xScaleDiv, const QwtScaleDiv &yScaleDiv )
+{
+    QwtPyramidPointData *pyramidData =
+        dynamic_cast< QwtPyramidPointData * >( data() );
+
+    if ( pyramidData && plot() )
+        pyramidData->setXScaleMap( plot()->canvasMap( xAxis() ) );
+
+    QwtPlotSeriesItem::updateScaleDiv( xScaleDiv, yScaleDiv );
+}
+
 /*!
   \brief Draw the line part (without symbols) of a curve interval.
   \param painter Painter
@@ -424,7 +654,8 @@ void QwtPlotCurve::drawSeries( QPainter *painter,
   \param canvasRect Contents rectangle of the canvas
   \param from index of the first point to be painted
   \param to index of the last point to be painted
-  \sa draw(), drawDots(), drawLines(), drawSteps(), drawSticks()
+  \sa draw(), drawDots(), drawLines(), drawSteps(), drawSticks(),
+      drawDensity()
 */
 void QwtPlotCurve::drawCurve( QPainter *painter, int style,
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -438,7 +669,7 @@ void QwtPlotCurve::drawCurve( QPainter *painter, int style,
                 // we always need the complete
                 // curve for fitting
                 from = 0;
-                to = dataSize() - 1;
+                to = paintSeries()->size() - 1;
             }
             drawLines( painter, xMap, yMap, canvasRect, from, to );
             break;
@@ -451,6 +682,9 @@ void QwtPlotCurve::drawCurve( QPainter *painter, int style,
         case Dots:
             drawDots( painter, xMap, yMap, canvasRect, from, to );
             break;
+        case Density:
+            drawDensity( painter, xMap, yMap, canvasRect, from, to );
+            break;
         case NoCurve:
         default:
             break;
@@ -507,66 +741,81 @@ void QwtPlotCurve::drawLines( QPainter *painter,
         testPaintAttribute( FilterPoints ) ||
         testPaintAttribute( FilterPointsAggressive ) );
 
+    if ( !doFit && testPaintAttribute( AggregatePoints ) )
+        mapper.setFlag( qwtAggregationFlag( orientation() ) );
+
     mapper.setBoundingRect( canvasRect );
+    mapper.setThreadCount( renderThreadCount() );
 
-    QPolygonF polyline = mapper.toPolygonF( xMap, yMap, data(), from, to );
+    const QPolygonF points = mapper.toPolygonF( xMap, yMap, paintSeries(), from, to );
 
-    if ( doFill )
+    QVector<QPolygonF> segments;
+    if ( mapper.testFlag( qwtAggregationFlag( orientation() ) ) )
+        segments = qwtSplitAtGaps( points );
+    else
+        segments += points;
+
+    for ( int i = 0; i < segments.size(); i++ )
     {
-        if ( doFit )
+        QPolygonF polyline = segments[i];
+
+        if ( doFill )
         {
-            // it might be better to extend and draw the curvePath, but for
-            // the moment we keep an implementation, where we translate the
-            // path back to a polyline.
+            if ( doFit )
+            {
+                // it might be better to extend and draw the curvePath, but for
+                // the moment we keep an implementation, where we translate the
+                // path back to a polyline.
 
-            polyline = d_data->curveFitter->fitCurve( polyline );
-        }
+                polyline = d_data->curveFitter->fitCurve( polyline );
+            }
 
-        if ( painter->pen().style() != Qt::NoPen )
-        {
-            // here we are wasting memory for the filled copy,
-            // do polygon clipping twice etc .. TODO
+            if ( painter->pen().style() != Qt::NoPen )
+            {
+                // here we are wasting memory for the filled copy,
+                // do polygon clipping twice etc .. TODO
 
-            QPolygonF filled = polyline;
-            fillCurve( painter, xMap, yMap, canvasRect, filled );
-            filled.clear();
+                QPolygonF filled = polyline;
+                fillCurve( painter, xMap, yMap, canvasRect, filled );
+                filled.clear();
 
-            if ( d_data->paintAttributes & ClipPolygons )
-                QwtClipper::clipPolygonF( clipRect, polyline, false );
+                if ( d_data->paintAttributes & ClipPolygons )
+                    QwtClipper::clipPolygonF( clipRect, polyline, false );
 
-            QwtPainter::drawPolyline( painter, polyline );
+                QwtPainter::drawPolyline( painter, polyline );
+            }
+            else
+            {
+                fillCurve( painter, xMap, yMap, canvasRect, polyline );
+            }
         }
         else
         {
-            fillCurve( painter, xMap, yMap, canvasRect, polyline );
-        }
-    }
-    else
-    {
-        if ( testPaintAttribute( ClipPolygons ) )
-        {
-            QwtClipper::clipPolygonF( clipRect, polyline, false );
-        }
-
-        if ( doFit )
-        {
-            if ( d_data->curveFitter->mode() == QwtCurveFitter::Path )
+            if ( testPaintAttribute( ClipPolygons ) )
             {
-                const QPainterPath curvePath =
-                    d_data->curveFitter->fitCurvePath( polyline );
+                QwtClipper::clipPolygonF( clipRect, polyline, false );
+            }
 
-                painter->drawPath( curvePath );
+            if ( doFit )
+            {
+                if ( d_data->curveFitter->mode() == QwtCurveFitter::Path )
+                {
+                    const QPainterPath curvePath =
+                        d_data->curveFitter->fitCurvePath( polyline );
+
+                    painter->drawPath( curvePath );
+                }
+                else
+                {
+                    polyline = d_data->curveFitter->fitCurve( polyline );
+                    QwtPainter::drawPolyline( painter, polyline );
+                }
             }
             else
             {
-                polyline = d_data->curveFitter->fitCurve( polyline );
                 QwtPainter::drawPolyline( painter, polyline );
             }
         }
-        else
-        {
-            QwtPainter::drawPolyline( painter, polyline );
-        }
     }
 }
 
@@ -603,7 +852,7 @@ void QwtPlotCurve::drawSticks( QPainter *painter,
 
     const Qt::Orientation o = orientation();
 
-    const QwtSeriesData<QPointF> *series = data();
+    const QwtSeriesData<QPointF> *series = paintSeries();
 
     for ( int i = from; i <= to; i++ )
     {
@@ -670,7 +919,7 @@ void QwtPlotCurve::drawDots( QPainter *painter,
         mapper.setFlag( QwtPointMapper::WeedOutPoints, false );
 
         QPolygonF points = mapper.toPointsF(
-            xMap, yMap, data(), from, to );
+            xMap, yMap, paintSeries(), from, to );
 
         QwtPainter::drawPoints( painter, points );
         fillCurve( painter, xMap, yMap, canvasRect, points );
@@ -678,7 +927,7 @@ void QwtPlotCurve::drawDots( QPainter *painter,
     else if ( d_data->paintAttributes & ImageBuffer )
     {
         const QImage image = mapper.toImage( xMap, yMap,
-            data(), from, to, d_data->pen,
+            paintSeries(), from, to, d_data->pen,
             painter->testRenderHint( QPainter::Antialiasing ),
             renderThreadCount() );
 
@@ -686,7 +935,7 @@ void QwtPlotCurve::drawDots( QPainter *painter,
     }
     else if ( d_data->paintAttributes & MinimizeMemory )
     {
-        const QwtSeriesData<QPointF> *series = data();
+        const QwtSeriesData<QPointF> *series = paintSeries();
 
         for ( int i = from; i <= to; i++ )
         {
@@ -709,20 +958,96 @@ void QwtPlotCurve::drawDots( QPainter *painter,
         if ( doAlign )
         {
             const QPolygon points = mapper.toPoints(
-                xMap, yMap, data(), from, to );
+                xMap, yMap, paintSeries(), from, to );
 
             QwtPainter::drawPoints( painter, points );
         }
         else
         {
             const QPolygonF points = mapper.toPointsF(
-                xMap, yMap, data(), from, to );
+                xMap, yMap, paintSeries(), from, to );
 
             QwtPainter::drawPoints( painter, points );
         }
     }
 }
 
+/*!
+  Draw the density of the points
+
+  The points are counted for each pixel of the canvas in parallel
+  ( see renderThreadCount() ) and the counts are painted as an image,
+  that is colored by the densityColorMap().
+
+  \param painter Painter
+  \param xMap x map
+  \param yMap y map
+  \param canvasRect Contents rectangle of the canvas
+  \param from index of the first point to be painted
+  \param to index of the last point to be painted
+
+  \sa Density, QwtPointMapper::toDensity(), draw(), drawCurve(), drawDots()
+*/
+void QwtPlotCurve::drawDensity( QPainter *painter,
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRectF &canvasRect, int from, int to ) const
+{
+    QwtPointMapper mapper;
+    mapper.setBoundingRect( canvasRect );
+
+    const QVector<quint32> counts = mapper.toDensity(
+        xMap, yMap, paintSeries(), from, to, renderThreadCount() );
+
+    const QRect rect = canvasRect.toAlignedRect();
+    if ( counts.size() != rect.width() * rect.height() )
+        return;
+
+    quint32 maxCount = 0;
+    for ( int i = 0; i < counts.size(); i++ )
+        maxCount = qMax( maxCount, counts[i] );
+
+    if ( maxCount == 0 )
+        return;
+
+    const bool logarithmic = ( d_data->densityScaling == LogarithmicDensity );
+
+    const QwtInterval interval( 0.0, logarithmic
+        ? qLn( 1.0 + maxCount ) : double( maxCount ) );
+
+    const QwtAlphaColorMap defaultColorMap( d_data->pen.color() );
+
+    const QwtColorMap *colorMap = d_data->densityColorMap;
+    if ( colorMap == NULL )
+        colorMap = &defaultColorMap;
+
+    QImage image( rect.size(), QImage::Format_ARGB32 );
+
+    const int w = rect.width();
+    QVector<double> values( w );
+
+    for ( int y = 0; y < rect.height(); y++ )
+    {
+        const quint32 *line = counts.constData() + y * w;
+        QRgb *rgbs = reinterpret_cast< QRgb *>( image.scanLine( y ) );
+
+        for ( int x = 0; x < w; x++ )
+        {
+            values[x] = logarithmic
+                ? qLn( 1.0 + line[x] ) : double( line[x] );
+        }
+
+        colorMap->rgbBatch( interval, values.constData(), rgbs, w );
+
+        for ( int x = 0; x < w; x++ )
+        {
+            if ( line[x] == 0 )
+                rgbs[x] = 0u;
+        }
+    }
+
+    painter->drawImage( rect, image );
+}
+
 /*!
   Draw step function
 
@@ -744,67 +1069,91 @@ void QwtPlotCurve::drawSteps( QPainter *painter,
 {
     const bool doAlign = QwtPainter::roundingAlignment( painter );
 
-    QPolygonF polygon( 2 * ( to - from ) + 1 );
-    QPointF *points = polygon.data();
-
     bool inverted = orientation() == Qt::Vertical;
     if ( d_data->attributes & Inverted )
         inverted = !inverted;
 
-    const QwtSeriesData<QPointF> *series = data();
+    QVector<QPolygonF> polygons;
 
-    int i, ip;
-    for ( i = from, ip = 0; i <= to; i++, ip += 2 )
+    if ( testPaintAttribute( AggregatePoints ) )
     {
-        const QPointF sample = series->sample( i );
-        double xi = xMap.transform( sample.x() );
-        double yi = yMap.transform( sample.y() );
-        if ( doAlign )
-        {
-            xi = qRound( xi );
-            yi = qRound( yi );
-        }
+        QwtPointMapper mapper;
+        mapper.setFlag( QwtPointMapper::RoundPoints, doAlign );
+        mapper.setFlag( qwtAggregationFlag( orientation() ) );
+        mapper.setThreadCount( renderThreadCount() );
 
-        if ( ip > 0 )
+        const QVector<QPolygonF> segments = qwtSplitAtGaps(
+            mapper.toPolygonF( xMap, yMap, paintSeries(), from, to ) );
+
+        for ( int i = 0; i < segments.size(); i++ )
         {
-            const QPointF &p0 = points[ip - 2];
-            QPointF &p = points[ip - 1];
+            const QPolygonF &segment = segments[i];
+
+            QPolygonF polygon( 2 * segment.size() - 1 );
+            QPointF *points = polygon.data();
 
-            if ( inverted )
+            for ( int j = 0; j < segment.size(); j++ )
             {
-                p.rx() = p0.x();
-                p.ry() = yi;
+                qwtSetStepPoint( points, 2 * j,
+                    segment[j].x(), segment[j].y(), inverted );
             }
-            else
+
+            polygons += polygon;
+        }
+    }
+    else
+    {
+        QPolygonF polygon( 2 * ( to - from ) + 1 );
+        QPointF *points = polygon.data();
+
+        const QwtSeriesData<QPointF> *series = paintSeries();
+
+        int i, ip;
+        for ( i = from, ip = 0; i <= to; i++, ip += 2 )
+        {
+            const QPointF sample = series->sample( i );
+            double xi = xMap.transform( sample.x() );
+            double yi = yMap.transform( sample.y() );
+            if ( doAlign )
             {
-                p.rx() = xi;
-                p.ry() = p0.y();
+                xi = qRound( xi );
+                yi = qRound( yi );
             }
+
+            qwtSetStepPoint( points, ip, xi, yi, inverted );
         }
 
-        points[ip].rx() = xi;
-        points[ip].ry() = yi;
+        polygons += polygon;
     }
 
+    QRectF clipRect;
     if ( d_data->paintAttributes & ClipPolygons )
     {
-        QRectF clipRect = qwtIntersectedClipRect( canvasRect, painter );
+        clipRect = qwtIntersectedClipRect( canvasRect, painter );
 
         const qreal pw = QwtPainter::effectivePenWidth( painter->pen() );
         clipRect = clipRect.adjusted(-pw, -pw, pw, pw);
-
-        const QPolygonF clipped = QwtClipper::clippedPolygonF(
-            clipRect, polygon, false );
-
-        QwtPainter::drawPolyline( painter, clipped );
     }
-    else
+
+    for ( int i = 0; i < polygons.size(); i++ )
     {
-        QwtPainter::drawPolyline( painter, polygon );
-    }
+        QPolygonF polygon = polygons[i];
+
+        if ( d_data->paintAttributes & ClipPolygons )
+        {
+            const QPolygonF clipped = QwtClipper::clippedPolygonF(
+                clipRect, polygon, false );
 
-    if ( d_data->brush.style() != Qt::NoBrush )
-        fillCurve( painter, xMap, yMap, canvasRect, polygon );
+            QwtPainter::drawPolyline( painter, clipped );
+        }
+        else
+        {
+            QwtPainter::drawPolyline( painter, polygon );
+        }
+
+        if ( d_data->brush.style() != Qt::NoBrush )
+            fillCurve( painter, xMap, yMap, canvasRect, polygon );
+    }
 }
 
 
@@ -874,6 +1223,66 @@ QwtCurveFitter *QwtPlotCurve::curveFitter() const
     return d_data->curveFitter;
 }
 
+/*!
+  Change the color map for the QwtPlotCurve::Density style
+
+  The counts of the pixels are mapped to colors according to the
+  densityScaling(). Pixels without any point remain transparent.
+  When no color map has been assigned a QwtAlphaColorMap with
+  the color of the pen() is used.
+
+  \param colorMap Color map, that is owned by the curve.
+                  NULL restores the default.
+
+  \sa densityColorMap(), setDensityScaling(), Density
+*/
+void QwtPlotCurve::setDensityColorMap( QwtColorMap *colorMap )
+{
+    if ( colorMap != d_data->densityColorMap )
+    {
+        delete d_data->densityColorMap;
+        d_data->densityColorMap = colorMap;
+
+        itemChanged();
+    }
+}
+
+/*!
+  \return Color map for the QwtPlotCurve::Density style,
+          or NULL, when the default color map is used
+  \sa setDensityColorMap()
+*/
+const QwtColorMap *QwtPlotCurve::densityColorMap() const
+{
+    return d_data->densityColorMap;
+}
+
+/*!
+  Set the mapping of the counts for the QwtPlotCurve::Density style
+
+  \param scaling Linear or logarithmic mapping.
+                 The default setting is LogarithmicDensity.
+
+  \sa densityScaling(), setDensityColorMap()
+*/
+void QwtPlotCurve::setDensityScaling( DensityScaling scaling )
+{
+    if ( scaling != d_data->densityScaling )
+    {
+        d_data->densityScaling = scaling;
+        itemChanged();
+    }
+}
+
+/*!
+  \return Mapping of the counts for the QwtPlotCurve::Density style
+  \sa setDensityScaling()
+*/
+QwtPlotCurve::DensityScaling QwtPlotCurve::densityScaling() const
+{
+    return d_data->densityScaling;
+}
+
 /*!
   Fill the area between the curve and the baseline with
   the curve brush
@@ -989,14 +1398,20 @@ void QwtPlotCurve::drawSymbols( QPainter *painter, const QwtSymbol &symbol,
     const QRectF clipRect = qwtIntersectedClipRect( canvasRect, painter );
     mapper.setBoundingRect( clipRect );
 
-    const int chunkSize = 500;
+    /*
+        When painting to an image QwtSymbol composites the symbols
+        directly into its pixels, what benefits from larger batches
+     */
+    const QPaintDevice *device = painter->device();
+    const int chunkSize = ( device && device->devType() == QInternal::Image )
+        ? 10000 : 500;
 
     for ( int i = from; i <= to; i += chunkSize )
     {
         const int n = qMin( chunkSize, to - i + 1 );
 
         const QPolygonF points = mapper.toPointsF( xMap, yMap,
-            data(), i, i + n - 1 );
+            paintSeries(), i, i + n - 1 );
 
         if ( points.size() > 0 )
             symbol.drawSymbols( painter, points );
@@ -1045,8 +1460,12 @@ double QwtPlotCurve::baseline() const
               the position and the closest curve point
   \return Index of the closest curve point, or -1 if none can be found
           ( f.e when the curve has no points )
-  \note closestPoint() implements a dumb algorithm, that iterates
-        over all points
+  \note Without a spatial index closestPoint() implements a dumb algorithm,
+        that iterates over all points
+  \note For a reduced series ( f.e. QwtPyramidPointData ) the index refers
+        to the reduced series. QwtPyramidPointData::sourceIndex() translates
+        it into the position of the original sample.
+  \sa setSpatialIndexEnabled()
 */
 int QwtPlotCurve::closestPoint( const QPoint &pos, double *dist ) const
 {
@@ -1060,6 +1479,9 @@ int QwtPlotCurve::closestPoint( const QPoint &pos, double *dist ) const
     const QwtScaleMap xMap = plot()->canvasMap( xAxis() );
     const QwtScaleMap yMap = plot()->canvasMap( yAxis() );
 
+    if ( const QwtSpatialIndex *index = spatialIndex() )
+        return index->closestPoint( xMap, yMap, pos, dist );
+
     int index = -1;
     double dmin = 1.0e10;
 
@@ -1083,6 +1505,136 @@ int QwtPlotCurve::closestPoint( const QPoint &pos, double *dist ) const
     return index;
 }
 
+/*!
+  Find the curve points inside of a rectangle
+
+  \param rect Rectangle in plot coordinates
+  \return Indices of the curve points inside of the rectangle
+          in increasing order
+
+  \note Without a spatial index sampleIndices() iterates over all points
+  \sa setSpatialIndexEnabled(), closestPoint(), QwtPlotPicker
+*/
+QVector<int> QwtPlotCurve::sampleIndices( const QRectF &rect ) const
+{
+    if ( const QwtSpatialIndex *index = spatialIndex() )
+        return index->indices( rect );
+
+    const QRectF r = rect.normalized();
+
+    QVector<int> indices;
+
+    const QwtSeriesData<QPointF> *series = data();
+
+    const int numSamples = static_cast<int>( dataSize() );
+    for ( int i = 0; i < numSamples; i++ )
+    {
+        const QPointF sample = series->sample( i );
+
+        if ( sample.x() >= r.left() && sample.x() <= r.right()
+            && sample.y() >= r.top() && sample.y() <= r.bottom() )
+        {
+            indices += i;
+        }
+    }
+
+    return indices;
+}
+
+/*!
+  \brief Enable/Disable a spatial index for the samples
+
+  The spatial index is a k-d tree, that speeds up closestPoint()
+  and sampleIndices() for huge series - f.e. when tracking the mouse
+  with a QwtPlotPicker. It is built with the first request and
+  rebuilt after the samples have been changed.
+
+  The index is disabled by default, as it has a memory footprint of
+  about 2 times the size of the samples.
+
+  \param on Enabled, when true
+  \sa isSpatialIndexEnabled(), QwtSpatialIndex
+
+  \note The index is rebuilt, when the revision of the series
+        ( see QwtSeriesData::revision() ) has changed. When modifying
+        the samples of a series, that does not increment its revision,
+        dataChanged() needs to be called.
+*/
+void QwtPlotCurve::setSpatialIndexEnabled( bool on )
+{
+    if ( on != d_data->spatialIndexEnabled )
+    {
+        d_data->spatialIndexEnabled = on;
+
+        delete d_data->spatialIndex;
+        d_data->spatialIndex = NULL;
+    }
+}
+
+/*!
+  \return True, when the spatial index is enabled
+  \sa setSpatialIndexEnabled()
+*/
+bool QwtPlotCurve::isSpatialIndexEnabled() const
+{
+    return d_data->spatialIndexEnabled;
+}
+
+/*
+    The series to be painted: usually the stored series, but
+    a series, that has been reduced for the paint operation in progress,
+    when rendering to a different paint device.
+ */
+const QwtSeriesData<QPointF> *QwtPlotCurve::paintSeries() const
+{
+    if ( d_data->reducedSeries )
+        return d_data->reducedSeries;
+
+    return data();
+}
+
+const QwtSpatialIndex *QwtPlotCurve::spatialIndex() const
+{
+    const QwtSeriesData<QPointF> *series = data();
+    if ( !d_data->spatialIndexEnabled || series == NULL )
+        return NULL;
+
+    QwtSpatialIndex *&index = d_data->spatialIndex;
+
+    /*
+        Samples might have been modified in place - f.e. by a ring buffer
+        or a different level of detail - without calling dataChanged().
+     */
+    if ( index && d_data->spatialIndexRevision != series->revision() )
+    {
+        delete index;
+        index = NULL;
+    }
+
+    if ( index == NULL )
+    {
+        index = new QwtSpatialIndex();
+        index->build( series );
+
+        d_data->spatialIndexRevision = series->revision();
+    }
+
+    return index;
+}
+
+/*!
+  \brief Invalidate the spatial index, before calling
+         QwtPlotSeriesItem::dataChanged()
+  \sa setSpatialIndexEnabled()
+*/
+void QwtPlotCurve::dataChanged()
+{
+    delete d_data->spatialIndex;
+    d_data->spatialIndex = NULL;
+
+    QwtPlotSeriesItem::dataChanged();
+}
+
 /*!
    \return Icon representing the curve on the legend
 
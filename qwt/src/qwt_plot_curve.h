@@ -18,6 +18,8 @@
 class QwtScaleMap;
 class QwtSymbol;
 class QwtCurveFitter;
+class QwtSpatialIndex;
+class QwtColorMap;
 template <typename T> class QwtSeriesData;
 class QwtText;
 class QPainter;
@@ -96,6 +98,16 @@ public:
         */
         Dots,
 
+        /*!
+           Count the points, that are mapped to each pixel, and paint
+           the counts as an image using the densityColorMap().
+           Intended for scatter plots with a huge amount of points,
+           where overlapping dots would hide the distribution.
+
+           \sa setDensityScaling(), QwtPointMapper::toDensity()
+        */
+        Density,
+
         /*!
            Styles >= QwtPlotCurve::UserCurve are reserved for derived
            classes of QwtPlotCurve that overload drawCurve() with
@@ -230,11 +242,44 @@ public:
                 worked around by enabling the QwtPainter::polylineSplitting() mode.
          */
         FilterPointsAggressive = 0x10,
+
+        /*!
+          M4 aggregation of huge series: each chunk of consecutive samples
+          mapped to the same pixel column ( or pixel row for
+          orientation() == Qt::Horizontal ) is reduced to its first, minimum,
+          maximum and last sample. In opposite to FilterPointsAggressive
+          the result is pixel exact for lines.
+
+          Samples with NaN coordinates separate the chunks.
+
+          \note Implemented for QwtPlotCurve::Lines and QwtPlotCurve::Steps.
+                Ignored for fitted curves.
+          \sa QwtPointMapper::AggregateColumns
+         */
+        AggregatePoints = 0x20
     };
 
     //! Paint attributes
     typedef QFlags<PaintAttribute> PaintAttributes;
 
+    /*!
+        Mapping of the point counts to the color map
+        for QwtPlotCurve::Density
+
+        \sa setDensityScaling(), setDensityColorMap()
+     */
+    enum DensityScaling
+    {
+        //! Counts are mapped linearly from [0, max]
+        LinearDensity,
+
+        /*!
+          log( 1 + count ) is mapped from [0, log( 1 + max )],
+          so that sparse regions remain visible next to dense clusters
+         */
+        LogarithmicDensity
+    };
+
     explicit QwtPlotCurve( const QString &title = QString() );
     explicit QwtPlotCurve( const QwtText &title );
 
@@ -273,6 +318,10 @@ public:
     void setSamples( QwtSeriesData<QPointF> * );
 
     virtual int closestPoint( const QPoint &pos, double *dist = NULL ) const;
+    QVector<int> sampleIndices( const QRectF & ) const;
+
+    void setSpatialIndexEnabled( bool );
+    bool isSpatialIndexEnabled() const;
 
     double minXValue() const;
     double maxXValue() const;
@@ -301,12 +350,21 @@ public:
     void setCurveFitter( QwtCurveFitter * );
     QwtCurveFitter *curveFitter() const;
 
+    void setDensityColorMap( QwtColorMap * );
+    const QwtColorMap *densityColorMap() const;
+
+    void setDensityScaling( DensityScaling );
+    DensityScaling densityScaling() const;
+
     virtual void drawSeries( QPainter *,
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QRectF &canvasRect, int from, int to ) const QWT_OVERRIDE;
 
     virtual QwtGraphic legendIcon( int index, const QSizeF & ) const QWT_OVERRIDE;
 
+    virtual void updateScaleDiv(
+        const QwtScaleDiv &, const QwtScaleDiv & ) QWT_OVERRIDE;
+
 protected:
 
     void init();
@@ -335,6 +393,10 @@ protected:
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QRectF &canvasRect, int from, int to ) const;
 
+    virtual void drawDensity( QPainter *,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QRectF &canvasRect, int from, int to ) const;
+
     virtual void fillCurve( QPainter *,
         const QwtScaleMap &, const QwtScaleMap &,
         const QRectF &canvasRect, QPolygonF & ) const;
@@ -342,7 +404,12 @@ protected:
     void closePolyline( QPainter *,
         const QwtScaleMap &, const QwtScaleMap &, QPolygonF & ) const;
 
+    virtual void dataChanged() QWT_OVERRIDE;
+
 private:
+    const QwtSpatialIndex *spatialIndex() const;
+    const QwtSeriesData<QPointF> *paintSeries() const;
+
     class PrivateData;
     PrivateData *d_data;
 };
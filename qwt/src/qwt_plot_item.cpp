@@ -23,6 +23,7 @@ public:
         plot( NULL ),
         isVisible( true ),
         renderThreadCount( 1 ),
+        cacheLayer( -1 ),
         z( 0.0 ),
         xAxis( QwtPlot::xBottom ),
         yAxis( QwtPlot::yLeft ),
@@ -39,6 +40,7 @@ public:
 
     QwtPlotItem::RenderHints renderHints;
     uint renderThreadCount;
+    int cacheLayer;
 
     double z;
 
@@ -339,6 +341,8 @@ bool QwtPlotItem::testRenderHint( RenderHint hint ) const
    ( f.e QwtPlotRasterItem ) can be done in parallel in
    several threads.
 
+   The threads are taken from the pool of QwtRenderScheduler.
+
    The default setting is set to 1.
 
    \param numThreads Number of threads to be used for rendering.
@@ -362,6 +366,54 @@ uint QwtPlotItem::renderThreadCount() const
     return d_data->renderThreadCount;
 }
 
+/*!
+   \brief Assign the item to a cache layer
+
+   Items with a cache layer >= 0 are rendered into an offscreen image,
+   that is reused when repainting the canvas until the item has changed
+   or the geometry/scales of the canvas have been modified.
+   Items, that are adjacent in z order and have the same
+   cache layer, share the same image.
+
+   The typical use case is a plot with a couple of expensive static items
+   ( grid, huge reference curves, spectrograms ) below some fast
+   changing curves: the static items can be put into a cache layer,
+   so that a replot only renders the items, that have changed.
+
+   The default setting is -1 ( = no caching ).
+
+   \param layer Cache layer, a negative value disables caching
+
+   \note Changes of an item, that are not propagated by itemChanged()
+         ( f.e. modifying the buffers of QwtPlotCurve::setRawSamples() )
+         need to be followed by itemChanged() or
+         QwtPlot::invalidateCacheLayer().
+
+   \sa cacheLayer(), QwtPlot::invalidateCacheLayer(), QwtPlot::drawCanvas()
+*/
+void QwtPlotItem::setCacheLayer( int layer )
+{
+    layer = qMax( layer, -1 );
+
+    if ( d_data->cacheLayer != layer )
+    {
+        if ( d_data->plot && d_data->cacheLayer >= 0 )
+            d_data->plot->invalidateCacheLayer( d_data->cacheLayer );
+
+        d_data->cacheLayer = layer;
+        itemChanged();
+    }
+}
+
+/*!
+   \return Cache layer of the item
+   \sa setCacheLayer()
+*/
+int QwtPlotItem::cacheLayer() const
+{
+    return d_data->cacheLayer;
+}
+
 /*!
    Set the size of the legend icon
 
@@ -474,14 +526,20 @@ bool QwtPlotItem::isVisible() const
 
 /*!
    Update the legend and call QwtPlot::autoRefresh() for the
-   parent plot.
+   parent plot. When the item is assigned to a cache layer
+   the layer is invalidated before.
 
-   \sa QwtPlot::legendChanged(), QwtPlot::autoRefresh()
+   \sa QwtPlot::legendChanged(), QwtPlot::autoRefresh(), setCacheLayer()
 */
 void QwtPlotItem::itemChanged()
 {
     if ( d_data->plot )
+    {
+        if ( d_data->cacheLayer >= 0 )
+            d_data->plot->invalidateCacheLayer( d_data->cacheLayer );
+
         d_data->plot->autoRefresh();
+    }
 }
 
 /*!
@@ -239,6 +239,9 @@ public:
     void setRenderThreadCount( uint numThreads );
     uint renderThreadCount() const;
 
+    void setCacheLayer( int layer );
+    int cacheLayer() const;
+
     void setLegendIconSize( const QSize & );
     QSize legendIconSize() const;
 
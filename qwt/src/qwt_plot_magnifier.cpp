@@ -11,6 +11,9 @@
 #include "qwt_scale_map.h"
 #include "qwt_plot_magnifier.h"
 
+#include <qbasictimer.h>
+#include <qcoreevent.h>
+
 class QwtPlotMagnifier::PrivateData
 {
 public:
@@ -21,6 +24,9 @@ public:
     }
 
     bool isAxisEnabled[QwtPlot::axisCnt];
+
+    // resetting the interactive hint of the plot
+    QBasicTimer interactionTimer;
 };
 
 /*!
@@ -160,7 +166,42 @@ void QwtPlotMagnifier::rescale( double factor )
     plt->setAutoReplot( autoReplot );
 
     if ( doReplot )
+    {
+        // more steps are expected to follow
+        plt->setInteractive( true );
+        d_data->interactionTimer.start( 250, this );
+
         plt->replot();
+    }
+}
+
+/*!
+   \brief Reset the interactive hint of the plot
+
+   When there was no rescaling for a short period the interaction
+   is considered to be finished and the plot is replotted
+   without the interactive hint.
+
+   \param event Timer event
+   \sa QwtPlot::setInteractive()
+*/
+void QwtPlotMagnifier::timerEvent( QTimerEvent *event )
+{
+    if ( event->timerId() == d_data->interactionTimer.timerId() )
+    {
+        d_data->interactionTimer.stop();
+
+        QwtPlot* plt = plot();
+        if ( plt && plt->isInteractive() )
+        {
+            plt->setInteractive( false );
+            plt->replot();
+        }
+
+        return;
+    }
+
+    QwtMagnifier::timerEvent( event );
 }
 
 #if QWT_MOC_INCLUDE
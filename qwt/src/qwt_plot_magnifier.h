@@ -14,6 +14,7 @@
 #include "qwt_magnifier.h"
 
 class QwtPlot;
+class QTimerEvent;
 
 /*!
   \brief QwtPlotMagnifier provides zooming, by magnifying in steps.
@@ -46,6 +47,9 @@ public:
 public Q_SLOTS:
     virtual void rescale( double factor ) QWT_OVERRIDE;
 
+protected:
+    virtual void timerEvent( QTimerEvent * ) QWT_OVERRIDE;
+
 private:
     class PrivateData;
     PrivateData *d_data;
@@ -13,14 +13,210 @@
 #include "qwt_text.h"
 #include "qwt_interval.h"
 #include "qwt_math.h"
+#include "qwt_plot.h"
+#include "qwt_render_scheduler.h"
 
 #include <qpainter.h>
 #include <qpaintengine.h>
-#include <qthread.h>
 #include <qfuture.h>
 #include <qtconcurrentrun.h>
+#include <qmutex.h>
+#include <qpointer.h>
+#include <qatomic.h>
+#include <qsharedpointer.h>
+#include <qcoreapplication.h>
+#include <qcoreevent.h>
 
 #include <limits>
+#include <cstring>
+
+#if !defined(QT_NO_QFUTURE)
+
+namespace
+{
+    /*
+        Updates of the canvas for completed strips of the refinement
+        are posted from the background thread to the notifier, that lives
+        in the GUI thread. They are coalesced into one replot for
+        each interval, so that the other items on the canvas are
+        not repainted for each strip.
+     */
+    class QwtRefinementNotifier: public QObject
+    {
+    public:
+        QwtRefinementNotifier():
+            cacheLayer( -1 ),
+            d_timerId( 0 ),
+            d_isPosted( 0 )
+        {
+        }
+
+        // called from the background thread
+        void requestUpdate()
+        {
+            if ( d_isPosted.testAndSetOrdered( 0, 1 ) )
+                QCoreApplication::postEvent( this, new QEvent( QEvent::User ) );
+        }
+
+        // the plot and layer to update, accessed from the GUI thread only
+        QPointer<QwtPlot> plot;
+        int cacheLayer;
+
+    protected:
+        virtual bool event( QEvent *event ) QWT_OVERRIDE
+        {
+            if ( event->type() == QEvent::User )
+            {
+                d_isPosted.fetchAndStoreOrdered( 0 );
+
+                if ( d_timerId == 0 )
+                    d_timerId = startTimer( 50 );
+
+                return true;
+            }
+
+            return QObject::event( event );
+        }
+
+        virtual void timerEvent( QTimerEvent *event ) QWT_OVERRIDE
+        {
+            if ( event->timerId() != d_timerId )
+            {
+                QObject::timerEvent( event );
+                return;
+            }
+
+            killTimer( d_timerId );
+            d_timerId = 0;
+
+            if ( plot == NULL )
+                return;
+
+            if ( cacheLayer >= 0 )
+                plot->invalidateCacheLayer( cacheLayer );
+
+            const bool ok = QMetaObject::invokeMethod(
+                plot->canvas(), "replot", Qt::DirectConnection );
+            if ( !ok )
+                plot->replot();
+        }
+
+    private:
+        int d_timerId;
+        QAtomicInt d_isPosted;
+    };
+
+    /*
+        The image, that is refined in a background thread. All members
+        are modified from the GUI thread only, when no job is running.
+        Otherwise image and isComplete are protected by the mutex.
+
+        The job renders from a snapshot of the item ( renderer ) and
+        never calls the item itself. The tiles of the refinement are
+        scheduled with a low priority and the token abandons them,
+        when the image is not needed anymore.
+     */
+    class QwtRefinement
+    {
+    public:
+        QwtRefinement():
+            isComplete( false ),
+            notifier( NULL )
+        {
+        }
+
+        QMutex mutex;
+        QFuture<void> future;
+
+        QRectF area;
+        QSizeF size;
+        QImage image;
+
+        bool isComplete;
+        QwtRenderToken token;
+
+        // the snapshot and the geometry of the image in full resolution
+        QSharedPointer< const QwtRasterImageRenderer > renderer;
+        QwtScaleMap xMap;
+        QwtScaleMap yMap;
+        QSize imageSize;
+
+        // created in the GUI thread, when starting the first refinement
+        QwtRefinementNotifier *notifier;
+    };
+}
+
+/*
+   Render the image in full resolution, strip by strip. The strips
+   are copied into the coarse image, that is displayed in the meantime.
+   This function is running in a background thread.
+ */
+static void qwtRefineImage( QwtRefinement *refinement )
+{
+    const QwtRenderScheduler::Scope scope(
+        refinement->token, QwtRenderScheduler::LowPriority );
+
+    const QwtScaleMap &xMap = refinement->xMap;
+    const QwtScaleMap &yMap = refinement->yMap;
+    const QRectF &area = refinement->area;
+    const QSize &imageSize = refinement->imageSize;
+
+    const int numStrips = qMin( imageSize.height(), 16 );
+    const int stripHeight = imageSize.height() / numStrips;
+
+    for ( int i = 0; i < numStrips; i++ )
+    {
+        const int y0 = i * stripHeight;
+        const int y1 = ( i == numStrips - 1 ) ? imageSize.height() : y0 + stripHeight;
+
+        // the rows of the strip are mapped like in the complete image
+
+        QwtScaleMap yyMap = yMap;
+        yyMap.setPaintInterval( yMap.p1() - y0, yMap.p2() - y0 );
+
+        const double v1 = yMap.invTransform( y0 );
+        const double v2 = yMap.invTransform( y1 );
+
+        QRectF stripArea = area;
+        stripArea.setTop( qMax( qMin( v1, v2 ), area.top() ) );
+        stripArea.setBottom( qMin( qMax( v1, v2 ), area.bottom() ) );
+
+        if ( refinement->token.isCancelled() )
+            return;
+
+        const QImage strip = refinement->renderer->renderImage( xMap, yyMap,
+            stripArea, QSize( imageSize.width(), y1 - y0 ) );
+
+        {
+            QMutexLocker locker( &refinement->mutex );
+
+            QImage &image = refinement->image;
+
+            if ( refinement->token.isCancelled() || strip.isNull()
+                || strip.format() != image.format()
+                || strip.width() != image.width() )
+            {
+                return;
+            }
+
+            const int numBytes = qMin( strip.bytesPerLine(), image.bytesPerLine() );
+            for ( int y = y0; y < y1; y++ )
+                memcpy( image.scanLine( y ), strip.constScanLine( y - y0 ), numBytes );
+
+            if ( i == numStrips - 1 )
+                refinement->isComplete = true;
+        }
+
+        refinement->notifier->requestUpdate();
+    }
+}
+
+#endif
+
+//! Destructor
+QwtRasterImageRenderer::~QwtRasterImageRenderer()
+{
+}
 
 class QwtPlotRasterItem::PrivateData
 {
@@ -32,6 +228,13 @@ public:
         cache.policy = QwtPlotRasterItem::NoCache;
     }
 
+    ~PrivateData()
+    {
+#if !defined(QT_NO_QFUTURE)
+        delete refinement.notifier;
+#endif
+    }
+
     int alpha;
 
     QwtPlotRasterItem::PaintAttributes paintAttributes;
@@ -42,7 +245,34 @@ public:
         QRectF area;
         QSizeF size;
         QImage image;
+
+        // maps of the image, needed for scrolling
+        QwtScaleMap xMap;
+        QwtScaleMap yMap;
     } cache;
+
+#if !defined(QT_NO_QFUTURE)
+    QwtRefinement refinement;
+#endif
+
+    void cancelRefinement()
+    {
+#if !defined(QT_NO_QFUTURE)
+        refinement.token.cancel();
+        refinement.future.waitForFinished();
+        refinement.future = QFuture<void>();
+
+        refinement.area = QRectF();
+        refinement.size = QSizeF();
+        refinement.image = QImage();
+        refinement.isComplete = false;
+        refinement.token = QwtRenderToken();
+        refinement.renderer.clear();
+
+        if ( refinement.notifier )
+            refinement.notifier->plot = NULL;
+#endif
+    }
 };
 
 
@@ -365,7 +595,7 @@ static bool qwtUseCache( QwtPlotRasterItem::CachePolicy policy,
 {
     bool doCache = false;
 
-    if ( policy == QwtPlotRasterItem::PaintCache )
+    if ( policy != QwtPlotRasterItem::NoCache )
     {
         // Caching doesn't make sense, when the item is
         // not painted to screen
@@ -388,6 +618,30 @@ static bool qwtUseCache( QwtPlotRasterItem::CachePolicy policy,
     return doCache;
 }
 
+static bool qwtUseProgressive( bool on, const QPainter *painter )
+{
+    if ( !on )
+        return false;
+
+    /*
+        Only when painting to screen an incomplete image
+        can be replaced later. F.e. when recording a QwtGraphic
+        the image needs to be complete.
+     */
+
+    switch ( painter->paintEngine()->type() )
+    {
+        case QPaintEngine::Raster:
+        case QPaintEngine::OpenGL:
+        case QPaintEngine::OpenGL2:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static const int qwtAlphaStripHeight = 64;
+
 static void qwtToRgba( const QImage* from, QImage* to,
     const QRect& tile, int alpha )
 {
@@ -430,6 +684,41 @@ static void qwtToRgba( const QImage* from, QImage* to,
     }
 }
 
+namespace
+{
+    // converting an image to ARGB32 with an alpha value, strip by strip
+    class QwtAlphaJob: public QwtRenderJob
+    {
+    public:
+        QwtAlphaJob( const QImage *from, QImage *to, int alpha ):
+            d_from( from ),
+            d_to( to ),
+            d_alpha( alpha )
+        {
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return ( d_from->height() + qwtAlphaStripHeight - 1 ) / qwtAlphaStripHeight;
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            const int y = index * qwtAlphaStripHeight;
+
+            const QRect strip( 0, y, d_from->width(),
+                qMin( qwtAlphaStripHeight, d_from->height() - y ) );
+
+            qwtToRgba( d_from, d_to, strip, d_alpha );
+        }
+
+    private:
+        const QImage *d_from;
+        QImage *d_to;
+        const int d_alpha;
+    };
+}
+
 //! Constructor
 QwtPlotRasterItem::QwtPlotRasterItem( const QString& title ):
     QwtPlotItem( QwtText( title ) )
@@ -444,9 +733,17 @@ QwtPlotRasterItem::QwtPlotRasterItem( const QwtText& title ):
     init();
 }
 
-//! Destructor
+/*!
+  \brief Destructor
+
+  A refinement in the background ( ProgressiveRendering ) is cancelled.
+  As it renders from a snapshot ( imageRenderer() ), that does not refer
+  to the item, it doesn't matter, that the destructors of derived
+  classes have been called before.
+ */
 QwtPlotRasterItem::~QwtPlotRasterItem()
 {
+    d_data->cancelRefinement();
     delete d_data;
 }
 
@@ -561,12 +858,56 @@ QwtPlotRasterItem::CachePolicy QwtPlotRasterItem::cachePolicy() const
     return d_data->cache.policy;
 }
 
+/*!
+   \brief Stop rendering in background threads
+
+   Cancels the refinement of an image ( see ProgressiveRendering )
+   and waits until the snapshot, that is rendering in the background
+   thread, has returned.
+
+   It needs to be called before modifying anything, that is shared
+   with the snapshot ( imageRenderer() ) in a way, that is not thread safe.
+
+   \sa ProgressiveRendering, invalidateCache()
+*/
+void QwtPlotRasterItem::cancelRendering()
+{
+    d_data->cancelRefinement();
+}
+
+/*!
+   \brief Create a snapshot for rendering in a background thread
+
+   The refinement of an image ( ProgressiveRendering ) renders
+   from the snapshot in a background thread. It never calls
+   renderImage(), so that the item can be deleted, or the
+   snapshot can be rendered in parallel to the item.
+
+   A class, that reimplements renderImage() of a base class with a
+   snapshot, has to reimplement imageRenderer() as well - f.e.
+   returning NULL, what disables the refinement in the background.
+
+   The default implementation returns NULL.
+
+   \return Snapshot, that is owned and deleted by the caller,
+           or NULL, when the item doesn't support rendering in
+           a background thread.
+
+   \sa ProgressiveRendering, QwtPlotSpectrogram::imageRenderer()
+*/
+QwtRasterImageRenderer *QwtPlotRasterItem::imageRenderer() const
+{
+    return NULL;
+}
+
 /*!
    Invalidate the paint cache
    \sa setCachePolicy()
 */
 void QwtPlotRasterItem::invalidateCache()
 {
+    d_data->cancelRefinement();
+
     d_data->cache.image = QImage();
     d_data->cache.area = QRect();
     d_data->cache.size = QSize();
@@ -619,6 +960,8 @@ void QwtPlotRasterItem::draw( QPainter *painter,
         return;
 
     const bool doCache = qwtUseCache( d_data->cache.policy, painter );
+    const bool doProgressive = qwtUseProgressive(
+        testPaintAttribute( ProgressiveRendering ), painter );
 
     const QwtInterval xInterval = interval( Qt::XAxis );
     const QwtInterval yInterval = interval( Qt::YAxis );
@@ -694,7 +1037,7 @@ void QwtPlotRasterItem::draw( QPainter *painter,
         // data pixels we render in resolution of the paint device.
 
         image = compose(xxMap, yyMap,
-            area, paintRect, paintRect.size().toSize(), doCache);
+            area, paintRect, paintRect.size().toSize(), doCache, doProgressive );
         if ( image.isNull() )
             return;
 
@@ -739,7 +1082,7 @@ void QwtPlotRasterItem::draw( QPainter *painter,
         imageSize.setHeight( qRound( imageArea.height() / pixelRect.height() ) );
 
         image = compose(xxMap, yyMap,
-            imageArea, paintRect, imageSize, doCache );
+            imageArea, paintRect, imageSize, doCache, doProgressive );
 
         if ( image.isNull() )
             return;
@@ -827,7 +1170,7 @@ QRectF QwtPlotRasterItem::boundingRect() const
 QImage QwtPlotRasterItem::compose(
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
     const QRectF &imageArea, const QRectF &paintRect,
-    const QSize &imageSize, bool doCache) const
+    const QSize &imageSize, bool doCache, bool doProgressive ) const
 {
     QImage image;
     if ( imageArea.isEmpty() || paintRect.isEmpty() || imageSize.isEmpty() )
@@ -859,13 +1202,130 @@ QImage QwtPlotRasterItem::compose(
         const QwtScaleMap yyMap =
             imageMap(Qt::Vertical, yMap, imageArea, imageSize, dy);
 
-        image = renderImage( xxMap, yyMap, imageArea, imageSize );
+        bool isComplete = true;
+
+#if !defined(QT_NO_QFUTURE)
+        QwtRefinement &refinement = d_data->refinement;
+
+        const bool isRefining = doProgressive && refinement.area == imageArea
+            && refinement.size == paintRect.size();
+#else
+        const bool isRefining = false;
+#endif
+
+        if ( doCache && d_data->cache.policy == ScrollingCache
+            && d_data->cache.size == paintRect.size() && !isRefining )
+        {
+            /*
+                scrollImage renders the uncovered rows and columns,
+                but the snapshot of a refinement shares the data with
+                the item. So a refinement of a previous area has to be
+                stopped first.
+             */
+            d_data->cancelRefinement();
+
+            image = scrollImage( xxMap, yyMap, imageArea, imageSize );
+        }
+
+#if !defined(QT_NO_QFUTURE)
+
+        if ( image.isNull() && isRefining )
+        {
+            // the image from the background thread, maybe incomplete
+
+            QMutexLocker locker( &refinement.mutex );
+
+            image = refinement.image;
+            isComplete = refinement.isComplete;
+        }
+#endif
+
+        if ( image.isNull() )
+        {
+            // the data is not rendered concurrently with the snapshot
+            d_data->cancelRefinement();
+
+            const bool isInteractive = plot() && plot()->isInteractive();
+
+            bool coarse = doProgressive &&
+                imageSize.width() * imageSize.height() >= 128 * 128;
+
+#if defined(QT_NO_QFUTURE)
+            // without refining in the background only for interactions
+            coarse = coarse && isInteractive;
+#else
+            QSharedPointer< const QwtRasterImageRenderer > renderer;
+            if ( coarse && !isInteractive )
+            {
+                // without a snapshot the image can't be refined in the background
+                renderer = QSharedPointer< const QwtRasterImageRenderer >(
+                    imageRenderer() );
+
+                coarse = !renderer.isNull();
+            }
+#endif
+            if ( coarse )
+            {
+                const QSize coarseSize( qMax( imageSize.width() / 4, 1 ),
+                    qMax( imageSize.height() / 4, 1 ) );
+
+                // sampling at the centers of the coarse pixels
+
+                const QwtScaleMap cxMap = imageMap( Qt::Horizontal, xMap,
+                    imageArea, coarseSize, imageArea.width() / coarseSize.width() );
+
+                const QwtScaleMap cyMap = imageMap( Qt::Vertical, yMap,
+                    imageArea, coarseSize, imageArea.height() / coarseSize.height() );
+
+                image = renderImage( cxMap, cyMap, imageArea, coarseSize );
+                if ( !image.isNull() )
+                {
+                    image = image.scaled( imageSize,
+                        Qt::IgnoreAspectRatio, Qt::FastTransformation );
+                }
+
+                isComplete = false;
 
-        if ( doCache )
+#if !defined(QT_NO_QFUTURE)
+                if ( renderer && !image.isNull() )
+                {
+                    refinement.area = imageArea;
+                    refinement.size = paintRect.size();
+                    refinement.image = image;
+
+                    refinement.renderer = renderer;
+                    refinement.xMap = xxMap;
+                    refinement.yMap = yyMap;
+                    refinement.imageSize = imageSize;
+
+                    if ( refinement.notifier == NULL )
+                        refinement.notifier = new QwtRefinementNotifier();
+
+                    refinement.notifier->plot = plot();
+                    refinement.notifier->cacheLayer = cacheLayer();
+
+#if QT_VERSION >= 0x050400
+                    refinement.future = QtConcurrent::run(
+                        QwtRenderScheduler::threadPool(), &qwtRefineImage, &refinement );
+#else
+                    refinement.future = QtConcurrent::run( &qwtRefineImage, &refinement );
+#endif
+                }
+#endif
+            }
+            else
+            {
+                image = renderImage( xxMap, yyMap, imageArea, imageSize );
+            }
+        }
+
+        if ( doCache && isComplete )
         {
             d_data->cache.area = imageArea;
             d_data->cache.size = paintRect.size();
             d_data->cache.image = image;
+            d_data->cache.xMap = xxMap;
+            d_data->cache.yMap = yyMap;
         }
     }
 
@@ -873,41 +1333,121 @@ QImage QwtPlotRasterItem::compose(
     {
         QImage alphaImage( image.size(), QImage::Format_ARGB32 );
 
-#if !defined(QT_NO_QFUTURE)
-        uint numThreads = renderThreadCount();
+        QwtAlphaJob job( &image, &alphaImage, d_data->alpha );
+        QwtRenderScheduler::run( job, renderThreadCount() );
+
+        image = alphaImage;
+    }
+
+    return image;
+}
+
+/*
+   Find the position of the first pixel of an image in the cached image.
+   The pixels of both images need to have the same sample positions
+   what is the case, when the offset is integral.
+ */
+static bool qwtScrollOffset( const QwtScaleMap &map,
+    const QwtScaleMap &cacheMap, int size, int &offset )
+{
+    const double p1 = cacheMap.transform( map.invTransform( 0.0 ) );
+    const double p2 = cacheMap.transform( map.invTransform( size ) );
+
+    offset = qRound( p1 );
+
+    const double eps = 1e-3;
+    return qAbs( p1 - offset ) < eps && qAbs( p2 - p1 - size ) < eps
+        && qAbs( offset ) < size;
+}
+
+/*
+   Scroll the cached image and render the uncovered rows
+   and columns. Returns a null image, when the cached image
+   can't be reused.
+ */
+QImage QwtPlotRasterItem::scrollImage(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRectF &area, const QSize &imageSize ) const
+{
+    const PrivateData::ImageCache &cache = d_data->cache;
+
+    if ( cache.image.size() != imageSize || cache.image.depth() < 8 )
+        return QImage();
+
+    const int w = imageSize.width();
+    const int h = imageSize.height();
+
+    int dx, dy;
+    if ( !qwtScrollOffset( xMap, cache.xMap, w, dx )
+        || !qwtScrollOffset( yMap, cache.yMap, h, dy ) )
+    {
+        return QImage();
+    }
+
+    // pixels outside of the cached image are initialized with 0
+    QImage image = cache.image.copy( dx, dy, w, h );
+
+    // rows and columns, that are not covered by the cached image
+    const int y0 = qMax( -dy, 0 );
+    const int y1 = qMin( h - dy, h );
+    const int x0 = qMax( -dx, 0 );
+    const int x1 = qMin( w - dx, w );
+
+    QVector<QRect> rects;
+    if ( y0 > 0 )
+        rects += QRect( 0, 0, w, y0 );
+    if ( y1 < h )
+        rects += QRect( 0, y1, w, h - y1 );
+    if ( x0 > 0 )
+        rects += QRect( 0, y0, x0, y1 - y0 );
+    if ( x1 < w )
+        rects += QRect( x1, y0, w - x1, y1 - y0 );
+
+    const int bytesPerPixel = image.depth() / 8;
+
+    for ( int i = 0; i < rects.size(); i++ )
+    {
+        const QRect &r = rects[i];
+
+        // the pixels are mapped like in the complete image
+
+        QwtScaleMap xxMap = xMap;
+        xxMap.setPaintInterval( xMap.p1() - r.left(), xMap.p2() - r.left() );
 
-        if ( numThreads <= 0 )
-            numThreads = QThread::idealThreadCount();
+        QwtScaleMap yyMap = yMap;
+        yyMap.setPaintInterval( yMap.p1() - r.top(), yMap.p2() - r.top() );
 
-        if ( numThreads <= 0 )
-            numThreads = 1;
+        const double vx1 = xMap.invTransform( r.left() );
+        const double vx2 = xMap.invTransform( r.right() + 1 );
+        const double vy1 = yMap.invTransform( r.top() );
+        const double vy2 = yMap.invTransform( r.bottom() + 1 );
 
-        const int numRows = image.height() / numThreads;
+        QRectF rectArea;
+        rectArea.setLeft( qMax( qMin( vx1, vx2 ), area.left() ) );
+        rectArea.setRight( qMin( qMax( vx1, vx2 ), area.right() ) );
+        rectArea.setTop( qMax( qMin( vy1, vy2 ), area.top() ) );
+        rectArea.setBottom( qMin( qMax( vy1, vy2 ), area.bottom() ) );
 
-        QVector< QFuture<void> > futures;
-        futures.reserve( numThreads - 1 );
+        const QImage rectImage = renderImage( xxMap, yyMap, rectArea, r.size() );
 
-        for ( uint i = 0; i < numThreads; i++ )
+        if ( rectImage.isNull() || rectImage.format() != image.format()
+            || rectImage.size() != r.size() )
         {
-            QRect tile( 0, i * numRows, image.width(), numRows );
-            if ( i == numThreads - 1 )
-            {
-                tile.setHeight( image.height() - i * numRows );
-                qwtToRgba( &image, &alphaImage, tile, d_data->alpha );
-            }
-            else
-            {
-                futures += QtConcurrent::run(
-                    &qwtToRgba, &image, &alphaImage, tile, d_data->alpha );
-            }
+            return QImage();
+        }
+
+        if ( image.format() == QImage::Format_Indexed8
+            && rectImage.colorTable() != image.colorTable() )
+        {
+            return QImage();
+        }
+
+        const int numBytes = r.width() * bytesPerPixel;
+        for ( int y = 0; y < r.height(); y++ )
+        {
+            memcpy( image.scanLine( r.top() + y ) + r.left() * bytesPerPixel,
+                rectImage.constScanLine( y ), numBytes );
         }
-        for ( int i = 0; i < futures.size(); i++ )
-            futures[i].waitForFinished();
-#else
-        const QRect tile( 0, 0, image.width(), image.height() );
-        qwtToRgba( &image, &alphaImage, tile, d_data->alpha );
-#endif
-        image = alphaImage;
     }
 
     return image;
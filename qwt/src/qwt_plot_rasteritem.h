@@ -17,6 +17,42 @@
 
 class QwtInterval;
 
+/*!
+  \brief A snapshot for rendering the image of a raster item
+
+  The refinement of an image in a background thread
+  ( QwtPlotRasterItem::ProgressiveRendering ) renders from a snapshot,
+  that is returned by QwtPlotRasterItem::imageRenderer(). The snapshot
+  must not refer to the item, but has to share everything it needs -
+  f.e. the raster data and the color map of a QwtPlotSpectrogram. So
+  the item can be deleted or modified, while the refinement is running.
+
+  \sa QwtPlotRasterItem::imageRenderer()
+*/
+class QWT_EXPORT QwtRasterImageRenderer
+{
+public:
+    virtual ~QwtRasterImageRenderer();
+
+    /*!
+      \brief Render an image
+
+      Called from a background thread. Rendering can be abandoned,
+      when QwtRenderScheduler::isCancelled() returns true.
+
+      \param xMap X-Scale Map
+      \param yMap Y-Scale Map
+      \param area Requested area for the image in scale coordinates
+      \param imageSize Requested size of the image
+
+      \return Rendered image
+      \sa QwtPlotRasterItem::renderImage()
+     */
+    virtual QImage renderImage( const QwtScaleMap &xMap,
+        const QwtScaleMap &yMap, const QRectF &area,
+        const QSize &imageSize ) const = 0;
+};
+
 /*!
   \brief A class, which displays raster data
 
@@ -56,7 +92,23 @@ public:
           of hide/show operations or manipulations of the alpha value.
           All other situations are handled by the canvas backing store.
          */
-        PaintCache
+        PaintCache,
+
+        /*!
+          Like PaintCache, but when the area of the image has been
+          shifted by a multiple of its pixels the cached image is scrolled
+          and renderImage() is called for the uncovered pixels only.
+
+          This type of cache is intended for data, that is growing at
+          one side, while the scales are following - f.e. a waterfall
+          display of a spectrum analyzer ( QwtWaterfallRasterData ).
+          Modifications of the values, that have already been rendered,
+          have to be indicated by invalidateCache().
+
+          A refinement in the background ( ProgressiveRendering ) of
+          a previous area is cancelled before the image is scrolled.
+         */
+        ScrollingCache
     };
 
     /*!
@@ -77,7 +129,31 @@ public:
           depends on the implementation of the specific QPaintEngine.
          */
 
-        PaintInDeviceResolution = 1
+        PaintInDeviceResolution = 1,
+
+        /*!
+          When painting to screen a coarse image is rendered first,
+          that is scaled to the requested size. The image in full
+          resolution is refined in a background thread, strip by strip,
+          and the canvas is updated whenever a strip has been completed.
+
+          While the plot is in interactive mode ( QwtPlot::isInteractive() )
+          only the coarse image is rendered.
+
+          Like with PaintCache the refined image is reused as long
+          as the area and the size of the image do not change.
+          So invalidateCache() has to be called, when the raster data
+          has been modified.
+
+          The canvas updates for the completed strips are coalesced,
+          so that the canvas is not replotted more often than every 50 ms.
+
+          The background thread renders from a snapshot, that is returned
+          by imageRenderer(), and never calls the item itself. For items
+          without a snapshot the image is rendered in full resolution,
+          when the plot is not in interactive mode.
+         */
+        ProgressiveRendering = 2
     };
 
     //! Paint attributes
@@ -96,7 +172,7 @@ public:
     void setCachePolicy( CachePolicy );
     CachePolicy cachePolicy() const;
 
-    void invalidateCache();
+    virtual void invalidateCache();
 
     virtual void draw( QPainter *,
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
@@ -108,6 +184,8 @@ public:
     virtual QRectF boundingRect() const QWT_OVERRIDE;
 
 protected:
+    void cancelRendering();
+
     /*!
       \brief Render an image
 
@@ -128,6 +206,8 @@ protected:
         const QwtScaleMap &yMap, const QRectF &area,
         const QSize &imageSize ) const = 0;
 
+    virtual QwtRasterImageRenderer *imageRenderer() const;
+
     virtual QwtScaleMap imageMap( Qt::Orientation,
         const QwtScaleMap &map, const QRectF &area,
         const QSize &imageSize, double pixelSize) const;
@@ -140,7 +220,10 @@ private:
 
     QImage compose( const QwtScaleMap &, const QwtScaleMap &,
         const QRectF &imageArea, const QRectF &paintRect,
-        const QSize &imageSize, bool doCache) const;
+        const QSize &imageSize, bool doCache, bool doProgressive ) const;
+
+    QImage scrollImage( const QwtScaleMap &, const QwtScaleMap &,
+        const QRectF &area, const QSize &imageSize ) const;
 
 
     class PrivateData;
@@ -0,0 +1,333 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_plot_replot_scheduler.h"
+#include "qwt_plot.h"
+#include "qwt_math.h"
+
+#include <qpointer.h>
+#include <qlist.h>
+#include <qelapsedtimer.h>
+#include <qcoreevent.h>
+
+class QwtPlotReplotScheduler::PrivateData
+{
+public:
+    PrivateData():
+        frameRate( 60.0 ),
+        framePolicy( QwtPlotReplotScheduler::SkipFrames ),
+        timerId( 0 ),
+        isRendering( false ),
+        nextFrame( 0.0 )
+    {
+        clock.start();
+        resetStatistics();
+    }
+
+    void resetStatistics()
+    {
+        numRequests = 0;
+        numCoalesced = 0;
+        numFrames = 0;
+        numReplots = 0;
+        numSkipped = 0;
+        frameTime = 0.0;
+    }
+
+    inline double frameInterval() const
+    {
+        return ( frameRate > 0.0 ) ? 1000.0 / frameRate : 0.0;
+    }
+
+    double frameRate;
+    QwtPlotReplotScheduler::FramePolicy framePolicy;
+
+    QList< QPointer<QwtPlot> > pendingPlots;
+
+    int timerId;
+    bool isRendering;
+
+    QElapsedTimer clock;
+
+    // start of the next frame in ms of clock
+    double nextFrame;
+
+    int numRequests;
+    int numCoalesced;
+    int numFrames;
+    int numReplots;
+    int numSkipped;
+    double frameTime; // sum of all frames in ms
+};
+
+/*!
+  \brief Constructor
+
+  The frame rate is initialized to 60 frames per second
+  and the frame policy to SkipFrames.
+
+  \param parent Parent object
+ */
+QwtPlotReplotScheduler::QwtPlotReplotScheduler( QObject *parent ):
+    QObject( parent )
+{
+    d_data = new PrivateData;
+}
+
+//! Destructor
+QwtPlotReplotScheduler::~QwtPlotReplotScheduler()
+{
+    delete d_data;
+}
+
+/*!
+  \brief Set the maximum number of frames per second
+
+  \param framesPerSecond Frame rate. A rate <= 0.0 disables the
+                         limit, so that the requests are only coalesced,
+                         until the control returns to the event loop.
+
+  \sa frameRate()
+ */
+void QwtPlotReplotScheduler::setFrameRate( double framesPerSecond )
+{
+    d_data->frameRate = qwtMaxF( framesPerSecond, 0.0 );
+}
+
+/*!
+  \return Maximum number of frames per second
+  \sa setFrameRate()
+ */
+double QwtPlotReplotScheduler::frameRate() const
+{
+    return d_data->frameRate;
+}
+
+/*!
+  Set the policy for frames, that take longer than the frame interval
+
+  \param policy Frame policy
+  \sa framePolicy(), numSkippedFrames()
+ */
+void QwtPlotReplotScheduler::setFramePolicy( FramePolicy policy )
+{
+    d_data->framePolicy = policy;
+}
+
+/*!
+  \return Policy for frames, that take longer than the frame interval
+  \sa setFramePolicy()
+ */
+QwtPlotReplotScheduler::FramePolicy QwtPlotReplotScheduler::framePolicy() const
+{
+    return d_data->framePolicy;
+}
+
+/*!
+  \brief Request a replot of a plot
+
+  The plot is replotted with the next frame. Further requests for
+  the same plot until then are coalesced.
+
+  \param plot Plot
+  \sa QwtPlot::scheduleReplot(), isReplotPending(), flush()
+ */
+void QwtPlotReplotScheduler::requestReplot( QwtPlot *plot )
+{
+    if ( plot == NULL )
+        return;
+
+    d_data->numRequests++;
+
+    if ( d_data->pendingPlots.contains( plot ) )
+    {
+        d_data->numCoalesced++;
+        return;
+    }
+
+    d_data->pendingPlots += plot;
+
+    if ( d_data->timerId == 0 && !d_data->isRendering )
+        scheduleFrame();
+}
+
+/*!
+  \return True, when a replot has been requested for plot,
+          that has not been done yet
+  \sa requestReplot()
+ */
+bool QwtPlotReplotScheduler::isReplotPending( const QwtPlot *plot ) const
+{
+    for ( int i = 0; i < d_data->pendingPlots.size(); i++ )
+    {
+        if ( d_data->pendingPlots[i] == plot )
+            return true;
+    }
+
+    return false;
+}
+
+/*!
+  Replot all plots with pending requests immediately,
+  without waiting for the next frame.
+
+  \sa requestReplot()
+ */
+void QwtPlotReplotScheduler::flush()
+{
+    if ( d_data->timerId != 0 )
+    {
+        killTimer( d_data->timerId );
+        d_data->timerId = 0;
+    }
+
+    renderFrame();
+}
+
+//! \return Number of requests since the last resetStatistics()
+int QwtPlotReplotScheduler::numRequests() const
+{
+    return d_data->numRequests;
+}
+
+/*!
+  \return Number of requests, that have been coalesced with
+          a pending request for the same plot
+ */
+int QwtPlotReplotScheduler::numCoalescedRequests() const
+{
+    return d_data->numCoalesced;
+}
+
+//! \return Number of frames, where plots have been replotted
+int QwtPlotReplotScheduler::numFrames() const
+{
+    return d_data->numFrames;
+}
+
+//! \return Number of replots
+int QwtPlotReplotScheduler::numReplots() const
+{
+    return d_data->numReplots;
+}
+
+/*!
+  \return Number of frames, that have been skipped, because
+          the previous frame took too long
+  \sa SkipFrames
+ */
+int QwtPlotReplotScheduler::numSkippedFrames() const
+{
+    return d_data->numSkipped;
+}
+
+//! \return Average time for replotting the plots of a frame in ms
+double QwtPlotReplotScheduler::averageFrameTime() const
+{
+    if ( d_data->numFrames == 0 )
+        return 0.0;
+
+    return d_data->frameTime / d_data->numFrames;
+}
+
+//! Reset all counters
+void QwtPlotReplotScheduler::resetStatistics()
+{
+    d_data->resetStatistics();
+}
+
+/*!
+  Qt timer event, starting a frame
+  \param event Timer event
+ */
+void QwtPlotReplotScheduler::timerEvent( QTimerEvent *event )
+{
+    if ( event->timerId() != d_data->timerId )
+    {
+        QObject::timerEvent( event );
+        return;
+    }
+
+    killTimer( d_data->timerId );
+    d_data->timerId = 0;
+
+    renderFrame();
+}
+
+void QwtPlotReplotScheduler::renderFrame()
+{
+    // replots might request further replots, that go to the next frame
+
+    const QList< QPointer<QwtPlot> > plots = d_data->pendingPlots;
+    d_data->pendingPlots.clear();
+
+    if ( plots.isEmpty() )
+        return;
+
+    const double start = d_data->clock.elapsed();
+
+    d_data->isRendering = true;
+
+    for ( int i = 0; i < plots.size(); i++ )
+    {
+        QwtPlot *plot = plots[i];
+        if ( plot )
+        {
+            plot->replot();
+            d_data->numReplots++;
+        }
+    }
+
+    d_data->isRendering = false;
+
+    const double end = d_data->clock.elapsed();
+
+    d_data->numFrames++;
+    d_data->frameTime += end - start;
+
+    const double interval = d_data->frameInterval();
+
+    d_data->nextFrame = start + interval;
+
+    if ( end > d_data->nextFrame && interval > 0.0 )
+    {
+        if ( d_data->framePolicy == SkipFrames )
+        {
+            // continuing with the next frame, that has not been started yet
+
+            const int numSkipped = qwtFloor( ( end - start ) / interval );
+
+            d_data->numSkipped += numSkipped;
+            d_data->nextFrame = start + ( numSkipped + 1 ) * interval;
+        }
+        else
+        {
+            d_data->nextFrame = end;
+        }
+    }
+
+    if ( !d_data->pendingPlots.isEmpty() && d_data->timerId == 0 )
+        scheduleFrame();
+}
+
+void QwtPlotReplotScheduler::scheduleFrame()
+{
+    const double delay = d_data->nextFrame - d_data->clock.elapsed();
+    const int ms = ( delay > 0.0 ) ? qwtCeil( delay ) : 0;
+
+#if QT_VERSION >= 0x050000
+    d_data->timerId = startTimer( ms, Qt::PreciseTimer );
+#else
+    d_data->timerId = startTimer( ms );
+#endif
+}
+
+#if QWT_MOC_INCLUDE
+#include "moc_qwt_plot_replot_scheduler.cpp"
+#endif
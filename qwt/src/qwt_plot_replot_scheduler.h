@@ -0,0 +1,111 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_PLOT_REPLOT_SCHEDULER_H
+#define QWT_PLOT_REPLOT_SCHEDULER_H
+
+#include "qwt_global.h"
+#include <qobject.h>
+
+class QwtPlot;
+
+/*!
+  \brief Coalescing the replots of plots into frames
+
+  When several data sources are updating a plot independently - f.e.
+  by setSamples() with autoReplot() enabled - the plot is replotted
+  much more often than the screen is able to display. QwtPlotReplotScheduler
+  collects the requests of its plots and replots each plot at most
+  once for each frame.
+
+  The frames are started with a fixed rate ( see setFrameRate() ).
+  When a request arrives after an idle period, the plot is replotted
+  as soon as the control returns to the event loop. So requests
+  from the same event handler are coalesced, without adding latency.
+
+  A scheduler can be shared by many plots, what is recommended for
+  dashboards, where all plots are updated in the same frames.
+
+  \code
+    QwtPlotReplotScheduler *scheduler = new QwtPlotReplotScheduler( this );
+    scheduler->setFrameRate( 30.0 );
+
+    for ( int i = 0; i < plots.size(); i++ )
+    {
+        plots[i]->setAutoReplot( true );
+        plots[i]->setReplotScheduler( scheduler );
+    }
+  \endcode
+
+  \sa QwtPlot::scheduleReplot(), QwtPlot::setReplotScheduler()
+*/
+class QWT_EXPORT QwtPlotReplotScheduler: public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+      \brief Policy for frames, that take longer than the frame interval
+
+      \sa setFramePolicy()
+     */
+    enum FramePolicy
+    {
+        /*!
+          Start the next frame immediately, when the previous frame
+          has taken longer than the frame interval. As long as there are
+          requests, the replots might saturate the GUI thread.
+         */
+        CatchUpFrames,
+
+        /*!
+          Skip the frames, that would have been started while the
+          previous frame was in progress, and wait for the next one.
+          This leaves time for processing user input, when the plots
+          are too slow for the frame rate.
+         */
+        SkipFrames
+    };
+
+    explicit QwtPlotReplotScheduler( QObject *parent = NULL );
+    virtual ~QwtPlotReplotScheduler();
+
+    void setFrameRate( double framesPerSecond );
+    double frameRate() const;
+
+    void setFramePolicy( FramePolicy );
+    FramePolicy framePolicy() const;
+
+    void requestReplot( QwtPlot * );
+    bool isReplotPending( const QwtPlot * ) const;
+
+    int numRequests() const;
+    int numCoalescedRequests() const;
+    int numFrames() const;
+    int numReplots() const;
+    int numSkippedFrames() const;
+    double averageFrameTime() const;
+
+    void resetStatistics();
+
+public Q_SLOTS:
+    void flush();
+
+protected:
+    virtual void timerEvent( QTimerEvent * ) QWT_OVERRIDE;
+
+private:
+    void renderFrame();
+    void scheduleFrame();
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
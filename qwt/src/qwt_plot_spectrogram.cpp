@@ -13,13 +13,16 @@
 #include "qwt_scale_map.h"
 #include "qwt_color_map.h"
 #include "qwt_math.h"
+#include "qwt_render_scheduler.h"
 
 #include <qimage.h>
+#include <qvector.h>
 #include <qpen.h>
 #include <qpainter.h>
 #include <qthread.h>
-#include <qfuture.h>
-#include <qtconcurrentrun.h>
+#include <qcache.h>
+#include <qmutex.h>
+#include <qsharedpointer.h>
 
 #define DEBUG_RENDER 0
 
@@ -45,14 +48,357 @@ static inline bool qwtIsNaN( double d )
     }
 }
 
+namespace
+{
+    // a tile of the pixel grid of a zoom level
+    class QwtTileKey
+    {
+    public:
+        QwtTileKey():
+            level( -1 ),
+            x( 0 ),
+            y( 0 )
+        {
+        }
+
+        QwtTileKey( int level, qint64 x, qint64 y ):
+            level( level ),
+            x( x ),
+            y( y )
+        {
+        }
+
+        inline bool operator==( const QwtTileKey &other ) const
+        {
+            return ( level == other.level ) && ( x == other.x ) && ( y == other.y );
+        }
+
+        int level;
+        qint64 x;
+        qint64 y;
+    };
+
+#if QT_VERSION >= 0x060000
+    inline size_t qHash( const QwtTileKey &key, size_t seed = 0 )
+#else
+    inline uint qHash( const QwtTileKey &key, uint seed = 0 )
+#endif
+    {
+        quint64 h = quint64( key.x ) * Q_UINT64_C( 0x9E3779B97F4A7C15 );
+        h ^= quint64( key.y ) + Q_UINT64_C( 0x7F4A7C159E3779B9 ) + ( h << 6 ) + ( h >> 2 );
+        h ^= quint64( key.level ) << 48;
+
+        return uint( h ^ ( h >> 32 ) ) ^ seed;
+    }
+
+    /*
+        The pixel grid of a zoom level: the pixel at ( i, j ) is at
+        ( originX + i * stepX, originY + j * stepY ) in scale coordinates.
+     */
+    class QwtTileLevel
+    {
+    public:
+        double stepX;
+        double stepY;
+
+        double originX;
+        double originY;
+
+        QwtInterval range;
+        QImage::Format format;
+    };
+
+    // a tile of an image and the maps of its pixels
+    class QwtSpectrogramTile
+    {
+    public:
+        QwtScaleMap xMap;
+        QwtScaleMap yMap;
+        QRect rect;
+        QImage *image;
+
+        double priority;
+    };
+
+    /*
+        tiles, that are passed to QwtPlotSpectrogram::renderTile()
+        or to the renderTile() of a snapshot of the spectrogram
+     */
+    template< typename Renderer >
+    class QwtSpectrogramJob: public QwtRenderJob
+    {
+    public:
+        typedef void ( Renderer::*RenderFunction )(
+            const QwtScaleMap &, const QwtScaleMap &, const QRect &, QImage * ) const;
+
+        QwtSpectrogramJob( const Renderer *renderer,
+                RenderFunction renderFunction ):
+            d_renderer( renderer ),
+            d_renderFunction( renderFunction )
+        {
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return tiles.size();
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            const QwtSpectrogramTile &tile = tiles[index];
+
+            ( d_renderer->*d_renderFunction )(
+                tile.xMap, tile.yMap, tile.rect, tile.image );
+        }
+
+        virtual double tilePriority( int index ) const QWT_OVERRIDE
+        {
+            return tiles[index].priority;
+        }
+
+        QVector< QwtSpectrogramTile > tiles;
+
+    private:
+        const Renderer *d_renderer;
+        const RenderFunction d_renderFunction;
+    };
+}
+
+static const int qwtTileSize = 128;
+
+// number of image rows, that are passed to QwtRasterData::blockValues()
+static const int qwtBlockSize = 32;
+
+static inline qint64 qwtFloorDiv( qint64 value, qint64 divisor )
+{
+    qint64 q = value / divisor;
+    if ( ( value % divisor != 0 ) && ( value < 0 ) )
+        q--;
+
+    return q;
+}
+
+static inline bool qwtFuzzyEqual( double value1, double value2 )
+{
+    return qAbs( value1 - value2 ) <= 1e-9 * qAbs( value1 );
+}
+
+static QImage qwtCreateImage( const QwtColorMap *colorMap, const QSize &size )
+{
+    const QImage::Format format = ( colorMap->format() == QwtColorMap::RGB )
+        ? QImage::Format_ARGB32 : QImage::Format_Indexed8;
+
+    QImage image( size, format );
+
+    if ( colorMap->format() == QwtColorMap::Indexed )
+        image.setColorTable( colorMap->colorTable256() );
+
+    return image;
+}
+
+/*
+    The image is split into more strips than threads, so that the
+    load is balanced and a cancelled job is abandoned quickly.
+    The strips in the center of the image are rendered first.
+ */
+static QVector< QwtSpectrogramTile > qwtStrips( const QwtScaleMap &xMap,
+    const QwtScaleMap &yMap, QImage *image, uint numThreads )
+{
+    int numStrips = int( numThreads );
+    if ( numStrips <= 0 )
+        numStrips = QThread::idealThreadCount();
+
+    numStrips = qBound( 1, 4 * numStrips, image->height() );
+    const int stripHeight = qMax( qwtCeil( double( image->height() ) / numStrips ), 1 );
+
+    QVector< QwtSpectrogramTile > strips;
+
+    for ( int y = 0; y < image->height(); y += stripHeight )
+    {
+        QwtSpectrogramTile tile;
+        tile.xMap = xMap;
+        tile.yMap = yMap;
+        tile.rect = QRect( 0, y, image->width(),
+            qMin( stripHeight, image->height() - y ) );
+        tile.image = image;
+        tile.priority = -qAbs( tile.rect.center().y() - 0.5 * image->height() );
+
+        strips += tile;
+    }
+
+    return strips;
+}
+
+static void qwtRenderTile( const QwtRasterData *data,
+    const QwtColorMap *colorMap, const QVector<QRgb> &colorTable,
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRect &tile, QImage *image )
+{
+    const QwtInterval range = data->interval( Qt::ZAxis );
+    if ( range.width() <= 0.0 )
+        return;
+
+    const bool hasGaps = !data->testAttribute( QwtRasterData::WithoutGaps );
+
+    const int numPixels = tile.width();
+    if ( numPixels <= 0 )
+        return;
+
+    /*
+        All rows of the tile share the same x coordinates. So they
+        are mapped once and the values are calculated for blocks
+        of rows, what allows the raster data to share calculations,
+        that depend on the x coordinates only. The colors are
+        calculated row by row using the batch interface of QwtColorMap.
+     */
+
+    QVector<double> xValues( numPixels );
+    for ( int i = 0; i < numPixels; i++ )
+        xValues[i] = tile.left() + i;
+
+    xMap.invTransform( xValues.constData(), xValues.data(), numPixels );
+
+    const int blockSize = qMin( tile.height(), qwtBlockSize );
+
+    QVector<double> yValues( blockSize );
+    QVector<double> valueBuffer( blockSize * numPixels );
+    QVector<uint> indexBuffer( numPixels );
+
+    uint *indexes = indexBuffer.data();
+
+    const int numColors = colorTable.size();
+    const QRgb *rgbTable = colorTable.constData();
+
+    for ( int y0 = tile.top(); y0 <= tile.bottom(); y0 += blockSize )
+    {
+        // the image is not needed anymore
+        if ( QwtRenderScheduler::isCancelled() )
+            return;
+
+        const int numRows = qMin( blockSize, tile.bottom() - y0 + 1 );
+
+        for ( int j = 0; j < numRows; j++ )
+            yValues[j] = y0 + j;
+
+        yMap.invTransform( yValues.constData(), yValues.data(), numRows );
+
+        data->blockValues( xValues.constData(), numPixels,
+            yValues.constData(), numRows, valueBuffer.data() );
+
+        for ( int j = 0; j < numRows; j++ )
+        {
+            const int y = y0 + j;
+            const double *values = valueBuffer.constData() + j * numPixels;
+
+            if ( colorMap->format() == QwtColorMap::RGB )
+            {
+                QRgb *line = reinterpret_cast<QRgb *>( image->scanLine( y ) );
+                line += tile.left();
+
+                if ( numColors == 0 )
+                {
+                    colorMap->rgbBatch( range,
+                        values, line, numPixels );
+                }
+                else
+                {
+                    colorMap->colorIndexBatch( numColors, range,
+                        values, indexes, numPixels );
+
+                    for ( int x = 0; x < numPixels; x++ )
+                        line[x] = rgbTable[ indexes[x] ];
+                }
+
+                if ( hasGaps )
+                {
+                    for ( int x = 0; x < numPixels; x++ )
+                    {
+                        if ( qwtIsNaN( values[x] ) )
+                            line[x] = 0u;
+                    }
+                }
+            }
+            else if ( colorMap->format() == QwtColorMap::Indexed )
+            {
+                unsigned char *line = image->scanLine( y );
+                line += tile.left();
+
+                colorMap->colorIndexBatch( 256, range,
+                    values, indexes, numPixels );
+
+                for ( int x = 0; x < numPixels; x++ )
+                    line[x] = static_cast<unsigned char>( indexes[x] );
+
+                if ( hasGaps )
+                {
+                    for ( int x = 0; x < numPixels; x++ )
+                    {
+                        if ( qwtIsNaN( values[x] ) )
+                            line[x] = 0;
+                    }
+                }
+            }
+        }
+    }
+}
+
+namespace
+{
+    /*
+        A snapshot of the spectrogram for the refinement in the background
+        ( QwtPlotRasterItem::ProgressiveRendering ). It shares the data
+        and the color map, so that they remain valid, when the spectrogram
+        gets deleted or the data/color map is replaced in the meantime.
+     */
+    class QwtSpectrogramRenderer: public QwtRasterImageRenderer
+    {
+    public:
+        virtual QImage renderImage(
+            const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+            const QRectF &area, const QSize &imageSize ) const QWT_OVERRIDE
+        {
+            if ( imageSize.isEmpty() || !data->interval( Qt::ZAxis ).isValid() )
+                return QImage();
+
+            QImage image = qwtCreateImage( colorMap.data(), imageSize );
+
+            data->initRaster( area, image.size() );
+
+            QwtSpectrogramJob< QwtSpectrogramRenderer > job(
+                this, &QwtSpectrogramRenderer::renderTile );
+            job.tiles = qwtStrips( xMap, yMap, &image, numThreads );
+
+            QwtRenderScheduler::run( job, numThreads );
+
+            data->discardRaster();
+
+            return image;
+        }
+
+        void renderTile( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+            const QRect &tile, QImage *image ) const
+        {
+            qwtRenderTile( data.data(), colorMap.data(), colorTable,
+                xMap, yMap, tile, image );
+        }
+
+        QSharedPointer< QwtRasterData > data;
+        QSharedPointer< QwtColorMap > colorMap;
+        QVector<QRgb> colorTable;
+        uint numThreads;
+    };
+}
+
 class QwtPlotSpectrogram::PrivateData
 {
 public:
     PrivateData():
-        data( NULL ),
-        maxRGBColorTableSize( 0 )
+        colorMap( new QwtLinearColorMap() ),
+        contourAlgorithm( QwtPlotSpectrogram::Conrec ),
+        maxRGBColorTableSize( 0 ),
+        tileCache( 0 ),
+        tileGeneration( 0 )
     {
-        colorMap = new QwtLinearColorMap();
         displayMode = ImageMode;
 
         conrecFlags = QwtRasterData::IgnoreAllVerticesOnLevel;
@@ -60,12 +406,6 @@ public:
         conrecFlags |= QwtRasterData::IgnoreOutOfRange;
 #endif
     }
-    ~PrivateData()
-    {
-        delete data;
-        delete colorMap;
-    }
-
     void updateColorTable()
     {
         if ( colorMap->format() == QwtColorMap::Indexed )
@@ -81,16 +421,73 @@ public:
         }
     }
 
-    QwtRasterData *data;
-    QwtColorMap *colorMap;
+    // shared with the snapshots for the refinement in the background
+    QSharedPointer< QwtRasterData > data;
+    QSharedPointer< QwtColorMap > colorMap;
+
     DisplayModes displayMode;
 
     QList<double> contourLevels;
     QPen defaultContourPen;
     QwtRasterData::ConrecFlags conrecFlags;
+    QwtPlotSpectrogram::ContourAlgorithm contourAlgorithm;
+
+    // the caller has to lock tileMutex
+    void clearTiles()
+    {
+        tileLevels.clear();
+        tileCache.clear();
+        tileGeneration++;
+    }
+
+    // the caller has to lock tileMutex
+    int tileLevel( double stepX, double stepY, double x0, double y0,
+        const QwtInterval &range, QImage::Format format )
+    {
+        for ( int i = 0; i < tileLevels.size(); i++ )
+        {
+            const QwtTileLevel &level = tileLevels[i];
+
+            if ( qwtFuzzyEqual( level.stepX, stepX )
+                && qwtFuzzyEqual( level.stepY, stepY )
+                && level.range == range && level.format == format )
+            {
+                return i;
+            }
+        }
+
+        // zooming in many small steps
+        if ( tileLevels.size() >= 64 )
+            clearTiles();
+
+        QwtTileLevel level;
+        level.stepX = stepX;
+        level.stepY = stepY;
+        level.originX = x0;
+        level.originY = y0;
+        level.range = range;
+        level.format = format;
+
+        tileLevels += level;
+        return tileLevels.size() - 1;
+    }
 
     int maxRGBColorTableSize;
     QVector<QRgb> colorTable;
+
+    /*
+        renderImage() might be called from different threads, f.e.
+        when rendering the plot into an image in the background.
+        Even lookups modify the cache, as they reorder the list of
+        recently used tiles. So all accesses to the levels and the
+        cache are protected by tileMutex.
+     */
+    QMutex tileMutex;
+    QVector<QwtTileLevel> tileLevels;
+    QCache<QwtTileKey, QImage> tileCache; // cost in kbytes
+
+    // incremented, whenever the level indexes become invalid
+    int tileGeneration;
 };
 
 /*!
@@ -178,15 +575,12 @@ void QwtPlotSpectrogram::setColorMap( QwtColorMap *colorMap )
     if ( colorMap == NULL )
         return;
 
-    if ( colorMap != d_data->colorMap )
-    {
-        delete d_data->colorMap;
-        d_data->colorMap = colorMap;
-    }
+    invalidateCache();
 
-    d_data->updateColorTable();
+    if ( colorMap != d_data->colorMap.data() )
+        d_data->colorMap = QSharedPointer< QwtColorMap >( colorMap );
 
-    invalidateCache();
+    d_data->updateColorTable();
 
     legendChanged();
     itemChanged();
@@ -198,7 +592,7 @@ void QwtPlotSpectrogram::setColorMap( QwtColorMap *colorMap )
 */
 const QwtColorMap *QwtPlotSpectrogram::colorMap() const
 {
-    return d_data->colorMap;
+    return d_data->colorMap.data();
 }
 
 void QwtPlotSpectrogram::setMaxRGBTableSize( int numColors )
@@ -206,9 +600,10 @@ void QwtPlotSpectrogram::setMaxRGBTableSize( int numColors )
     numColors = qMax( numColors, 0 );
     if ( numColors != d_data->maxRGBColorTableSize )
     {
+        invalidateCache();
+
         d_data->maxRGBColorTableSize = numColors;
         d_data->updateColorTable();
-        invalidateCache();
     }
 }
 
@@ -217,6 +612,61 @@ int QwtPlotSpectrogram::maxRGBTableSize() const
     return d_data->maxRGBColorTableSize;
 }
 
+/*!
+   \brief Set the memory limit for the tile cache
+
+   The tile cache stores the rendered pixels in tiles of a grid,
+   that is aligned to the pixels of a zoom level. When panning
+   only the tiles, that have been exposed need to be rendered,
+   and when zooming back to a previous level its tiles are reused.
+   When the cache is full the least recently used tiles are removed.
+
+   When the image is shifted by a fraction of a pixel the tiles
+   are reused with the closest pixel position. The tile cache is
+   only used for linear scales.
+
+   The cache has to be invalidated ( invalidateCache() ), when the
+   values of the raster data have been modified.
+
+   \param kbytes Memory limit in kilobytes, 0 disables the tile cache
+   \sa tileCacheLimit(), invalidateCache()
+ */
+void QwtPlotSpectrogram::setTileCacheLimit( int kbytes )
+{
+    kbytes = qMax( kbytes, 0 );
+
+    if ( kbytes != tileCacheLimit() )
+    {
+        QMutexLocker locker( &d_data->tileMutex );
+
+        d_data->tileCache.setMaxCost( kbytes );
+        if ( kbytes == 0 )
+            d_data->clearTiles();
+    }
+}
+
+/*!
+   \return Memory limit for the tile cache in kilobytes
+   \sa setTileCacheLimit()
+ */
+int QwtPlotSpectrogram::tileCacheLimit() const
+{
+    QMutexLocker locker( &d_data->tileMutex );
+    return static_cast< int >( d_data->tileCache.maxCost() );
+}
+
+/*!
+   Invalidate the paint cache and the tile cache
+   \sa setCachePolicy(), setTileCacheLimit()
+ */
+void QwtPlotSpectrogram::invalidateCache()
+{
+    QwtPlotRasterItem::invalidateCache();
+
+    QMutexLocker locker( &d_data->tileMutex );
+    d_data->clearTiles();
+}
+
 /*!
   Build and assign the default pen for the contour lines
 
@@ -279,7 +729,7 @@ QPen QwtPlotSpectrogram::defaultContourPen() const
 */
 QPen QwtPlotSpectrogram::contourPen( double level ) const
 {
-    if ( d_data->data == NULL || d_data->colorMap == NULL )
+    if ( d_data->data.isNull() || d_data->colorMap.isNull() )
         return QPen();
 
     const QwtInterval intensityRange = d_data->data->interval(Qt::ZAxis);
@@ -361,6 +811,36 @@ QList<double> QwtPlotSpectrogram::contourLevels() const
     return d_data->contourLevels;
 }
 
+/*!
+   Set the algorithm, that is used to calculate the contour lines
+
+   The marching squares algorithm samples the raster data once
+   and joins the line segments to polylines, what is usually
+   much faster for many levels and large rasters.
+
+   The default setting is Conrec.
+
+   \param algorithm Contour algorithm
+   \sa contourAlgorithm(), renderContourLines(), renderContourPolylines()
+*/
+void QwtPlotSpectrogram::setContourAlgorithm( ContourAlgorithm algorithm )
+{
+    if ( algorithm != d_data->contourAlgorithm )
+    {
+        d_data->contourAlgorithm = algorithm;
+        itemChanged();
+    }
+}
+
+/*!
+   \return Algorithm, that is used to calculate the contour lines
+   \sa setContourAlgorithm()
+*/
+QwtPlotSpectrogram::ContourAlgorithm QwtPlotSpectrogram::contourAlgorithm() const
+{
+    return d_data->contourAlgorithm;
+}
+
 /*!
   Set the data to be displayed
 
@@ -369,12 +849,12 @@ QList<double> QwtPlotSpectrogram::contourLevels() const
 */
 void QwtPlotSpectrogram::setData( QwtRasterData *data )
 {
-    if ( data != d_data->data )
+    if ( data != d_data->data.data() )
     {
-        delete d_data->data;
-        d_data->data = data;
-
         invalidateCache();
+
+        d_data->data = QSharedPointer< QwtRasterData >( data );
+
         itemChanged();
     }
 }
@@ -385,7 +865,7 @@ void QwtPlotSpectrogram::setData( QwtRasterData *data )
 */
 const QwtRasterData *QwtPlotSpectrogram::data() const
 {
-    return d_data->data;
+    return d_data->data.data();
 }
 
 /*!
@@ -394,7 +874,7 @@ const QwtRasterData *QwtPlotSpectrogram::data() const
 */
 QwtRasterData *QwtPlotSpectrogram::data()
 {
-    return d_data->data;
+    return d_data->data.data();
 }
 
 /*!
@@ -408,7 +888,7 @@ QwtRasterData *QwtPlotSpectrogram::data()
 */
 QwtInterval QwtPlotSpectrogram::interval(Qt::Axis axis) const
 {
-    if ( d_data->data == NULL )
+    if ( d_data->data.isNull() )
         return QwtInterval();
 
     return d_data->data->interval( axis );
@@ -432,7 +912,7 @@ QwtInterval QwtPlotSpectrogram::interval(Qt::Axis axis) const
 */
 QRectF QwtPlotSpectrogram::pixelHint( const QRectF &area ) const
 {
-    if ( d_data->data == NULL )
+    if ( d_data->data.isNull() )
         return QRectF();
 
     return d_data->data->pixelHint( area );
@@ -442,6 +922,14 @@ QRectF QwtPlotSpectrogram::pixelHint( const QRectF &area ) const
    \brief Render an image from data and color map.
 
    For each pixel of area the value is mapped into a color.
+   The tiles of the image are rendered by QwtRenderScheduler.
+
+   Rendering is abandoned, when the token of the current
+   QwtRenderScheduler::Scope has been cancelled. Images for the screen
+   are rendered synchronously in the GUI thread and are always completed.
+   The refinement in the background ( QwtPlotRasterItem::ProgressiveRendering )
+   renders from a snapshot ( imageRenderer() ), that is cancelled as soon
+   as the image is not needed anymore.
 
   \param xMap X-Scale Map
   \param yMap Y-Scale Map
@@ -458,8 +946,8 @@ QImage QwtPlotSpectrogram::renderImage(
     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
     const QRectF &area, const QSize &imageSize ) const
 {
-    if ( imageSize.isEmpty() || d_data->data == NULL
-        || d_data->colorMap == NULL )
+    if ( imageSize.isEmpty() || d_data->data.isNull()
+        || d_data->colorMap.isNull() )
     {
         return QImage();
     }
@@ -468,13 +956,7 @@ QImage QwtPlotSpectrogram::renderImage(
     if ( !intensityRange.isValid() )
         return QImage();
 
-    const QImage::Format format = ( d_data->colorMap->format() == QwtColorMap::RGB )
-        ? QImage::Format_ARGB32 : QImage::Format_Indexed8;
-
-    QImage image( imageSize, format );
-
-    if ( d_data->colorMap->format() == QwtColorMap::Indexed )
-        image.setColorTable( d_data->colorMap->colorTable256() );
+    QImage image = qwtCreateImage( d_data->colorMap.data(), imageSize );
 
     d_data->data->initRaster( area, image.size() );
 
@@ -483,47 +965,17 @@ QImage QwtPlotSpectrogram::renderImage(
     time.start();
 #endif
 
-#if !defined(QT_NO_QFUTURE)
-    uint numThreads = renderThreadCount();
-
-    if ( numThreads <= 0 )
-        numThreads = QThread::idealThreadCount();
-
-    if ( numThreads <= 0 )
-        numThreads = 1;
-
-    const int numRows = imageSize.height() / numThreads;
-
-    QVector< QFuture<void> > futures;
-    futures.reserve( numThreads - 1 );
-
-    for ( uint i = 0; i < numThreads; i++ )
+    if ( renderCachedTiles( xMap, yMap, &image ) )
     {
-        QRect tile( 0, i * numRows, image.width(), numRows );
-        if ( i == numThreads - 1 )
-        {
-            tile.setHeight( image.height() - i * numRows );
-            renderTile( xMap, yMap, tile, &image );
-        }
-        else
-        {
-            futures += QtConcurrent::run(
-#if QT_VERSION >= 0x060000
-                &QwtPlotSpectrogram::renderTile, this,
-#else
-                this, &QwtPlotSpectrogram::renderTile,
-#endif
-                xMap, yMap, tile, &image );
-        }
+        d_data->data->discardRaster();
+        return image;
     }
 
-    for ( int i = 0; i < futures.size(); i++ )
-        futures[i].waitForFinished();
+    QwtSpectrogramJob< QwtPlotSpectrogram > job(
+        this, &QwtPlotSpectrogram::renderTile );
+    job.tiles = qwtStrips( xMap, yMap, &image, renderThreadCount() );
 
-#else
-    const QRect tile( 0, 0, image.width(), image.height() );
-    renderTile( xMap, yMap, tile, &image );
-#endif
+    QwtRenderScheduler::run( job, renderThreadCount() );
 
 #if DEBUG_RENDER
     const qint64 elapsed = time.elapsed();
@@ -536,88 +988,229 @@ QImage QwtPlotSpectrogram::renderImage(
 }
 
 /*!
-    \brief Render a tile of an image.
+   \brief Create a snapshot for rendering in a background thread
 
-    Rendering in tiles can be used to composite an image in parallel
-    threads.
+   The snapshot shares the data and the color map with the spectrogram.
+   It renders the image like renderImage(), but without using
+   the tile cache.
 
-    \param xMap X-Scale Map
-    \param yMap Y-Scale Map
-    \param tile Geometry of the tile in image coordinates
-    \param image Image to be rendered
+   \return Snapshot for the refinement in the background
+           ( QwtPlotRasterItem::ProgressiveRendering ), or NULL,
+           when there is no data or no color map.
+
+   \note A class, that reimplements renderImage(), has to reimplement
+         imageRenderer() as well - f.e. returning NULL, what disables
+         the refinement in the background.
+
+   \sa QwtPlotRasterItem::imageRenderer()
 */
-void QwtPlotSpectrogram::renderTile(
-    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
-    const QRect &tile, QImage *image ) const
+QwtRasterImageRenderer *QwtPlotSpectrogram::imageRenderer() const
 {
+    if ( d_data->data.isNull() || d_data->colorMap.isNull() )
+        return NULL;
+
+    QwtSpectrogramRenderer *renderer = new QwtSpectrogramRenderer();
+    renderer->data = d_data->data;
+    renderer->colorMap = d_data->colorMap;
+    renderer->colorTable = d_data->colorTable;
+    renderer->numThreads = renderThreadCount();
+
+    return renderer;
+}
+
+/*
+    Compose the image from the tiles of the cache. Missing tiles
+    are rendered and inserted into the cache.
+    Returns false, when the tile cache can't be used.
+ */
+bool QwtPlotSpectrogram::renderCachedTiles(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap, QImage *image ) const
+{
+    if ( xMap.transformation() || yMap.transformation() )
+        return false;
+
+    const double x0 = xMap.invTransform( 0.0 );
+    const double y0 = yMap.invTransform( 0.0 );
+
+    const double stepX = xMap.invTransform( 1.0 ) - x0;
+    const double stepY = yMap.invTransform( 1.0 ) - y0;
+
+    if ( !( stepX != 0.0 && stepY != 0.0 ) ) // also NaNs
+        return false;
+
     const QwtInterval range = d_data->data->interval( Qt::ZAxis );
-    if ( range.width() <= 0.0 )
-        return;
 
-    const bool hasGaps = !d_data->data->testAttribute( QwtRasterData::WithoutGaps );
+    QMutexLocker locker( &d_data->tileMutex );
 
-    if ( d_data->colorMap->format() == QwtColorMap::RGB )
-    {
-        const int numColors = d_data->colorTable.size();
-        const QRgb *rgbTable = d_data->colorTable.constData();
-        const QwtColorMap *colorMap = d_data->colorMap;
+    if ( d_data->tileCache.maxCost() <= 0 )
+        return false;
 
-        for ( int y = tile.top(); y <= tile.bottom(); y++ )
-        {
-            const double ty = yMap.invTransform( y );
+    const int levelIndex = d_data->tileLevel(
+        stepX, stepY, x0, y0, range, image->format() );
 
-            QRgb *line = reinterpret_cast<QRgb *>( image->scanLine( y ) );
-            line += tile.left();
+    const QwtTileLevel level = d_data->tileLevels[ levelIndex ];
+    const int generation = d_data->tileGeneration;
 
-            for ( int x = tile.left(); x <= tile.right(); x++ )
-            {
-                const double tx = xMap.invTransform( x );
+    // position of the image in the pixel grid of the level
 
-                const double value = d_data->data->value( tx, ty );
+    const qint64 offsetX = qRound64( ( x0 - level.originX ) / level.stepX );
+    const qint64 offsetY = qRound64( ( y0 - level.originY ) / level.stepY );
 
-                if ( hasGaps && qwtIsNaN( value ) )
-                {
-                    *line++ = 0u;
-                }
-                else if ( numColors == 0 )
-                {
-                    *line++ = colorMap->rgb( range, value );
-                }
-                else
-                {
-                    const uint index = colorMap->colorIndex( numColors, range, value );
-                    *line++ = rgbTable[index];
-                }
+    const qint64 tx1 = qwtFloorDiv( offsetX, qwtTileSize );
+    const qint64 tx2 = qwtFloorDiv( offsetX + image->width() - 1, qwtTileSize );
+    const qint64 ty1 = qwtFloorDiv( offsetY, qwtTileSize );
+    const qint64 ty2 = qwtFloorDiv( offsetY + image->height() - 1, qwtTileSize );
+
+    QVector<QwtTileKey> keys;
+    QVector<QImage> tiles;
+    QVector<int> missing;
+
+    for ( qint64 ty = ty1; ty <= ty2; ty++ )
+    {
+        for ( qint64 tx = tx1; tx <= tx2; tx++ )
+        {
+            const QwtTileKey key( levelIndex, tx, ty );
+
+            const QImage *tile = d_data->tileCache.object( key );
+            if ( tile )
+            {
+                tiles += *tile;
+            }
+            else
+            {
+                missing += tiles.size();
+                tiles += QImage( qwtTileSize, qwtTileSize, image->format() );
             }
+
+            keys += key;
         }
     }
-    else if ( d_data->colorMap->format() == QwtColorMap::Indexed )
+
+    // the tiles are rendered without blocking other threads
+    locker.unlock();
+
+    if ( !missing.isEmpty() )
     {
-        for ( int y = tile.top(); y <= tile.bottom(); y++ )
+        // the tiles close to the center of the image first
+
+        const double cx = offsetX + 0.5 * image->width();
+        const double cy = offsetY + 0.5 * image->height();
+
+        QwtSpectrogramJob< QwtPlotSpectrogram > job(
+            this, &QwtPlotSpectrogram::renderTile );
+
+        for ( int i = 0; i < missing.size(); i++ )
         {
-            const double ty = yMap.invTransform( y );
+            const QwtTileKey &key = keys[ missing[i] ];
 
-            unsigned char *line = image->scanLine( y );
-            line += tile.left();
+            const double px = double( key.x ) * qwtTileSize;
+            const double py = double( key.y ) * qwtTileSize;
 
-            for ( int x = tile.left(); x <= tile.right(); x++ )
-            {
-                const double tx = xMap.invTransform( x );
+            QwtSpectrogramTile tile;
 
-                const double value = d_data->data->value( tx, ty );
+            tile.xMap = xMap;
+            tile.xMap.setPaintInterval( 0.0, qwtTileSize );
+            tile.xMap.setScaleInterval( level.originX + px * level.stepX,
+                level.originX + ( px + qwtTileSize ) * level.stepX );
 
-                if ( hasGaps && qwtIsNaN( value ) )
-                {
-                    *line++ = 0;
-                }
-                else
-                {
-                    const uint index = d_data->colorMap->colorIndex( 256, range, value );
-                    *line++ = static_cast<unsigned char>( index );
-                }
+            tile.yMap = yMap;
+            tile.yMap.setPaintInterval( 0.0, qwtTileSize );
+            tile.yMap.setScaleInterval( level.originY + py * level.stepY,
+                level.originY + ( py + qwtTileSize ) * level.stepY );
+
+            tile.rect = QRect( 0, 0, qwtTileSize, qwtTileSize );
+            tile.image = &tiles[ missing[i] ];
+
+            const double dx = px + 0.5 * qwtTileSize - cx;
+            const double dy = py + 0.5 * qwtTileSize - cy;
+            tile.priority = -( dx * dx + dy * dy );
+
+            job.tiles += tile;
+        }
+
+        if ( !QwtRenderScheduler::run( job, renderThreadCount() ) )
+        {
+            /*
+                The job has been cancelled and the tiles are incomplete.
+                As the caller is not interested in the image anymore,
+                we simply return without caching them.
+             */
+            return true;
+        }
+
+        locker.relock();
+
+        // the level indexes are invalid, when the cache has been cleared
+        if ( generation == d_data->tileGeneration )
+        {
+            for ( int i = 0; i < missing.size(); i++ )
+            {
+                const QImage &tile = tiles[ missing[i] ];
+                const int cost = qMax( tile.bytesPerLine() * tile.height() / 1024, 1 );
+
+                d_data->tileCache.insert( keys[ missing[i] ],
+                    new QImage( tile ), cost );
             }
         }
+
+        locker.unlock();
+    }
+
+    // copying the pixels of the tiles, that overlap with the image
+
+    const int bytesPerPixel = image->depth() / 8;
+
+    for ( int i = 0; i < tiles.size(); i++ )
+    {
+        const QImage &tile = tiles[i];
+
+        const qint64 gx = keys[i].x * qwtTileSize;
+        const qint64 gy = keys[i].y * qwtTileSize;
+
+        const int x1 = int( qMax( gx, offsetX ) - offsetX );
+        const int x2 = int( qMin( gx + qwtTileSize, offsetX + image->width() ) - offsetX );
+        const int y1 = int( qMax( gy, offsetY ) - offsetY );
+        const int y2 = int( qMin( gy + qwtTileSize, offsetY + image->height() ) - offsetY );
+
+        const int tileX = int( offsetX + x1 - gx );
+
+        for ( int y = y1; y < y2; y++ )
+        {
+            const uchar *from = tile.constScanLine( int( offsetY + y - gy ) );
+            uchar *to = image->scanLine( y );
+
+            memcpy( to + x1 * bytesPerPixel, from + tileX * bytesPerPixel,
+                ( x2 - x1 ) * bytesPerPixel );
+        }
     }
+
+    return true;
+}
+
+/*!
+    \brief Render a tile of an image.
+
+    Rendering in tiles can be used to composite an image in parallel
+    threads.
+
+    The values are calculated in blocks of rows using
+    QwtRasterData::blockValues() and the colors row by row
+    using QwtColorMap::rgbBatch()/colorIndexBatch().
+
+    Rendering is stopped, when the token of the current
+    QwtRenderScheduler::Scope has been cancelled.
+
+    \param xMap X-Scale Map
+    \param yMap Y-Scale Map
+    \param tile Geometry of the tile in image coordinates
+    \param image Image to be rendered
+*/
+void QwtPlotSpectrogram::renderTile(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QRect &tile, QImage *image ) const
+{
+    qwtRenderTile( d_data->data.data(), d_data->colorMap.data(),
+        d_data->colorTable, xMap, yMap, tile, image );
 }
 
 /*!
@@ -666,7 +1259,7 @@ QSize QwtPlotSpectrogram::contourRasterSize(
 QwtRasterData::ContourLines QwtPlotSpectrogram::renderContourLines(
     const QRectF &rect, const QSize &raster ) const
 {
-    if ( d_data->data == NULL )
+    if ( d_data->data.isNull() )
         return QwtRasterData::ContourLines();
 
     return d_data->data->contourLines( rect, raster,
@@ -687,7 +1280,7 @@ void QwtPlotSpectrogram::drawContourLines( QPainter *painter,
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QwtRasterData::ContourLines &contourLines ) const
 {
-    if ( d_data->data == NULL )
+    if ( d_data->data.isNull() )
         return;
 
     const int numLevels = d_data->contourLevels.size();
@@ -717,6 +1310,74 @@ void QwtPlotSpectrogram::drawContourLines( QPainter *painter,
     }
 }
 
+/*!
+   Calculate contour lines, that are joined to polylines
+
+   \param rect Rectangle, where to calculate the contour lines
+   \param raster Raster, used by the marching squares algorithm
+   \return Calculated contour lines
+
+   \sa contourLevels(), setContourAlgorithm(),
+       QwtRasterData::contourPolylines()
+*/
+QwtRasterData::ContourPolylines QwtPlotSpectrogram::renderContourPolylines(
+    const QRectF &rect, const QSize &raster ) const
+{
+    if ( d_data->data.isNull() )
+        return QwtRasterData::ContourPolylines();
+
+    return d_data->data->contourPolylines( rect, raster,
+        d_data->contourLevels, d_data->conrecFlags );
+}
+
+/*!
+   Paint the contour lines, that have been joined to polylines
+
+   \param painter Painter
+   \param xMap Maps x-values into pixel coordinates.
+   \param yMap Maps y-values into pixel coordinates.
+   \param contourLines Contour lines
+
+   \sa renderContourPolylines(), defaultContourPen(), contourPen()
+*/
+void QwtPlotSpectrogram::drawContourPolylines( QPainter *painter,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QwtRasterData::ContourPolylines &contourLines ) const
+{
+    if ( d_data->data.isNull() )
+        return;
+
+    const int numLevels = d_data->contourLevels.size();
+    for ( int l = 0; l < numLevels; l++ )
+    {
+        const double level = d_data->contourLevels[l];
+
+        QPen pen = defaultContourPen();
+        if ( pen.style() == Qt::NoPen )
+            pen = contourPen( level );
+
+        if ( pen.style() == Qt::NoPen )
+            continue;
+
+        painter->setPen( pen );
+
+        const QList<QPolygonF> polylines = contourLines.value( level );
+        for ( int i = 0; i < polylines.size(); i++ )
+        {
+            QPolygonF polyline = polylines[i];
+
+            QPointF *points = polyline.data();
+            for ( int j = 0; j < polyline.size(); j++ )
+            {
+                points[j].setX( xMap.transform( points[j].x() ) );
+                points[j].setY( yMap.transform( points[j].y() ) );
+            }
+
+            QwtPainter::drawPolyline( painter, polyline );
+        }
+    }
+}
+
 /*!
   \brief Draw the spectrogram
 
@@ -758,10 +1419,20 @@ void QwtPlotSpectrogram::draw( QPainter *painter,
         raster = raster.boundedTo( rasterRect.toRect().size() );
         if ( raster.isValid() )
         {
-            const QwtRasterData::ContourLines lines =
-                renderContourLines( area, raster );
+            if ( d_data->contourAlgorithm == MarchingSquares )
+            {
+                const QwtRasterData::ContourPolylines lines =
+                    renderContourPolylines( area, raster );
 
-            drawContourLines( painter, xMap, yMap, lines );
+                drawContourPolylines( painter, xMap, yMap, lines );
+            }
+            else
+            {
+                const QwtRasterData::ContourLines lines =
+                    renderContourLines( area, raster );
+
+                drawContourLines( painter, xMap, yMap, lines );
+            }
         }
     }
 }
@@ -28,6 +28,9 @@ template <typename T> class QList;
   can often be improved by dividing the area into tiles - each of them
   rendered in a different thread ( see QwtPlotItem::setRenderThreadCount() ).
 
+  When panning or zooming back and forth the images of previous
+  renderings can be reused with a tile cache ( see setTileCacheLimit() ).
+
   In ContourMode contour lines are painted for the contour levels.
 
   \image html spectrogram3.png
@@ -55,6 +58,25 @@ public:
     //! Display modes
     typedef QFlags<DisplayMode> DisplayModes;
 
+    /*!
+      The algorithm, that is used to calculate the contour lines
+      \sa setContourAlgorithm(), contourAlgorithm()
+     */
+    enum ContourAlgorithm
+    {
+        /*!
+          CONREC, calculating line segments
+          \sa QwtRasterData::contourLines()
+         */
+        Conrec,
+
+        /*!
+          Marching squares, calculating polylines
+          \sa QwtRasterData::contourPolylines()
+         */
+        MarchingSquares
+    };
+
     explicit QwtPlotSpectrogram( const QString &title = QString() );
     virtual ~QwtPlotSpectrogram();
 
@@ -71,6 +93,11 @@ public:
     void setMaxRGBTableSize( int numColors );
     int maxRGBTableSize() const;
 
+    void setTileCacheLimit( int kbytes );
+    int tileCacheLimit() const;
+
+    virtual void invalidateCache() QWT_OVERRIDE;
+
     virtual QwtInterval interval( Qt::Axis ) const QWT_OVERRIDE;
     virtual QRectF pixelHint( const QRectF & ) const QWT_OVERRIDE;
 
@@ -87,6 +114,9 @@ public:
     void setContourLevels( const QList<double> & );
     QList<double> contourLevels() const;
 
+    void setContourAlgorithm( ContourAlgorithm );
+    ContourAlgorithm contourAlgorithm() const;
+
     virtual int rtti() const QWT_OVERRIDE;
 
     virtual void draw( QPainter *,
@@ -98,6 +128,8 @@ protected:
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QRectF &area, const QSize &imageSize ) const QWT_OVERRIDE;
 
+    virtual QwtRasterImageRenderer *imageRenderer() const QWT_OVERRIDE;
+
     virtual QSize contourRasterSize(
         const QRectF &, const QRect & ) const;
 
@@ -108,10 +140,20 @@ protected:
         const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QwtRasterData::ContourLines& ) const;
 
+    virtual QwtRasterData::ContourPolylines renderContourPolylines(
+        const QRectF &rect, const QSize &raster ) const;
+
+    virtual void drawContourPolylines( QPainter *,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QwtRasterData::ContourPolylines& ) const;
+
     void renderTile( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QRect &tile, QImage * ) const;
 
 private:
+    bool renderCachedTiles( const QwtScaleMap &xMap,
+        const QwtScaleMap &yMap, QImage * ) const;
+
     class PrivateData;
     PrivateData *d_data;
 };
@@ -33,6 +33,7 @@ QwtSyntheticPointData::QwtSyntheticPointData(
 void QwtSyntheticPointData::setSize( size_t size )
 {
     d_size = size;
+    incrementRevision();
 }
 
 /*!
@@ -53,6 +54,7 @@ size_t QwtSyntheticPointData::size() const
 void QwtSyntheticPointData::setInterval( const QwtInterval &interval )
 {
     d_interval = interval.normalized();
+    incrementRevision();
 }
 
 /*!
@@ -80,6 +82,8 @@ void QwtSyntheticPointData::setRectOfInterest( const QRectF &rect )
     d_rectOfInterest = rect;
     d_intervalOfInterest = QwtInterval(
         rect.left(), rect.right() ).normalized();
+
+    incrementRevision();
 }
 
 /*!
@@ -15,8 +15,33 @@
 
 #include <cstring>
 
+// assigning the arrays, when their type matches the requested one
+template <typename T, typename U>
+inline bool qwtContiguousData( const T *, const T *, const U **, const U ** )
+{
+    return false;
+}
+
+template <typename T>
+inline bool qwtContiguousData( const T *x, const T *y,
+    const T **xData, const T **yData )
+{
+    *xData = x;
+    *yData = y;
+
+    return true;
+}
+
 /*!
   \brief Interface for iterating over two QVector<T> objects.
+
+  For T = double or float the vectors are offered to QwtPointMapper
+  as contiguous arrays, so that mapping them is not slowed
+  down by calling sample() for each point.
+
+  For x values in increasing order ( f.e. time series ) it is recommended
+  to enable QwtSeriesData::setXSorted(), so that QwtPlotCurve
+  can skip the samples outside of the visible area.
 */
 template <typename T>
 class QwtPointArrayData: public QwtPointSeriesData
@@ -28,6 +53,12 @@ public:
     virtual size_t size() const QWT_OVERRIDE;
     virtual QPointF sample( size_t index ) const QWT_OVERRIDE;
 
+    virtual bool contiguousDoubleData(
+        const double **xData, const double **yData ) const QWT_OVERRIDE;
+
+    virtual bool contiguousFloatData(
+        const float **xData, const float **yData ) const QWT_OVERRIDE;
+
     const QVector<T> &xData() const;
     const QVector<T> &yData() const;
 
@@ -38,6 +69,14 @@ private:
 
 /*!
   \brief Data class containing two pointers to memory blocks of T.
+
+  For T = double or float the memory blocks are offered to QwtPointMapper
+  as contiguous arrays, so that mapping them is not slowed
+  down by calling sample() for each point.
+
+  For x values in increasing order ( f.e. time series ) it is recommended
+  to enable QwtSeriesData::setXSorted(), so that QwtPlotCurve
+  can skip the samples outside of the visible area.
  */
 template <typename T>
 class QwtCPointerData: public QwtPointSeriesData
@@ -48,6 +87,12 @@ public:
     virtual size_t size() const QWT_OVERRIDE;
     virtual QPointF sample( size_t index ) const QWT_OVERRIDE;
 
+    virtual bool contiguousDoubleData(
+        const double **xData, const double **yData ) const QWT_OVERRIDE;
+
+    virtual bool contiguousFloatData(
+        const float **xData, const float **yData ) const QWT_OVERRIDE;
+
     const T *xData() const;
     const T *yData() const;
 
@@ -242,6 +287,32 @@ QPointF QwtPointArrayData<T>::sample( size_t index ) const
     return QPointF( d_x[int( index )], d_y[int( index )] );
 }
 
+/*!
+  \param xData Pointer, where to return the address of the x values
+  \param yData Pointer, where to return the address of the y values
+  \return True, when T is double
+  \sa QwtPointSeriesData::contiguousDoubleData()
+*/
+template <typename T>
+bool QwtPointArrayData<T>::contiguousDoubleData(
+    const double **xData, const double **yData ) const
+{
+    return qwtContiguousData( d_x.constData(), d_y.constData(), xData, yData );
+}
+
+/*!
+  \param xData Pointer, where to return the address of the x values
+  \param yData Pointer, where to return the address of the y values
+  \return True, when T is float
+  \sa QwtPointSeriesData::contiguousFloatData()
+*/
+template <typename T>
+bool QwtPointArrayData<T>::contiguousFloatData(
+    const float **xData, const float **yData ) const
+{
+    return qwtContiguousData( d_x.constData(), d_y.constData(), xData, yData );
+}
+
 //! \return Array of the x-values
 template <typename T>
 const QVector<T> &QwtPointArrayData<T>::xData() const
@@ -351,6 +422,32 @@ QPointF QwtCPointerData<T>::sample( size_t index ) const
     return QPointF( d_x[int( index )], d_y[int( index )] );
 }
 
+/*!
+  \param xData Pointer, where to return the address of the x values
+  \param yData Pointer, where to return the address of the y values
+  \return True, when T is double
+  \sa QwtPointSeriesData::contiguousDoubleData()
+*/
+template <typename T>
+bool QwtCPointerData<T>::contiguousDoubleData(
+    const double **xData, const double **yData ) const
+{
+    return qwtContiguousData( d_x, d_y, xData, yData );
+}
+
+/*!
+  \param xData Pointer, where to return the address of the x values
+  \param yData Pointer, where to return the address of the y values
+  \return True, when T is float
+  \sa QwtPointSeriesData::contiguousFloatData()
+*/
+template <typename T>
+bool QwtCPointerData<T>::contiguousFloatData(
+    const float **xData, const float **yData ) const
+{
+    return qwtContiguousData( d_x, d_y, xData, yData );
+}
+
 //! \return Array of the x-values
 template <typename T>
 const T *QwtCPointerData<T>::xData() const
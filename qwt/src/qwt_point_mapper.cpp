@@ -12,16 +12,20 @@
 #include "qwt_pixel_matrix.h"
 #include "qwt_series_data.h"
 #include "qwt_math.h"
+#include "qwt_render_scheduler.h"
 
 #include <qpolygon.h>
 #include <qimage.h>
 #include <qpen.h>
 #include <qpainter.h>
+#include <qnumeric.h>
 
 #include <qthread.h>
 #include <qfuture.h>
 #include <qtconcurrentrun.h>
 
+#include <algorithm>
+
 #if !defined(QT_NO_QFUTURE)
 #define QWT_USE_THREADS 1
 #endif
@@ -77,6 +81,120 @@ static Qt::Orientation qwtProbeOrientation(
     return Qt::Horizontal;
 }
 
+namespace
+{
+    /*
+        Iterating over the samples block by block, where each block
+        is mapped to paint device coordinates by one call of
+        QwtScaleMap::transform() for all x and all y values. This
+        avoids the virtual calls of the transformation for each value
+        and allows vectorized mapping.
+
+        When the series offers its coordinates as contiguous arrays
+        they are read directly instead of calling sample() for each point.
+     */
+    class QwtMappedSamples
+    {
+    public:
+        enum { BlockSize = 512 };
+
+        inline QwtMappedSamples(
+                const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                const QwtSeriesData<QPointF> *series, int from, int to ):
+            d_xMap( xMap ),
+            d_yMap( yMap ),
+            d_series( series ),
+            d_from( from ),
+            d_to( to ),
+            d_count( 0 ),
+            d_xData( NULL ),
+            d_yData( NULL ),
+            d_xDataF( NULL ),
+            d_yDataF( NULL )
+        {
+            const QwtPointSeriesData *pointData =
+                dynamic_cast< const QwtPointSeriesData * >( series );
+
+            if ( pointData )
+            {
+                if ( !pointData->contiguousDoubleData( &d_xData, &d_yData ) )
+                    pointData->contiguousFloatData( &d_xDataF, &d_yDataF );
+            }
+        }
+
+        // maps the next block, false when all samples have been mapped
+        inline bool next()
+        {
+            d_from += d_count;
+
+            d_count = qMin( d_to - d_from + 1, int( BlockSize ) );
+            if ( d_count <= 0 )
+            {
+                d_count = 0;
+                return false;
+            }
+
+            if ( d_xData )
+            {
+                d_xMap.transform( d_xData + d_from, d_x, d_count );
+                d_yMap.transform( d_yData + d_from, d_y, d_count );
+
+                return true;
+            }
+
+            if ( d_xDataF )
+            {
+                const float *xData = d_xDataF + d_from;
+                const float *yData = d_yDataF + d_from;
+
+                for ( int i = 0; i < d_count; i++ )
+                    d_x[i] = xData[i];
+
+                for ( int i = 0; i < d_count; i++ )
+                    d_y[i] = yData[i];
+            }
+            else
+            {
+                for ( int i = 0; i < d_count; i++ )
+                {
+                    const QPointF sample = d_series->sample( d_from + i );
+
+                    d_x[i] = sample.x();
+                    d_y[i] = sample.y();
+                }
+            }
+
+            d_xMap.transform( d_x, d_x, d_count );
+            d_yMap.transform( d_y, d_y, d_count );
+
+            return true;
+        }
+
+        inline int count() const { return d_count; }
+
+        inline double x( int index ) const { return d_x[index]; }
+        inline double y( int index ) const { return d_y[index]; }
+
+    private:
+        const QwtScaleMap &d_xMap;
+        const QwtScaleMap &d_yMap;
+        const QwtSeriesData<QPointF> *d_series;
+
+        int d_from;
+        const int d_to;
+        int d_count;
+
+        // contiguous coordinates of the series, if available
+        const double *d_xData;
+        const double *d_yData;
+        const float *d_xDataF;
+        const float *d_yDataF;
+
+        double d_x[BlockSize];
+        double d_y[BlockSize];
+    };
+}
+
 namespace
 {
     template <class Polygon, class Point>
@@ -194,17 +312,20 @@ static Polygon qwtMapPointsQuad( const QwtScaleMap &xMap, const QwtScaleMap &yMa
         qwtRoundValue( yMap.transform( sample0.y() ) ) );
 
     Polygon polyline;
-    for ( int i = from; i <= to; i++ )
-    {
-        const QPointF sample = series->sample( i );
-
-        const int x = qwtRoundValue( xMap.transform( sample.x() ) );
-        const int y = qwtRoundValue( yMap.transform( sample.y() ) );
 
-        if ( !q.append( x, y ) )
+    QwtMappedSamples samples( xMap, yMap, series, from, to );
+    while ( samples.next() )
+    {
+        for ( int i = 0; i < samples.count(); i++ )
         {
-            q.flush( polyline );
-            q.start( x, y );
+            const int x = qwtRoundValue( samples.x( i ) );
+            const int y = qwtRoundValue( samples.y( i ) );
+
+            if ( !q.append( x, y ) )
+            {
+                q.flush( polyline );
+                q.start( x, y );
+            }
         }
     }
     q.flush( polyline );
@@ -243,10 +364,148 @@ static Polygon qwtMapPointsQuad( const Polygon &polyline )
     return polylineXY;
 }
 
+static int qwtNumChunks( uint numThreads, int from, int to )
+{
+#if QWT_USE_THREADS
+    if ( numThreads == 0 )
+        numThreads = QThread::idealThreadCount();
+
+    // each thread should have enough points to be worth the overhead
+    const int minChunkSize = 10000;
+
+    const int numChunks = ( to - from + 1 ) / minChunkSize;
+    return qBound( 1, numChunks, int( numThreads ) );
+#else
+    Q_UNUSED( numThreads )
+    Q_UNUSED( from )
+    Q_UNUSED( to )
+
+    return 1;
+#endif
+}
+
+namespace
+{
+    // mapping the chunks of an index range, each into its own polygon
+    template <class Polygon>
+    class QwtMapChunkJob: public QwtRenderJob
+    {
+    public:
+        typedef Polygon ( *MapFunction )( const QwtScaleMap &,
+            const QwtScaleMap &, const QwtSeriesData<QPointF> *, int, int );
+
+        QwtMapChunkJob( MapFunction mapChunk,
+                const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                const QwtSeriesData<QPointF> *series, int from, int to,
+                int numChunks ):
+            d_mapChunk( mapChunk ),
+            d_xMap( xMap ),
+            d_yMap( yMap ),
+            d_series( series ),
+            d_from( from ),
+            d_to( to ),
+            d_chunks( numChunks )
+        {
+            // avoiding, that the threads detach the shared vector
+            d_polygons = d_chunks.data();
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return d_chunks.size();
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            const int chunkSize = ( d_to - d_from + 1 ) / d_chunks.size();
+
+            const int from = d_from + index * chunkSize;
+            const int to = ( index == d_chunks.size() - 1 )
+                ? d_to : from + chunkSize - 1;
+
+            d_polygons[index] = d_mapChunk( d_xMap, d_yMap, d_series, from, to );
+        }
+
+        const QVector<Polygon> &chunks() const
+        {
+            return d_chunks;
+        }
+
+    private:
+        const MapFunction d_mapChunk;
+
+        const QwtScaleMap &d_xMap;
+        const QwtScaleMap &d_yMap;
+        const QwtSeriesData<QPointF> *d_series;
+
+        const int d_from;
+        const int d_to;
+
+        QVector<Polygon> d_chunks;
+        Polygon *d_polygons;
+    };
+}
+
+/*
+    Splitting the index range into chunks, that are mapped in parallel
+    and joining the results. When weedOutJoints is set the first point
+    of a chunk is dropped, when it is at the same position as the last
+    point of the previous chunk - like it happens without chunks.
+    An empty polygon is returned, when the token of the current
+    QwtRenderScheduler::Scope has been cancelled.
+ */
+template <class Polygon>
+static Polygon qwtMapChunked(
+    Polygon ( *mapChunk )( const QwtScaleMap &, const QwtScaleMap &,
+        const QwtSeriesData<QPointF> *, int, int ),
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to,
+    int numChunks, bool weedOutJoints )
+{
+#if QWT_USE_THREADS
+    if ( numChunks > 1 )
+    {
+        QwtMapChunkJob<Polygon> job( mapChunk,
+            xMap, yMap, series, from, to, numChunks );
+
+        if ( !QwtRenderScheduler::run( job, numChunks ) )
+            return Polygon();
+
+        const QVector<Polygon> &chunks = job.chunks();
+
+        Polygon polyline = chunks[0];
+
+        for ( int i = 1; i < chunks.size(); i++ )
+        {
+            const Polygon &chunk = chunks[i];
+
+            int index0 = 0;
+            if ( weedOutJoints && !chunk.isEmpty() && !polyline.isEmpty() )
+            {
+                if ( chunk.first() == polyline.last() )
+                    index0 = 1;
+            }
+
+            const int size = polyline.size();
+            polyline.resize( size + chunk.size() - index0 );
+
+            std::copy( chunk.constData() + index0,
+                chunk.constData() + chunk.size(), polyline.data() + size );
+        }
+
+        return polyline;
+    }
+#else
+    Q_UNUSED( numChunks )
+    Q_UNUSED( weedOutJoints )
+#endif
+
+    return mapChunk( xMap, yMap, series, from, to );
+}
 
 template <class Polygon, class Point>
 static Polygon qwtMapPointsQuad( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
-    const QwtSeriesData<QPointF> *series, int from, int to )
+    const QwtSeriesData<QPointF> *series, int from, int to, int numChunks )
 {
     Polygon polyline;
     if ( from > to )
@@ -258,18 +517,39 @@ static Polygon qwtMapPointsQuad( const QwtScaleMap &xMap, const QwtScaleMap &yMa
      */
     const Qt::Orientation orientation = qwtProbeOrientation( series, from, to );
 
+    /*
+        A sequence of points with the same coordinate might have been
+        split by the chunk boundaries. As the reduction of an already
+        reduced sequence does not change it, we can simply run the
+        first pass again on the joined chunks to merge them.
+     */
+
     if ( orientation == Qt::Horizontal )
     {
-        polyline = qwtMapPointsQuad< Polygon, Point,
-            QwtPolygonQuadrupelY<Polygon, Point> >( xMap, yMap, series, from, to );
+        polyline = qwtMapChunked< Polygon >(
+            qwtMapPointsQuad< Polygon, Point, QwtPolygonQuadrupelY<Polygon, Point> >,
+            xMap, yMap, series, from, to, numChunks, false );
+
+        if ( numChunks > 1 )
+        {
+            polyline = qwtMapPointsQuad< Polygon, Point,
+                QwtPolygonQuadrupelY<Polygon, Point> >( polyline );
+        }
 
         polyline = qwtMapPointsQuad< Polygon, Point,
             QwtPolygonQuadrupelX<Polygon, Point> >( polyline );
     }
     else
     {
-        polyline = qwtMapPointsQuad< Polygon, Point,
-            QwtPolygonQuadrupelX<Polygon, Point> >( xMap, yMap, series, from, to );
+        polyline = qwtMapChunked< Polygon >(
+            qwtMapPointsQuad< Polygon, Point, QwtPolygonQuadrupelX<Polygon, Point> >,
+            xMap, yMap, series, from, to, numChunks, false );
+
+        if ( numChunks > 1 )
+        {
+            polyline = qwtMapPointsQuad< Polygon, Point,
+                QwtPolygonQuadrupelX<Polygon, Point> >( polyline );
+        }
 
         polyline = qwtMapPointsQuad< Polygon, Point,
             QwtPolygonQuadrupelY<Polygon, Point> >( polyline );
@@ -278,6 +558,236 @@ static Polygon qwtMapPointsQuad( const QwtScaleMap &xMap, const QwtScaleMap &yMa
     return polyline;
 }
 
+/*
+    Gaps are indicated by a NaN point for the code, that paints
+    the polyline. As this is not possible for integer coordinates,
+    gaps are ignored for QPolygon.
+ */
+static inline bool qwtHasGaps( const QPolygonF & )
+{
+    return true;
+}
+
+static inline bool qwtHasGaps( const QPolygon & )
+{
+    return false;
+}
+
+static inline int qwtNumGaps( const QPolygonF &polyline )
+{
+    int numGaps = 0;
+
+    const QPointF *points = polyline.constData();
+    for ( int i = 0; i < polyline.size(); i++ )
+    {
+        if ( qIsNaN( points[i].x() ) || qIsNaN( points[i].y() ) )
+            numGaps++;
+    }
+
+    return numGaps;
+}
+
+static inline void qwtAppendGap( QPolygonF &polyline, double x, double y )
+{
+    polyline += QPointF( x, y );
+}
+
+static inline void qwtAppendGap( QPolygon &, double, double )
+{
+}
+
+namespace
+{
+    /*
+        M4 aggregation: a consecutive sequence of points, that is mapped
+        to the same pixel column ( or row ), is reduced to its first,
+        minimum, maximum and last point - in the order of the sequence.
+        So the lines between the remaining points cover the same pixels
+        as the lines between all points.
+
+        Points with NaN coordinates terminate a sequence, when
+        the polyline has floating point coordinates.
+     */
+    template <class Polygon, class Point, class Round>
+    class QwtM4Aggregator
+    {
+    public:
+        inline QwtM4Aggregator( bool columns, Polygon &polyline ):
+            d_columns( columns ),
+            d_polyline( polyline ),
+            d_count( 0 ),
+            d_isGap( false )
+        {
+        }
+
+        inline void append( double x, double y )
+        {
+            if ( x != x || y != y ) // NaN
+            {
+                if ( qwtHasGaps( d_polyline ) && !d_isGap )
+                {
+                    flush();
+
+                    qwtAppendGap( d_polyline, x, y );
+                    d_isGap = true;
+                }
+
+                return;
+            }
+
+            d_isGap = false;
+
+            const double key = qwtRoundValueF( d_columns ? x : y );
+            const double value = d_columns ? y : x;
+
+            if ( d_count > 0 && key == d_key )
+            {
+                if ( value < d_min.value )
+                    d_min.set( x, y, value, d_count );
+                else if ( value > d_max.value )
+                    d_max.set( x, y, value, d_count );
+
+                d_last.set( x, y, value, d_count );
+                d_count++;
+            }
+            else
+            {
+                flush();
+
+                d_key = key;
+                d_first.set( x, y, value, 0 );
+                d_min = d_max = d_last = d_first;
+                d_count = 1;
+            }
+        }
+
+        inline void flush()
+        {
+            if ( d_count == 0 )
+                return;
+
+            appendPoint( d_first );
+
+            const Entry *e1 = &d_min;
+            const Entry *e2 = &d_max;
+            if ( e2->index < e1->index )
+                qSwap( e1, e2 );
+
+            if ( e1->index > 0 && e1->index < d_last.index )
+                appendPoint( *e1 );
+
+            if ( e2->index > e1->index && e2->index < d_last.index )
+                appendPoint( *e2 );
+
+            if ( d_last.index > 0 )
+                appendPoint( d_last );
+
+            d_count = 0;
+        }
+
+    private:
+        class Entry
+        {
+        public:
+            inline void set( double px, double py, double v, int i )
+            {
+                x = px;
+                y = py;
+                value = v;
+                index = i;
+            }
+
+            double x;
+            double y;
+            double value;
+            int index;
+        };
+
+        inline void appendPoint( const Entry &entry )
+        {
+            const Point pos( d_round( entry.x ), d_round( entry.y ) );
+
+            if ( d_polyline.isEmpty() || d_polyline.last() != pos )
+                d_polyline += pos;
+        }
+
+        const bool d_columns;
+        Polygon &d_polyline;
+        Round d_round;
+
+        double d_key;
+        Entry d_first, d_min, d_max, d_last;
+        int d_count;
+
+        bool d_isGap;
+    };
+}
+
+template <class Polygon, class Point, class Round, bool columns>
+static Polygon qwtMapPointsM4( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to )
+{
+    Polygon polyline;
+    QwtM4Aggregator<Polygon, Point, Round> aggregator( columns, polyline );
+
+    QwtMappedSamples samples( xMap, yMap, series, from, to );
+    while ( samples.next() )
+    {
+        for ( int i = 0; i < samples.count(); i++ )
+            aggregator.append( samples.x( i ), samples.y( i ) );
+    }
+    aggregator.flush();
+
+    return polyline;
+}
+
+template <class Polygon, class Point, class Round, bool columns>
+static Polygon qwtMapPointsM4( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to, int numChunks )
+{
+    Polygon polyline = qwtMapChunked< Polygon >(
+        qwtMapPointsM4< Polygon, Point, Round, columns >,
+        xMap, yMap, series, from, to, numChunks, false );
+
+    if ( numChunks > 1 )
+    {
+        /*
+            Aggregating the joined chunks again, to merge the sequences,
+            that have been split by the chunk boundaries. As the
+            first, min, max and last points of a sequence are in
+            the aggregated chunks, the result is the same.
+         */
+
+        const Polygon points = polyline;
+        polyline.clear();
+
+        QwtM4Aggregator<Polygon, Point, Round> aggregator( columns, polyline );
+        for ( int i = 0; i < points.size(); i++ )
+            aggregator.append( points[i].x(), points[i].y() );
+
+        aggregator.flush();
+    }
+
+    return polyline;
+}
+
+template <class Polygon, class Point, class Round>
+static inline Polygon qwtAggregateM4( bool columns,
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to, int numChunks )
+{
+    if ( columns )
+    {
+        return qwtMapPointsM4< Polygon, Point, Round, true >(
+            xMap, yMap, series, from, to, numChunks );
+    }
+    else
+    {
+        return qwtMapPointsM4< Polygon, Point, Round, false >(
+            xMap, yMap, series, from, to, numChunks );
+    }
+}
+
 // Helper class to work around the 5 parameters
 // limitation of QtConcurrent::run()
 class QwtDotsCommand
@@ -302,18 +812,156 @@ static void qwtRenderDots(
     const int x0 = pos.x();
     const int y0 = pos.y();
 
-    for ( int i = command.from; i <= command.to; i++ )
-    {
-        const QPointF sample = command.series->sample( i );
+    QwtMappedSamples samples( xMap, yMap,
+        command.series, command.from, command.to );
 
-        const int x = static_cast<int>( xMap.transform( sample.x() ) + 0.5 ) - x0;
-        const int y = static_cast<int>( yMap.transform( sample.y() ) + 0.5 ) - y0;
+    while ( samples.next() )
+    {
+        for ( int i = 0; i < samples.count(); i++ )
+        {
+            const int x = static_cast<int>( samples.x( i ) + 0.5 ) - x0;
+            const int y = static_cast<int>( samples.y( i ) + 0.5 ) - y0;
 
-        if ( x >= 0 && x < w && y >= 0 && y < h )
-            bits[ y * w + x ] = rgb;
+            if ( x >= 0 && x < w && y >= 0 && y < h )
+                bits[ y * w + x ] = rgb;
+        }
     }
 }
 
+// upper limit for the memory of the counting buffers of all chunks
+static const qint64 qwtDensityBufferBytes = 64 * 1024 * 1024;
+
+namespace
+{
+    /*
+        Counting the points per pixel. Each chunk of points is counted
+        into its own buffer, so that the threads don't need to synchronize.
+     */
+    class QwtDensityJob: public QwtRenderJob
+    {
+    public:
+        QwtDensityJob( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                const QwtSeriesData<QPointF> *series, int from, int to,
+                const QRect &rect, int numChunks ):
+            d_xMap( xMap ),
+            d_yMap( yMap ),
+            d_series( series ),
+            d_from( from ),
+            d_to( to ),
+            d_rect( rect ),
+            d_counts( numChunks )
+        {
+            // avoiding, that the threads detach the shared vector
+            d_buffers = d_counts.data();
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return d_counts.size();
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            const int chunkSize = ( d_to - d_from + 1 ) / d_counts.size();
+
+            const int from = d_from + index * chunkSize;
+            const int to = ( index == d_counts.size() - 1 )
+                ? d_to : from + chunkSize - 1;
+
+            const int w = d_rect.width();
+            const int h = d_rect.height();
+
+            // each buffer is accessed by one thread only
+            QVector<quint32> &counts = d_buffers[index];
+            counts.fill( 0, w * h );
+
+            quint32 *bits = counts.data();
+
+            // shifted by 0.5, so that truncating means rounding
+            const double x0 = d_rect.left() - 0.5;
+            const double y0 = d_rect.top() - 0.5;
+
+            QwtMappedSamples samples( d_xMap, d_yMap, d_series, from, to );
+
+            while ( samples.next() )
+            {
+                for ( int i = 0; i < samples.count(); i++ )
+                {
+                    const double x = samples.x( i ) - x0;
+                    const double y = samples.y( i ) - y0;
+
+                    // also NaNs
+                    if ( x >= 0.0 && x < w && y >= 0.0 && y < h )
+                        bits[ int( y ) * w + int( x ) ]++;
+                }
+            }
+        }
+
+        // summing up the buffers of all chunks in the first one
+        QVector<quint32> merged()
+        {
+            class MergeJob: public QwtRenderJob
+            {
+            public:
+                MergeJob( QVector<quint32> *buffers, int numBuffers ):
+                    d_buffers( buffers ),
+                    d_numBuffers( numBuffers ),
+                    d_size( buffers[0].size() ),
+                    d_sum( buffers[0].data() )
+                {
+                }
+
+                virtual int numTiles() const QWT_OVERRIDE
+                {
+                    return ( d_size + BlockSize - 1 ) / BlockSize;
+                }
+
+                virtual void renderTile( int index ) QWT_OVERRIDE
+                {
+                    const int i0 = index * BlockSize;
+                    const int i1 = qMin( i0 + int( BlockSize ), d_size );
+
+                    for ( int k = 1; k < d_numBuffers; k++ )
+                    {
+                        const quint32 *counts = d_buffers[k].constData();
+
+                        for ( int i = i0; i < i1; i++ )
+                            d_sum[i] += counts[i];
+                    }
+                }
+
+            private:
+                enum { BlockSize = 65536 };
+
+                const QVector<quint32> *d_buffers;
+                const int d_numBuffers;
+                const int d_size;
+                quint32 *d_sum;
+            };
+
+            if ( d_counts.size() > 1 )
+            {
+                MergeJob job( d_buffers, d_counts.size() );
+                QwtRenderScheduler::run( job, d_counts.size() );
+            }
+
+            return d_buffers[0];
+        }
+
+    private:
+        const QwtScaleMap &d_xMap;
+        const QwtScaleMap &d_yMap;
+        const QwtSeriesData<QPointF> *d_series;
+
+        const int d_from;
+        const int d_to;
+        const QRect d_rect;
+
+        QVector< QVector<quint32> > d_counts;
+        QVector<quint32> *d_buffers;
+    };
+}
+
 // some functors, so that the compile can inline
 struct QwtRoundI
 {
@@ -354,25 +1002,28 @@ static inline Polygon qwtToPoints(
 
     int numPoints = 0;
 
+    QwtMappedSamples samples( xMap, yMap, series, from, to );
+
     if ( boundingRect.isValid() )
     {
         // iterating over all values
         // filtering out all points outside of
         // the bounding rectangle
 
-        for ( int i = from; i <= to; i++ )
+        while ( samples.next() )
         {
-            const QPointF sample = series->sample( i );
-
-            const double x = xMap.transform( sample.x() );
-            const double y = yMap.transform( sample.y() );
-
-            if ( boundingRect.contains( x, y ) )
+            for ( int i = 0; i < samples.count(); i++ )
             {
-                points[ numPoints ].rx() = round( x );
-                points[ numPoints ].ry() = round( y );
+                const double x = samples.x( i );
+                const double y = samples.y( i );
 
-                numPoints++;
+                if ( boundingRect.contains( x, y ) )
+                {
+                    points[ numPoints ].rx() = round( x );
+                    points[ numPoints ].ry() = round( y );
+
+                    numPoints++;
+                }
             }
         }
 
@@ -383,17 +1034,15 @@ static inline Polygon qwtToPoints(
         // simply iterating over all values
         // without any filtering
 
-        for ( int i = from; i <= to; i++ )
+        while ( samples.next() )
         {
-            const QPointF sample = series->sample( i );
-
-            const double x = xMap.transform( sample.x() );
-            const double y = yMap.transform( sample.y() );
-
-            points[ numPoints ].rx() = round( x );
-            points[ numPoints ].ry() = round( y );
+            for ( int i = 0; i < samples.count(); i++ )
+            {
+                points[ numPoints ].rx() = round( samples.x( i ) );
+                points[ numPoints ].ry() = round( samples.y( i ) );
 
-            numPoints++;
+                numPoints++;
+            }
         }
     }
 
@@ -444,15 +1093,17 @@ static inline Polygon qwtToPolylineFiltered(
     points[0].ry() = round( yMap.transform( sample0.y() ) );
 
     int pos = 0;
-    for ( int i = from + 1; i <= to; i++ )
-    {
-        const QPointF sample = series->sample( i );
 
-        const Point p( round( xMap.transform( sample.x() ) ),
-            round( yMap.transform( sample.y() ) ) );
+    QwtMappedSamples samples( xMap, yMap, series, from + 1, to );
+    while ( samples.next() )
+    {
+        for ( int i = 0; i < samples.count(); i++ )
+        {
+            const Point p( round( samples.x( i ) ), round( samples.y( i ) ) );
 
-        if ( points[pos] != p )
-            points[++pos] = p;
+            if ( points[pos] != p )
+                points[++pos] = p;
+        }
     }
 
     polyline.resize( pos + 1 );
@@ -478,6 +1129,26 @@ static inline QPolygonF qwtToPolylineFilteredF(
         xMap, yMap, series, from, to, round );
 }
 
+// signatures, that can be used with qwtMapChunked()
+
+template<class Polygon, class Point, class Round>
+static Polygon qwtToPointsChunk(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to )
+{
+    return qwtToPoints<Polygon, Point>(
+        qwtInvalidRect, xMap, yMap, series, from, to, Round() );
+}
+
+template<class Polygon, class Point, class Round>
+static Polygon qwtToPolylineFilteredChunk(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to )
+{
+    return qwtToPolylineFiltered<Polygon, Point>(
+        xMap, yMap, series, from, to, Round() );
+}
+
 template<class Polygon, class Point>
 static inline Polygon qwtToPointsFiltered(
     const QRectF &boundingRect,
@@ -493,19 +1164,22 @@ static inline Polygon qwtToPointsFiltered(
     QwtPixelMatrix pixelMatrix( boundingRect.toAlignedRect() );
 
     int numPoints = 0;
-    for ( int i = from; i <= to; i++ )
-    {
-        const QPointF sample = series->sample( i );
-
-        const int x = qwtRoundValue( xMap.transform( sample.x() ) );
-        const int y = qwtRoundValue( yMap.transform( sample.y() ) );
 
-        if ( pixelMatrix.testAndSetPixel( x, y, true ) == false )
+    QwtMappedSamples samples( xMap, yMap, series, from, to );
+    while ( samples.next() )
+    {
+        for ( int i = 0; i < samples.count(); i++ )
         {
-            points[ numPoints ].rx() = x;
-            points[ numPoints ].ry() = y;
+            const int x = qwtRoundValue( samples.x( i ) );
+            const int y = qwtRoundValue( samples.y( i ) );
+
+            if ( pixelMatrix.testAndSetPixel( x, y, true ) == false )
+            {
+                points[ numPoints ].rx() = x;
+                points[ numPoints ].ry() = y;
 
-            numPoints++;
+                numPoints++;
+            }
         }
     }
 
@@ -535,12 +1209,17 @@ class QwtPointMapper::PrivateData
 {
 public:
     PrivateData():
-        boundingRect( qwtInvalidRect )
+        boundingRect( qwtInvalidRect ),
+        threadCount( 1 ),
+        numEliminatedPoints( 0 )
     {
     }
 
     QRectF boundingRect;
     QwtPointMapper::TransformationFlags flags;
+    uint threadCount;
+
+    int numEliminatedPoints;
 };
 
 //! Constructor
@@ -623,6 +1302,43 @@ QRectF QwtPointMapper::boundingRect() const
     return d_data->boundingRect;
 }
 
+/*!
+  \brief Set the number of threads for mapping polylines
+
+  toPolygonF() and toPolygon() split huge series into chunks,
+  that are mapped and filtered in parallel. The result is the same
+  as without threads.
+
+  \param numThreads Number of threads. If numThreads is set to 0,
+                    the system specific ideal thread count is used.
+                    The default setting is 1.
+
+  \sa threadCount(), QwtPlotItem::setRenderThreadCount()
+ */
+void QwtPointMapper::setThreadCount( uint numThreads )
+{
+    d_data->threadCount = numThreads;
+}
+
+/*!
+  \return Number of threads for mapping polylines
+  \sa setThreadCount()
+ */
+uint QwtPointMapper::threadCount() const
+{
+    return d_data->threadCount;
+}
+
+/*!
+  \return Number of points, that have been filtered out by the
+          last call of toPolygonF(), toPolygon(), toPointsF() or toPoints()
+  \sa setFlags()
+ */
+int QwtPointMapper::numEliminatedPoints() const
+{
+    return d_data->numEliminatedPoints;
+}
+
 /*!
   \brief Translate a series of points into a QPolygonF
 
@@ -636,6 +1352,9 @@ QRectF QwtPointMapper::boundingRect() const
   When RoundPoints & WeedOutIntermediatePoints is enabled an even more
   aggressive weeding algorithm is enabled.
 
+  AggregateColumns or AggregateRows have precedence over the other
+  weeding algorithms.
+
   \param xMap x map
   \param yMap y map
   \param series Series of points to be mapped
@@ -650,38 +1369,69 @@ QPolygonF QwtPointMapper::toPolygonF(
 {
     QPolygonF polyline;
 
+    const int numChunks = qwtNumChunks( d_data->threadCount, from, to );
+
+    if ( d_data->flags & ( AggregateColumns | AggregateRows ) )
+    {
+        const bool columns = d_data->flags & AggregateColumns;
+
+        if ( d_data->flags & RoundPoints )
+        {
+            polyline = qwtAggregateM4<QPolygonF, QPointF, QwtRoundF>(
+                columns, xMap, yMap, series, from, to, numChunks );
+        }
+        else
+        {
+            polyline = qwtAggregateM4<QPolygonF, QPointF, QwtNoRoundF>(
+                columns, xMap, yMap, series, from, to, numChunks );
+        }
+
+        // the gap indicators are no points of the series
+
+        d_data->numEliminatedPoints = qMax( to - from + 1, 0 )
+            - ( polyline.size() - qwtNumGaps( polyline ) );
+
+        return polyline;
+    }
+
     if ( d_data->flags & RoundPoints )
     {
         if ( d_data->flags & WeedOutIntermediatePoints )
         {
             polyline = qwtMapPointsQuad<QPolygonF, QPointF>(
-                xMap, yMap, series, from, to );
+                xMap, yMap, series, from, to, numChunks );
         }
         else if ( d_data->flags & WeedOutPoints )
         {
-            polyline = qwtToPolylineFilteredF(
-                xMap, yMap, series, from, to, QwtRoundF() );
+            polyline = qwtMapChunked<QPolygonF>(
+                qwtToPolylineFilteredChunk<QPolygonF, QPointF, QwtRoundF>,
+                xMap, yMap, series, from, to, numChunks, true );
         }
         else
         {
-            polyline = qwtToPointsF( qwtInvalidRect,
-                xMap, yMap, series, from, to, QwtRoundF() );
+            polyline = qwtMapChunked<QPolygonF>(
+                qwtToPointsChunk<QPolygonF, QPointF, QwtRoundF>,
+                xMap, yMap, series, from, to, numChunks, false );
         }
     }
     else
     {
         if ( d_data->flags & WeedOutPoints )
         {
-            polyline = qwtToPolylineFilteredF(
-                xMap, yMap, series, from, to, QwtNoRoundF() );
+            polyline = qwtMapChunked<QPolygonF>(
+                qwtToPolylineFilteredChunk<QPolygonF, QPointF, QwtNoRoundF>,
+                xMap, yMap, series, from, to, numChunks, true );
         }
         else
         {
-            polyline = qwtToPointsF( qwtInvalidRect,
-                xMap, yMap, series, from, to, QwtNoRoundF() );
+            polyline = qwtMapChunked<QPolygonF>(
+                qwtToPointsChunk<QPolygonF, QPointF, QwtNoRoundF>,
+                xMap, yMap, series, from, to, numChunks, false );
         }
     }
 
+    d_data->numEliminatedPoints = qMax( to - from + 1, 0 ) - polyline.size();
+
     return polyline;
 }
 
@@ -705,23 +1455,35 @@ QPolygon QwtPointMapper::toPolygon(
 {
     QPolygon polyline;
 
-    if ( d_data->flags & WeedOutIntermediatePoints )
+    const int numChunks = qwtNumChunks( d_data->threadCount, from, to );
+
+    if ( d_data->flags & ( AggregateColumns | AggregateRows ) )
+    {
+        polyline = qwtAggregateM4<QPolygon, QPoint, QwtRoundI>(
+            d_data->flags & AggregateColumns,
+            xMap, yMap, series, from, to, numChunks );
+    }
+    else if ( d_data->flags & WeedOutIntermediatePoints )
     {
         // TODO WeedOutIntermediatePointsY ...
         polyline = qwtMapPointsQuad<QPolygon, QPoint>(
-            xMap, yMap, series, from, to );
+            xMap, yMap, series, from, to, numChunks );
     }
     else if ( d_data->flags & WeedOutPoints )
     {
-        polyline = qwtToPolylineFilteredI(
-            xMap, yMap, series, from, to );
+        polyline = qwtMapChunked<QPolygon>(
+            qwtToPolylineFilteredChunk<QPolygon, QPoint, QwtRoundI>,
+            xMap, yMap, series, from, to, numChunks, true );
     }
     else
     {
-        polyline = qwtToPointsI(
-            qwtInvalidRect, xMap, yMap, series, from, to );
+        polyline = qwtMapChunked<QPolygon>(
+            qwtToPointsChunk<QPolygon, QPoint, QwtRoundI>,
+            xMap, yMap, series, from, to, numChunks, false );
     }
 
+    d_data->numEliminatedPoints = qMax( to - from + 1, 0 ) - polyline.size();
+
     return polyline;
 }
 
@@ -804,6 +1566,8 @@ QPolygonF QwtPointMapper::toPointsF(
         }
     }
 
+    d_data->numEliminatedPoints = qMax( to - from + 1, 0 ) - points.size();
+
     return points;
 }
 
@@ -858,6 +1622,8 @@ QPolygon QwtPointMapper::toPoints(
             d_data->boundingRect, xMap, yMap, series, from, to );
     }
 
+    d_data->numEliminatedPoints = qMax( to - from + 1, 0 ) - points.size();
+
     return points;
 }
 
@@ -967,3 +1733,59 @@ QImage QwtPointMapper::toImage(
 
     return image;
 }
+
+/*!
+  \brief Count the points, that are mapped to each pixel
+
+  The pixels are the ones of boundingRect().toAlignedRect().
+  Points are counted for the pixel, that contains their rounded
+  position. Points outside of the bounding rectangle are ignored.
+
+  For large series the points are counted in parallel chunks,
+  each of them into its own buffer. The buffers are added up,
+  when all chunks are done. The number of chunks is limited, so that
+  the buffers of all chunks don't need more than 64MB - at least one
+  buffer is always allocated.
+
+  \param xMap x map
+  \param yMap y map
+  \param series Series of points to be mapped
+  \param from Index of the first point to be counted
+  \param to Index of the last point to be counted
+  \param numThreads Number of threads to be used for counting.
+                   If numThreads is set to 0, the system specific
+                   ideal thread count is used.
+
+  \return Number of points for each pixel, row by row. The vector
+          is empty, when counting has been cancelled
+          ( see QwtRenderScheduler::Scope ).
+
+  \sa QwtPlotCurve::Density, QwtRenderScheduler
+*/
+QVector<quint32> QwtPointMapper::toDensity(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QwtSeriesData<QPointF> *series, int from, int to,
+    uint numThreads ) const
+{
+    const QRect rect = d_data->boundingRect.toAlignedRect();
+    if ( rect.isEmpty() )
+        return QVector<quint32>();
+
+    if ( from > to )
+        return QVector<quint32>( rect.width() * rect.height(), 0 );
+
+    int numChunks = qwtNumChunks( numThreads, from, to );
+
+    // each chunk needs a counter for each pixel
+    const qint64 bufferBytes =
+        qint64( rect.width() ) * rect.height() * sizeof( quint32 );
+
+    numChunks = int( qBound( qint64( 1 ),
+        qwtDensityBufferBytes / bufferBytes, qint64( numChunks ) ) );
+
+    QwtDensityJob job( xMap, yMap, series, from, to, rect, numChunks );
+    if ( !QwtRenderScheduler::run( job, numChunks ) )
+        return QVector<quint32>();
+
+    return job.merged();
+}
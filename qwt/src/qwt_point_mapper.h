@@ -21,6 +21,10 @@ class QPolygon;
 class QPen;
 class QImage;
 
+#if QT_VERSION < 0x060000
+template <typename T> class QVector;
+#endif
+
 /*!
   \brief A helper class for translating a series of points
 
@@ -65,7 +69,38 @@ public:
           As the algorithm is fast it can be used inside of
           a polyline render cycle.
          */
-        WeedOutIntermediatePoints = 0x04
+        WeedOutIntermediatePoints = 0x04,
+
+        /*!
+          M4 aggregation for polylines, where x is the independent variable
+          ( f.e. time series ).
+
+          A consecutive chunk of points being mapped to the
+          same pixel column is reduced to the first point, the points
+          with the minimum and maximum y coordinate and the last point.
+          In opposite to WeedOutIntermediatePoints these points are kept
+          in their original order, so that the lines cover exactly
+          the same pixels as without aggregation.
+
+          In toPolygonF() points with NaN coordinates separate the chunks
+          and one NaN point is kept to indicate the gap. As this is not
+          possible with integer coordinates, toPolygon() drops them.
+          The gap indicators are not counted by numEliminatedPoints().
+
+          The number of points will be 4 times the width at most.
+          As the aggregation does not depend on how the lines between
+          the points are drawn, it can also be used for step curves.
+
+          \sa numEliminatedPoints()
+         */
+        AggregateColumns = 0x08,
+
+        /*!
+          The same as AggregateColumns, but for polylines, where y
+          is the independent variable, reducing the points being mapped
+          to the same pixel row.
+         */
+        AggregateRows = 0x10
     };
 
     /*!
@@ -86,6 +121,11 @@ public:
     void setBoundingRect( const QRectF & );
     QRectF boundingRect() const;
 
+    void setThreadCount( uint numThreads );
+    uint threadCount() const;
+
+    int numEliminatedPoints() const;
+
     QPolygonF toPolygonF( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
         const QwtSeriesData<QPointF> *series, int from, int to ) const;
 
@@ -102,6 +142,10 @@ public:
         const QwtSeriesData<QPointF> *series, int from, int to,
         const QPen &, bool antialiased, uint numThreads ) const;
 
+    QVector<quint32> toDensity( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QwtSeriesData<QPointF> *series, int from, int to,
+        uint numThreads ) const;
+
 private:
     Q_DISABLE_COPY(QwtPointMapper)
 
@@ -14,23 +14,61 @@
 #include "qwt_raster_data.h"
 #include "qwt_math.h"
 #include "qwt_clipper.h"
+#include "qwt_render_scheduler.h"
 
 #include <qpainter.h>
 #include <qpainterpath.h>
+#include <qvector.h>
 #include <qthread.h>
-#include <qfuture.h>
-#include <qtconcurrentrun.h>
 
 #if QT_VERSION < 0x050000
 #include <qnumeric.h>
 #endif
 
-class QwtPolarSpectrogram::TileInfo
+// the horizontal strips of an image, that are passed to renderTile()
+class QwtPolarSpectrogram::TileJob: public QwtRenderJob
 {
 public:
-    QPoint imagePos;
-    QRect rect;
-    QImage *image;
+    TileJob( const QwtPolarSpectrogram *spectrogram,
+            const QwtScaleMap &azimuthMap, const QwtScaleMap &radialMap,
+            const QPointF &pole, const QRect &rect, QImage *image ):
+        d_spectrogram( spectrogram ),
+        d_azimuthMap( azimuthMap ),
+        d_radialMap( radialMap ),
+        d_pole( pole ),
+        d_rect( rect ),
+        d_image( image )
+    {
+    }
+
+    virtual int numTiles() const QWT_OVERRIDE
+    {
+        return tiles.size();
+    }
+
+    virtual void renderTile( int index ) QWT_OVERRIDE
+    {
+        d_spectrogram->renderTile( d_azimuthMap, d_radialMap, d_pole,
+            d_rect.topLeft(), tiles[index], d_image );
+    }
+
+    virtual double tilePriority( int index ) const QWT_OVERRIDE
+    {
+        // the strips in the center of the image first
+        return -qAbs( tiles[index].center().y() - d_rect.center().y() );
+    }
+
+    QVector< QRect > tiles;
+
+private:
+    const QwtPolarSpectrogram *d_spectrogram;
+
+    const QwtScaleMap d_azimuthMap;
+    const QwtScaleMap d_radialMap;
+    const QPointF d_pole;
+
+    const QRect d_rect;
+    QImage *d_image;
 };
 
 class QwtPolarSpectrogram::PrivateData
@@ -229,6 +267,11 @@ void QwtPolarSpectrogram::draw( QPainter *painter,
    \return A QImage::Format_Indexed8 or QImage::Format_ARGB32 depending
            on the color map.
 
+   \note The image is rendered synchronously and the item does not
+         assign a render token itself. The image remains incomplete only,
+         when the token of a QwtRenderScheduler::Scope of the caller has
+         been cancelled.
+
    \sa QwtRasterData::intensity(), QwtColorMap::rgb(),
        QwtColorMap::colorIndex()
 */
@@ -258,77 +301,39 @@ QImage QwtPolarSpectrogram::renderImage(
     d_data->data->initRaster( QRectF(), QSize() );
 
 
-#if !defined(QT_NO_QFUTURE)
-    uint numThreads = renderThreadCount();
+    /*
+        The image is split into more strips than threads, so that
+        the load is balanced. Because of the polar coordinates the
+        costs of the pixels differ.
+     */
 
+    int numThreads = int( renderThreadCount() );
     if ( numThreads <= 0 )
         numThreads = QThread::idealThreadCount();
 
-    if ( numThreads <= 0 )
-        numThreads = 1;
-
-    const int numRows = rect.height() / numThreads;
+    const int numStrips = qBound( 1, 4 * numThreads, rect.height() );
+    const int stripHeight = qMax( qwtCeil( double( rect.height() ) / numStrips ), 1 );
 
+    TileJob job( this, azimuthMap, radialMap, pole, rect, &image );
 
-    QVector<TileInfo> tileInfos;
-    for ( uint i = 0; i < numThreads; i++ )
+    for ( int y = rect.top(); y <= rect.bottom(); y += stripHeight )
     {
-        QRect tile( rect.x(), rect.y() + i * numRows, rect.width(), numRows );
-        if ( i == numThreads - 1 )
-            tile.setHeight( rect.height() - i * numRows );
-
-        TileInfo tileInfo;
-        tileInfo.imagePos = rect.topLeft();
-        tileInfo.rect = tile;
-        tileInfo.image = &image;
-
-        tileInfos += tileInfo;
-    }
-
-    QVector< QFuture<void> > futures;
-    for ( int i = 0; i < tileInfos.size(); i++ )
-    {
-        if ( i == tileInfos.size() - 1 )
-        {
-            renderTileInfo( azimuthMap, radialMap, pole, &tileInfos[i] );
-        }
-        else
-        {
-            futures += QtConcurrent::run(
-#if QT_VERSION >= 0x060000
-                &QwtPolarSpectrogram::renderTileInfo, this,
-#else
-                this, &QwtPolarSpectrogram::renderTileInfo,
-#endif
-                azimuthMap, radialMap, pole, &tileInfos[i] );
-        }
+        job.tiles += QRect( rect.left(), y, rect.width(),
+            qMin( stripHeight, rect.bottom() - y + 1 ) );
     }
 
-    for ( int i = 0; i < futures.size(); i++ )
-        futures[i].waitForFinished();
-
-#else
-    renderTile( azimuthMap, radialMap, pole, rect.topLeft(), rect, &image );
-#endif
+    QwtRenderScheduler::run( job, renderThreadCount() );
 
     d_data->data->discardRaster();
 
     return image;
 }
 
-void QwtPolarSpectrogram::renderTileInfo(
-    const QwtScaleMap &azimuthMap, const QwtScaleMap &radialMap,
-    const QPointF &pole, TileInfo *tileInfo ) const
-{
-    renderTile( azimuthMap, radialMap, pole,
-        tileInfo->imagePos, tileInfo->rect, tileInfo->image );
-}
-
 /*!
   \brief Render a sub-rectangle of an image 
 
   renderTile() is called by renderImage() to render different parts
-  of the image by concurrent threads.
+  of the image by concurrent threads ( see QwtRenderScheduler ).
 
   \param azimuthMap Maps azimuth values to values related to 0.0, M_2PI
   \param radialMap Maps radius values into painter coordinates.
@@ -337,6 +342,9 @@ void QwtPolarSpectrogram::renderTileInfo(
   \param tile Sub-rectangle of the tile in painter coordinates
   \param image Image to be rendered
 
+   Rendering is stopped between the rows, when the token of the current
+   QwtRenderScheduler::Scope has been cancelled.
+
    \sa setRenderThreadCount()
    \note renderTile needs to be reentrant
 */
@@ -363,6 +371,10 @@ void QwtPolarSpectrogram::renderTile(
     {
         for ( int y = y1; y <= y2; y++ )
         {
+            // the image is not needed anymore
+            if ( QwtRenderScheduler::isCancelled() )
+                return;
+
             const double dy = pole.y() - y;
             const double dy2 = qwtSqr( dy );
 
@@ -402,6 +414,10 @@ void QwtPolarSpectrogram::renderTile(
     {
         for ( int y = y1; y <= y2; y++ )
         {
+            // the image is not needed anymore
+            if ( QwtRenderScheduler::isCancelled() )
+                return;
+
             const double dy = pole.y() - y;
             const double dy2 = qwtSqr( dy );
 
@@ -79,9 +79,7 @@ protected:
         const QRect &tile, QImage *image ) const;
 
 private:
-    class TileInfo;
-    void renderTileInfo( const QwtScaleMap &, const QwtScaleMap &,
-        const QPointF &pole, TileInfo * ) const;
+    class TileJob;
 
     class PrivateData;
     PrivateData *d_data;
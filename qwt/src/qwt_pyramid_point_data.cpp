@@ -0,0 +1,628 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_pyramid_point_data.h"
+#include "qwt_interval.h"
+#include "qwt_scale_map.h"
+#include "qwt_math.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    /*
+        Each node of the pyramid stores the positions of the
+        minimum and maximum of a chunk of consecutive samples.
+     */
+    class QwtPyramidNode
+    {
+    public:
+        int minIndex;
+        int maxIndex;
+    };
+}
+
+// number of samples aggregated by a node of the lowest level
+static const int qwtLeafSize = 8;
+
+/*
+    The pixel column of a value, rounded in the same way as
+    QwtPointMapper::AggregateColumns does
+ */
+static inline double qwtColumn( const QwtScaleMap &map, double value )
+{
+    const double pos = map.transform( value );
+    return ( pos >= 0.0 ) ? std::floor( pos + 0.5 ) : std::ceil( pos - 0.5 );
+}
+
+static inline bool qwtIsEqualMap( const QwtScaleMap &map1, const QwtScaleMap &map2 )
+{
+    if ( map1.s1() != map2.s1() || map1.s2() != map2.s2()
+        || map1.p1() != map2.p1() || map1.p2() != map2.p2() )
+    {
+        return false;
+    }
+
+    // detecting a different transformation
+
+    const double s = 0.5 * ( map1.s1() + map1.s2() );
+    return map1.transform( s ) == map2.transform( s );
+}
+
+class QwtPyramidPointData::PrivateData
+{
+public:
+    PrivateData():
+        resolution( 0 ),
+        hasXMap( false ),
+        isXSorted( false ),
+        isReduced( false )
+    {
+    }
+
+    inline void merge( const QwtPyramidNode &node,
+        int &minIndex, int &maxIndex ) const
+    {
+        const double *yValues = y.constData();
+
+        if ( yValues[ node.minIndex ] < yValues[ minIndex ] )
+            minIndex = node.minIndex;
+
+        if ( yValues[ node.maxIndex ] > yValues[ maxIndex ] )
+            maxIndex = node.maxIndex;
+    }
+
+    inline void scan( int from, int to,
+        int &minIndex, int &maxIndex ) const
+    {
+        const double *yValues = y.constData();
+
+        for ( int i = from; i <= to; i++ )
+        {
+            if ( yValues[i] < yValues[ minIndex ] )
+                minIndex = i;
+
+            if ( yValues[i] > yValues[ maxIndex ] )
+                maxIndex = i;
+        }
+    }
+
+    void rangeMinMax( int from, int to,
+        int &minIndex, int &maxIndex ) const;
+
+    bool reduce( const QwtScaleMap *map, int numColumns,
+        QVector<int> &indexes ) const;
+
+    QVector<double> x;
+    QVector<double> y;
+
+    QVector< QVector<QwtPyramidNode> > levels;
+
+    int resolution;
+
+    bool hasXMap;
+    QwtScaleMap xMap;
+
+    bool isXSorted;
+
+    QRectF rectOfInterest;
+
+    bool isReduced;
+    QVector<int> reducedIndexes;
+};
+
+/*
+    Find the positions of the minimum/maximum in [from, to]
+    using the nodes of the pyramid for all complete chunks
+    and the samples only for the incomplete chunks at the borders.
+ */
+void QwtPyramidPointData::PrivateData::rangeMinMax(
+    int from, int to, int &minIndex, int &maxIndex ) const
+{
+    minIndex = maxIndex = from;
+
+    int n1 = ( from + qwtLeafSize - 1 ) / qwtLeafSize;
+    int n2 = ( to + 1 ) / qwtLeafSize;
+
+    if ( n1 >= n2 || levels.isEmpty() )
+    {
+        scan( from, to, minIndex, maxIndex );
+        return;
+    }
+
+    scan( from, n1 * qwtLeafSize - 1, minIndex, maxIndex );
+    scan( n2 * qwtLeafSize, to, minIndex, maxIndex );
+
+    for ( int level = 0; n1 < n2; level++ )
+    {
+        const QwtPyramidNode *nodes = levels[level].constData();
+
+        if ( n1 & 1 )
+            merge( nodes[ n1++ ], minIndex, maxIndex );
+
+        if ( n2 & 1 )
+            merge( nodes[ --n2 ], minIndex, maxIndex );
+
+        n1 >>= 1;
+        n2 >>= 1;
+    }
+}
+
+/*!
+  Constructor
+
+  \param x Array of x values
+  \param y Array of y values
+
+  \note The pyramid is built in the constructor by iterating
+        once over all samples.
+
+  \sa QwtPlotCurve::setData()
+*/
+QwtPyramidPointData::QwtPyramidPointData(
+    const QVector<double> &x, const QVector<double> &y )
+{
+    d_data = new PrivateData();
+    d_data->x = x;
+    d_data->y = y;
+
+    buildPyramid();
+}
+
+/*!
+  Constructor
+
+  \param x Array of x values
+  \param y Array of y values
+  \param size Size of the x and y arrays
+
+  \sa QwtPlotCurve::setData()
+*/
+QwtPyramidPointData::QwtPyramidPointData(
+    const double *x, const double *y, size_t size )
+{
+    d_data = new PrivateData();
+
+    d_data->x.resize( size );
+    std::memcpy( d_data->x.data(), x, size * sizeof( double ) );
+
+    d_data->y.resize( size );
+    std::memcpy( d_data->y.data(), y, size * sizeof( double ) );
+
+    buildPyramid();
+}
+
+//! Destructor
+QwtPyramidPointData::~QwtPyramidPointData()
+{
+    delete d_data;
+}
+
+/*!
+  \brief Set the resolution for the reduced series
+
+  The resolution is the number of pixel columns, where the
+  "rectangle of interest" is mapped to linearly. A map, that has been
+  assigned by setXScaleMap() before, is discarded.
+
+  \param numColumns Number of pixel columns. A value <= 0 disables
+                    the levels of detail.
+
+  \sa resolution(), setXScaleMap(), setRectOfInterest()
+*/
+void QwtPyramidPointData::setResolution( int numColumns )
+{
+    numColumns = qMax( numColumns, 0 );
+
+    if ( numColumns != d_data->resolution || d_data->hasXMap )
+    {
+        d_data->resolution = numColumns;
+        d_data->hasXMap = false;
+
+        updateSamples();
+    }
+}
+
+/*!
+  \return Number of pixel columns
+  \sa setResolution(), setXScaleMap()
+*/
+int QwtPyramidPointData::resolution() const
+{
+    return d_data->resolution;
+}
+
+/*!
+  \brief Assign the map, that is used to map the x values to pixel columns
+
+  The reduced series is calculated for the pixel columns of the map,
+  so that it is exact for painting with this map - f.e for
+  non linear scales. The resolution is set to the width of the
+  paint interval.
+
+  QwtPlotCurve assigns the map of its x axis, whenever the scales
+  or the geometry of the canvas have been changed.
+
+  \param xMap Maps x values into pixel coordinates
+  \sa setResolution(), QwtPlotCurve::updateScaleDiv()
+*/
+void QwtPyramidPointData::setXScaleMap( const QwtScaleMap &xMap )
+{
+    if ( d_data->hasXMap && qwtIsEqualMap( xMap, d_data->xMap ) )
+        return;
+
+    d_data->hasXMap = true;
+    d_data->xMap = xMap;
+    d_data->resolution = qwtCeil( qAbs( xMap.pDist() ) );
+
+    updateSamples();
+}
+
+/*!
+  \brief Check if the reduced series fits to a map
+
+  \param xMap Maps x values into pixel coordinates
+  \return true, when the reduced series has been calculated for xMap,
+          or when the series can't be reduced at all
+
+  \sa setXScaleMap(), reducedSamples()
+*/
+bool QwtPyramidPointData::isReducedFor( const QwtScaleMap &xMap ) const
+{
+    if ( !d_data->isReduced )
+        return true;
+
+    return d_data->hasXMap && qwtIsEqualMap( xMap, d_data->xMap );
+}
+
+/*!
+  \brief Calculate a reduced series for a map
+
+  In opposite to setXScaleMap() the object remains unchanged, so that
+  the series can be reduced for painting to a different paint device
+  - f.e. a printer - without affecting the series on the canvas.
+
+  \param xMap Maps x values into pixel coordinates
+  \return Points of the series reduced for the pixel columns of xMap
+          and the "rectangle of interest". When the series can't be
+          reduced all samples are returned.
+
+  \sa isReducedFor(), setXScaleMap()
+*/
+QVector<QPointF> QwtPyramidPointData::reducedSamples(
+    const QwtScaleMap &xMap ) const
+{
+    QVector<int> indexes;
+
+    const bool isReduced = d_data->reduce(
+        &xMap, qwtCeil( qAbs( xMap.pDist() ) ), indexes );
+
+    const int numSamples = isReduced
+        ? indexes.size() : qMin( d_data->x.size(), d_data->y.size() );
+
+    QVector<QPointF> points( numSamples );
+    for ( int i = 0; i < numSamples; i++ )
+    {
+        const int index = isReduced ? indexes[i] : i;
+        points[i] = QPointF( d_data->x[index], d_data->y[index] );
+    }
+
+    return points;
+}
+
+/*!
+   Set a the "rectangle of interest"
+
+   QwtPlotSeriesItem defines the current area of the plot canvas
+   as "rect of interest" ( QwtPlotSeriesItem::updateScaleDiv() ).
+
+   The samples inside of rect.left() -> rect.right() - and one
+   sample on each side, so that the line to the border is not lost -
+   are reduced according to resolution().
+
+   \sa rectOfInterest(), setResolution()
+*/
+void QwtPyramidPointData::setRectOfInterest( const QRectF &rect )
+{
+    if ( rect != d_data->rectOfInterest )
+    {
+        d_data->rectOfInterest = rect;
+        updateSamples();
+    }
+}
+
+/*!
+   \return "rectangle of interest"
+   \sa setRectOfInterest()
+*/
+QRectF QwtPyramidPointData::rectOfInterest() const
+{
+    return d_data->rectOfInterest;
+}
+
+/*!
+  \return Number of points of the reduced series, or the
+          number of samples, when there is no reduced series.
+*/
+size_t QwtPyramidPointData::size() const
+{
+    if ( d_data->isReduced )
+        return d_data->reducedIndexes.size();
+
+    return qMin( d_data->x.size(), d_data->y.size() );
+}
+
+/*!
+  Return the sample at position i
+
+  \param index Index
+  \return Sample at position i of the reduced series,
+          or of the original samples, when there is no reduced series.
+*/
+QPointF QwtPyramidPointData::sample( size_t index ) const
+{
+    int i = int( index );
+    if ( d_data->isReduced )
+        i = d_data->reducedIndexes[i];
+
+    return QPointF( d_data->x[i], d_data->y[i] );
+}
+
+/*!
+  \brief Translate an index of the reduced series
+
+  \param index Index of the reduced series, f.e. returned
+               from QwtPlotCurve::closestPoint()
+  \return Position of the sample in xData() and yData()
+
+  \sa size(), sample()
+*/
+size_t QwtPyramidPointData::sourceIndex( size_t index ) const
+{
+    if ( d_data->isReduced )
+        return d_data->reducedIndexes[ int( index ) ];
+
+    return index;
+}
+
+/*!
+  \brief Calculate the bounding rectangle
+
+  The bounding rectangle is calculated once, when building the
+  pyramid. It is always the bounding rectangle of the original samples.
+
+  \return Bounding rectangle
+*/
+QRectF QwtPyramidPointData::boundingRect() const
+{
+    return d_boundingRect;
+}
+
+//! \return Number of levels of the pyramid
+int QwtPyramidPointData::numLevels() const
+{
+    return d_data->levels.size();
+}
+
+//! \return Array of the x-values
+const QVector<double> &QwtPyramidPointData::xData() const
+{
+    return d_data->x;
+}
+
+//! \return Array of the y-values
+const QVector<double> &QwtPyramidPointData::yData() const
+{
+    return d_data->y;
+}
+
+void QwtPyramidPointData::buildPyramid()
+{
+    d_data->levels.clear();
+    d_data->isReduced = false;
+    d_data->reducedIndexes.clear();
+
+    const int numSamples = qMin( d_data->x.size(), d_data->y.size() );
+    if ( numSamples <= 0 )
+    {
+        d_data->isXSorted = false;
+        setXSorted( false );
+
+        d_boundingRect = QRectF( 1.0, 1.0, -2.0, -2.0 ); // invalid
+
+        return;
+    }
+
+    const double *x = d_data->x.constData();
+    const double *y = d_data->y.constData();
+
+    // checking the order of the x values and the x bounds
+
+    bool isXSorted = true;
+
+    double minX = x[0];
+    double maxX = x[0];
+
+    for ( int i = 1; i < numSamples; i++ )
+    {
+        if ( !( x[i] >= x[i - 1] ) )
+            isXSorted = false;
+
+        if ( x[i] < minX )
+            minX = x[i];
+
+        if ( x[i] > maxX )
+            maxX = x[i];
+    }
+
+    d_data->isXSorted = isXSorted;
+    setXSorted( isXSorted );
+
+    // the lowest level is calculated from the samples
+
+    QVector<QwtPyramidNode> nodes(
+        ( numSamples + qwtLeafSize - 1 ) / qwtLeafSize );
+
+    for ( int i = 0; i < nodes.size(); i++ )
+    {
+        const int from = i * qwtLeafSize;
+        const int to = qMin( from + qwtLeafSize, numSamples ) - 1;
+
+        QwtPyramidNode &node = nodes[i];
+        node.minIndex = node.maxIndex = from;
+
+        d_data->scan( from, to, node.minIndex, node.maxIndex );
+    }
+
+    d_data->levels.append( nodes );
+
+    // each other level is calculated from the level below
+
+    while ( d_data->levels.last().size() > 1 )
+    {
+        const QVector<QwtPyramidNode> lower = d_data->levels.last();
+
+        QVector<QwtPyramidNode> upper( ( lower.size() + 1 ) / 2 );
+        for ( int i = 0; i < upper.size(); i++ )
+        {
+            QwtPyramidNode &node = upper[i];
+            node = lower[ 2 * i ];
+
+            if ( 2 * i + 1 < lower.size() )
+            {
+                d_data->merge( lower[ 2 * i + 1 ],
+                    node.minIndex, node.maxIndex );
+            }
+        }
+
+        d_data->levels.append( upper );
+    }
+
+    const QwtPyramidNode &top = d_data->levels.last()[0];
+
+    const double minY = y[ top.minIndex ];
+    const double maxY = y[ top.maxIndex ];
+
+    d_boundingRect = QRectF( minX, minY, maxX - minX, maxY - minY );
+
+    updateSamples();
+}
+
+void QwtPyramidPointData::updateSamples()
+{
+    incrementRevision();
+
+    d_data->reducedIndexes.clear();
+    d_data->isReduced = d_data->reduce(
+        d_data->hasXMap ? &d_data->xMap : NULL,
+        d_data->resolution, d_data->reducedIndexes );
+}
+
+/*
+    Calculate the positions of the reduced series for the
+    "rectangle of interest". Without a map the interval of the
+    rectangle is mapped linearly to numColumns pixel columns.
+ */
+bool QwtPyramidPointData::PrivateData::reduce( const QwtScaleMap *xMap,
+    int numColumns, QVector<int> &indexes ) const
+{
+    const int numSamples = qMin( x.size(), y.size() );
+
+    const QwtInterval interval = QwtInterval( rectOfInterest.left(),
+        rectOfInterest.right() ).normalized();
+
+    if ( numSamples <= 0 || !isXSorted
+        || numColumns <= 0 || !( interval.width() > 0.0 ) )
+    {
+        return false;
+    }
+
+    const double *xValues = x.constData();
+
+    // the visible range including one sample on each side
+
+    int from = int( std::lower_bound( xValues, xValues + numSamples,
+        interval.minValue() ) - xValues ) - 1;
+
+    int to = int( std::upper_bound( xValues, xValues + numSamples,
+        interval.maxValue() ) - xValues );
+
+    from = qBound( 0, from, numSamples - 1 );
+    to = qBound( 0, to, numSamples - 1 );
+
+    const int numVisible = to - from + 1;
+    if ( numVisible <= 4 * ( numColumns + 1 ) )
+    {
+        // not enough samples to gain anything from reducing
+
+        indexes.resize( numVisible );
+        for ( int i = 0; i < numVisible; i++ )
+            indexes[i] = from + i;
+
+        return true;
+    }
+
+    QwtScaleMap map;
+    if ( xMap )
+    {
+        map = *xMap;
+    }
+    else
+    {
+        map.setScaleInterval( interval.minValue(), interval.maxValue() );
+        map.setPaintInterval( 0.0, numColumns );
+    }
+
+    indexes.reserve( 4 * ( numColumns + 3 ) );
+
+    for ( int i1 = from; i1 <= to; )
+    {
+        /*
+            As the x values are sorted, all samples of the same
+            pixel column are in a consecutive range, that ends
+            before the first sample of another column.
+         */
+
+        const double column = qwtColumn( map, xValues[i1] );
+
+        int lower = i1 + 1;
+        int upper = to + 1;
+
+        while ( lower < upper )
+        {
+            const int mid = lower + ( upper - lower ) / 2;
+
+            if ( qwtColumn( map, xValues[mid] ) == column )
+                lower = mid + 1;
+            else
+                upper = mid;
+        }
+
+        const int i2 = lower - 1;
+
+        int minIndex, maxIndex;
+        rangeMinMax( i1, i2, minIndex, maxIndex );
+
+        if ( minIndex > maxIndex )
+            qSwap( minIndex, maxIndex );
+
+        const int columnIndexes[] = { i1, minIndex, maxIndex, i2 };
+        for ( int j = 0; j < 4; j++ )
+        {
+            const int index = columnIndexes[j];
+            if ( indexes.isEmpty() || indexes.last() != index )
+                indexes += index;
+        }
+
+        i1 = i2 + 1;
+    }
+
+    return true;
+}
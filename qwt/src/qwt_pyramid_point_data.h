@@ -0,0 +1,99 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_PYRAMID_POINT_DATA_H
+#define QWT_PYRAMID_POINT_DATA_H
+
+#include "qwt_global.h"
+#include "qwt_series_data.h"
+
+class QwtScaleMap;
+
+/*!
+  \brief Point data with levels of detail for huge time series
+
+  QwtPyramidPointData stores two arrays of x and y values and builds
+  a multi-resolution pyramid of minimum/maximum values on top of them.
+  Each level of the pyramid aggregates twice as many consecutive samples
+  as the level below.
+
+  When a "rectangle of interest" and the pixel columns ( see setXScaleMap()
+  or setResolution() ) have been assigned, size() and sample() do not return
+  the original samples, but a reduced series: the visible samples, that
+  are mapped to the same pixel column, are represented by their first,
+  minimum, maximum and last sample. So the reduced series has at most
+  4 points per pixel column, no matter how many samples are in the
+  visible range. As the columns are the same as for
+  QwtPointMapper::AggregateColumns, the lines between the reduced
+  points cover the same pixels as the lines between all samples.
+
+  The reduced series is calculated in O(resolution * log(n)),
+  what makes zooming and panning independent of the size of the series.
+
+  QwtPlotCurve assigns the map of its x axis in QwtPlotCurve::updateScaleDiv(),
+  that is also called, when the canvas has been resized. When rendering
+  to a different paint device QwtPlotCurve paints a series, that has been
+  reduced by reducedSamples() for this paint operation only.
+
+  \warning As size() and sample() refer to the reduced series, the indices
+           returned by QwtPlotCurve::closestPoint() or
+           QwtPlotCurve::sampleIndices() are indices of the reduced series.
+           They can be translated into positions of xData() and yData()
+           by sourceIndex().
+
+  \note The levels of detail are only available for series with
+        increasing x values ( f.e. time series ). For all other
+        series the original samples are returned. The order is
+        detected, when building the pyramid, and indicated by
+        QwtSeriesData::isXSorted().
+  \note The minimum/maximum values are calculated for the y coordinates,
+        what matches the default orientation ( Qt::Vertical )
+        of QwtPlotCurve.
+
+  \sa QwtSyntheticPointData, QwtPlotCurve::setSamples()
+*/
+class QWT_EXPORT QwtPyramidPointData: public QwtSeriesData<QPointF>
+{
+public:
+    QwtPyramidPointData( const QVector<double> &x, const QVector<double> &y );
+    QwtPyramidPointData( const double *x, const double *y, size_t size );
+
+    virtual ~QwtPyramidPointData();
+
+    void setResolution( int numColumns );
+    int resolution() const;
+
+    void setXScaleMap( const QwtScaleMap & );
+
+    bool isReducedFor( const QwtScaleMap & ) const;
+    QVector<QPointF> reducedSamples( const QwtScaleMap & ) const;
+
+    virtual void setRectOfInterest( const QRectF & ) QWT_OVERRIDE;
+    QRectF rectOfInterest() const;
+
+    virtual size_t size() const QWT_OVERRIDE;
+    virtual QPointF sample( size_t index ) const QWT_OVERRIDE;
+    virtual QRectF boundingRect() const QWT_OVERRIDE;
+
+    size_t sourceIndex( size_t index ) const;
+
+    int numLevels() const;
+
+    const QVector<double> &xData() const;
+    const QVector<double> &yData() const;
+
+private:
+    void buildPyramid();
+    void updateSamples();
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
@@ -10,12 +10,17 @@
 #include "qwt_raster_data.h"
 #include "qwt_point_3d.h"
 #include "qwt_interval.h"
+#include "qwt_render_scheduler.h"
 
 #include <qrect.h>
 #include <qpolygon.h>
 #include <qnumeric.h>
 #include <qlist.h>
 #include <qmap.h>
+#include <qvector.h>
+#include <qthread.h>
+
+#include <algorithm>
 
 class QwtRasterData::ContourPlane
 {
@@ -161,6 +166,387 @@ inline QPointF QwtRasterData::ContourPlane::intersection(
     return QPointF( x, y );
 }
 
+namespace
+{
+    /*
+        The values of the raster, sampled once for all levels
+     */
+    class QwtContourGrid
+    {
+    public:
+        inline double value( int i, int j ) const
+        {
+            return values[ j * width + i ];
+        }
+
+        int width;
+        int height;
+
+        double x0;
+        double y0;
+        double dx;
+        double dy;
+
+        QVector<double> values;
+    };
+
+    /*
+        A line segment of a contour line inside of a cell. The
+        end points are on the edges of the cell, that are identified
+        by ids, that are unique for the grid.
+     */
+    class QwtContourSegment
+    {
+    public:
+        QPointF points[2];
+        qint64 edges[2];
+    };
+
+    class QwtContourEnd
+    {
+    public:
+        inline bool operator<( const QwtContourEnd &other ) const
+        {
+            return edge < other.edge;
+        }
+
+        qint64 edge;
+        int slot; // 2 * segment + end
+    };
+
+    // calculating the segments for a range of rows
+    class QwtContourJob
+    {
+    public:
+        const QwtContourGrid *grid;
+        const QVector<double> *levels;
+
+        bool ignoreOutOfRange;
+        QwtInterval range;
+
+        int from;
+        int to;
+
+        // segments for each level
+        QVector< QVector<QwtContourSegment> > segments;
+    };
+}
+
+static void qwtSampleRows( const QwtRasterData *data,
+    QwtContourGrid *grid, int from, int to )
+{
+    QVector<double> x( grid->width );
+    for ( int i = 0; i < grid->width; i++ )
+        x[i] = grid->x0 + i * grid->dx;
+
+    QVector<double> y( to - from );
+    for ( int j = from; j < to; j++ )
+        y[j - from] = grid->y0 + j * grid->dy;
+
+    data->blockValues( x.constData(), grid->width,
+        y.constData(), y.size(), grid->values.data() + from * grid->width );
+}
+
+/*
+    The edges of a cell: 0 = top, 1 = right, 2 = bottom, 3 = left,
+    where the contour line is crossing the edge at the interpolated position
+ */
+static inline void qwtCellEdge( const QwtContourGrid &grid,
+    int i, int j, int edge, double level, QPointF &pos, qint64 &id )
+{
+    const bool vertical = ( edge == 1 || edge == 3 );
+
+    if ( edge == 1 )
+        i++;
+    else if ( edge == 2 )
+        j++;
+
+    // interpolating always from the same corner to have identical
+    // positions for the neighbored cells
+
+    const double z1 = grid.value( i, j );
+    const double z2 = vertical ? grid.value( i, j + 1 ) : grid.value( i + 1, j );
+
+    double t = 0.5;
+    if ( z1 != z2 )
+        t = ( level - z1 ) / ( z2 - z1 );
+
+    if ( vertical )
+        pos = QPointF( grid.x0 + i * grid.dx, grid.y0 + ( j + t ) * grid.dy );
+    else
+        pos = QPointF( grid.x0 + ( i + t ) * grid.dx, grid.y0 + j * grid.dy );
+
+    id = 2 * ( qint64( j ) * grid.width + i ) + ( vertical ? 1 : 0 );
+}
+
+static inline void qwtAddSegment( const QwtContourGrid &grid,
+    int i, int j, int edge1, int edge2, double level,
+    QVector<QwtContourSegment> &segments )
+{
+    QwtContourSegment segment;
+    qwtCellEdge( grid, i, j, edge1, level, segment.points[0], segment.edges[0] );
+    qwtCellEdge( grid, i, j, edge2, level, segment.points[1], segment.edges[1] );
+
+    segments += segment;
+}
+
+static void qwtTraceRows( QwtContourJob *job )
+{
+    enum { Top, Right, Bottom, Left };
+
+    // the pairs of edges, that are crossed for the 16 cases
+    static const int edgeTable[16][2] =
+    {
+        { -1, -1 }, { Left, Top }, { Top, Right }, { Left, Right },
+        { Right, Bottom }, { -1, -1 }, { Top, Bottom }, { Left, Bottom },
+        { Bottom, Left }, { Top, Bottom }, { -1, -1 }, { Right, Bottom },
+        { Left, Right }, { Top, Right }, { Left, Top }, { -1, -1 }
+    };
+
+    const QwtContourGrid &grid = *job->grid;
+
+    const double *levels = job->levels->constData();
+    const int numLevels = job->levels->size();
+
+    for ( int j = job->from; j < job->to; j++ )
+    {
+        for ( int i = 0; i < grid.width - 1; i++ )
+        {
+            const double z[4] =
+            {
+                grid.value( i, j ), grid.value( i + 1, j ),
+                grid.value( i + 1, j + 1 ), grid.value( i, j + 1 )
+            };
+
+            const double zMin = qMin( qMin( z[0], z[1] ), qMin( z[2], z[3] ) );
+            const double zMax = qMax( qMax( z[0], z[1] ), qMax( z[2], z[3] ) );
+
+            const double zSum = z[0] + z[1] + z[2] + z[3];
+            if ( qIsNaN( zSum ) )
+            {
+                // one of the points is NaN
+                continue;
+            }
+
+            if ( job->ignoreOutOfRange )
+            {
+                if ( !job->range.contains( zMin ) || !job->range.contains( zMax ) )
+                    continue;
+            }
+
+            // only the levels between the min/max of the cell
+
+            int l = std::lower_bound( levels, levels + numLevels, zMin ) - levels;
+            for ( ; l < numLevels && levels[l] <= zMax; l++ )
+            {
+                const double level = levels[l];
+
+                int index = 0;
+                for ( int k = 0; k < 4; k++ )
+                {
+                    if ( z[k] >= level )
+                        index |= ( 1 << k );
+                }
+
+                QVector<QwtContourSegment> &segments = job->segments[l];
+
+                if ( index == 5 || index == 10 )
+                {
+                    // saddle: resolved by the value in the center of the cell
+                    const bool isAbove = ( 0.25 * zSum >= level );
+
+                    if ( isAbove == ( index == 5 ) )
+                    {
+                        qwtAddSegment( grid, i, j, Top, Right, level, segments );
+                        qwtAddSegment( grid, i, j, Bottom, Left, level, segments );
+                    }
+                    else
+                    {
+                        qwtAddSegment( grid, i, j, Left, Top, level, segments );
+                        qwtAddSegment( grid, i, j, Right, Bottom, level, segments );
+                    }
+                }
+                else if ( edgeTable[index][0] >= 0 )
+                {
+                    qwtAddSegment( grid, i, j,
+                        edgeTable[index][0], edgeTable[index][1], level, segments );
+                }
+            }
+        }
+    }
+}
+
+static QList<QPolygonF> qwtJoinSegments(
+    const QVector<QwtContourSegment> *segments )
+{
+    const int numSegments = segments->size();
+    const QwtContourSegment *s = segments->constData();
+
+    // the segments sharing an edge are neighbors
+
+    QVector<QwtContourEnd> ends( 2 * numSegments );
+    for ( int i = 0; i < numSegments; i++ )
+    {
+        for ( int k = 0; k < 2; k++ )
+        {
+            ends[2 * i + k].edge = s[i].edges[k];
+            ends[2 * i + k].slot = 2 * i + k;
+        }
+    }
+
+    std::sort( ends.begin(), ends.end() );
+
+    QVector<int> neighbors( 2 * numSegments, -1 );
+    for ( int i = 0; i < ends.size() - 1; i++ )
+    {
+        if ( ends[i].edge == ends[i + 1].edge )
+        {
+            neighbors[ ends[i].slot ] = ends[i + 1].slot;
+            neighbors[ ends[i + 1].slot ] = ends[i].slot;
+            i++;
+        }
+    }
+
+    QList<QPolygonF> polylines;
+    QVector<bool> visited( numSegments, false );
+
+    // open polylines first, starting at a free end, then closed polylines
+
+    for ( int pass = 0; pass < 2; pass++ )
+    {
+        for ( int i = 0; i < numSegments; i++ )
+        {
+            if ( visited[i] )
+                continue;
+
+            int end = 0;
+            if ( pass == 0 )
+            {
+                if ( neighbors[2 * i] < 0 )
+                    end = 0;
+                else if ( neighbors[2 * i + 1] < 0 )
+                    end = 1;
+                else
+                    continue;
+            }
+
+            QPolygonF polyline;
+            polyline += s[i].points[end];
+
+            int segment = i;
+            while ( true )
+            {
+                visited[segment] = true;
+
+                const int out = 1 - end;
+                polyline += s[segment].points[out];
+
+                const int next = neighbors[2 * segment + out];
+                if ( next < 0 || visited[next / 2] )
+                    break;
+
+                segment = next / 2;
+                end = next % 2;
+            }
+
+            polylines += polyline;
+        }
+    }
+
+    return polylines;
+}
+
+namespace
+{
+    // sampling the values of the grid in strips of rows
+    class QwtContourSampleJob: public QwtRenderJob
+    {
+    public:
+        QwtContourSampleJob( const QwtRasterData *data,
+                QwtContourGrid *grid, int numStrips ):
+            d_data( data ),
+            d_grid( grid ),
+            d_numStrips( numStrips )
+        {
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return d_numStrips;
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            const int numRows = d_grid->height / d_numStrips;
+
+            const int from = index * numRows;
+            const int to = ( index == d_numStrips - 1 )
+                ? d_grid->height : from + numRows;
+
+            qwtSampleRows( d_data, d_grid, from, to );
+        }
+
+    private:
+        const QwtRasterData *d_data;
+        QwtContourGrid *d_grid;
+        const int d_numStrips;
+    };
+
+    // tracing the cells of the rows of each QwtContourJob
+    class QwtContourTraceJob: public QwtRenderJob
+    {
+    public:
+        explicit QwtContourTraceJob( QVector<QwtContourJob> *jobs ):
+            d_jobs( jobs->data() ),
+            d_numJobs( jobs->size() )
+        {
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return d_numJobs;
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            qwtTraceRows( d_jobs + index );
+        }
+
+    private:
+        QwtContourJob *d_jobs;
+        const int d_numJobs;
+    };
+
+    // joining the segments of each level to polylines
+    class QwtContourJoinJob: public QwtRenderJob
+    {
+    public:
+        QwtContourJoinJob(
+                const QVector< QVector<QwtContourSegment> > *segments,
+                QVector< QList<QPolygonF> > *polylines ):
+            d_segments( segments->constData() ),
+            d_polylines( polylines->data() ),
+            d_numLevels( segments->size() )
+        {
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return d_numLevels;
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            d_polylines[index] = qwtJoinSegments( d_segments + index );
+        }
+
+    private:
+        const QVector<QwtContourSegment> *d_segments;
+        QList<QPolygonF> *d_polylines;
+        const int d_numLevels;
+    };
+}
+
 class QwtRasterData::PrivateData
 {
 public:
@@ -238,6 +624,57 @@ void QwtRasterData::discardRaster()
 {
 }
 
+/*!
+  \brief Find the values for a row of raster positions
+
+  values() is called for a line of positions, that
+  share the same y coordinate.
+  The default implementation calls value() for each position,
+  but reimplementing it avoids the overhead of a virtual call per pixel.
+
+  The results have to be the same as calling value() for each position.
+  So a class, that reimplements value() of a base class with an optimized
+  values(), has to reimplement values() and blockValues() as well.
+
+  \param x Array of x values in plot coordinates
+  \param y Y value in plot coordinates
+  \param result Array for the values
+  \param count Number of values
+
+  \sa value()
+*/
+void QwtRasterData::values( const double *x, double y,
+    double *result, int count ) const
+{
+    for ( int i = 0; i < count; i++ )
+        result[i] = value( x[i], y );
+}
+
+/*!
+  \brief Find the values for a grid of raster positions
+
+  blockValues() is called by QwtPlotSpectrogram for blocks of
+  consecutive lines of an image. It allows implementations to
+  share calculations, that depend on the x coordinates only,
+  between the lines.
+
+  The default implementation calls values() for each line.
+
+  \param x Array of x values in plot coordinates
+  \param numX Number of x values
+  \param y Array of y values in plot coordinates
+  \param numY Number of y values
+  \param result Array for numX * numY values, row by row
+
+  \sa values(), value()
+*/
+void QwtRasterData::blockValues( const double *x, int numX,
+    const double *y, int numY, double *result ) const
+{
+    for ( int j = 0; j < numY; j++ )
+        values( x, y[j], result + j * numX, numX );
+}
+
 /*!
    \brief Pixel hint
 
@@ -427,3 +864,128 @@ QwtRasterData::ContourLines QwtRasterData::contourLines(
 
     return contourLines;
 }
+
+/*!
+   Calculate contour lines, that are joined to polylines
+
+   The values of the raster are sampled once into a buffer using
+   values(). Then the line segments of the contour lines are calculated
+   for each cell by the marching squares algorithm, where only the
+   levels between the minimum and the maximum of the cell are processed.
+   The rows are processed in parallel threads.
+
+   Finally the segments of each level are joined to polylines.
+
+   The parallel work is scheduled by QwtRenderScheduler. When the
+   token of the current QwtRenderScheduler::Scope has been cancelled
+   the calculation is abandoned and no contour lines are returned.
+
+   \param rect Bounding rectangle for the contour lines
+   \param raster Number of data pixels of the raster data
+   \param levels List of limits, where to insert contour lines
+   \param flags Flags to customize the contouring algorithm.
+                IgnoreAllVerticesOnLevel has no effect, as vertices
+                on a level are always treated as being above.
+
+   \return Calculated contour lines
+   \sa contourLines()
+*/
+QwtRasterData::ContourPolylines QwtRasterData::contourPolylines(
+    const QRectF &rect, const QSize &raster,
+    const QList<double> &levels, ConrecFlags flags ) const
+{
+    ContourPolylines contourLines;
+
+    if ( levels.size() == 0 || !rect.isValid() || !raster.isValid() )
+        return contourLines;
+
+    if ( raster.width() < 2 || raster.height() < 2 )
+        return contourLines;
+
+    QVector<double> sortedLevels;
+    sortedLevels.reserve( levels.size() );
+    for ( int i = 0; i < levels.size(); i++ )
+        sortedLevels += levels[i];
+
+    std::sort( sortedLevels.begin(), sortedLevels.end() );
+    sortedLevels.erase( std::unique( sortedLevels.begin(),
+        sortedLevels.end() ), sortedLevels.end() );
+
+    QwtContourGrid grid;
+    grid.width = raster.width();
+    grid.height = raster.height();
+    grid.x0 = rect.x();
+    grid.y0 = rect.y();
+    grid.dx = rect.width() / raster.width();
+    grid.dy = rect.height() / raster.height();
+    grid.values.resize( grid.width * grid.height );
+
+    const QwtInterval range = interval( Qt::ZAxis );
+
+    QwtRasterData *that = const_cast<QwtRasterData *>( this );
+    that->initRaster( rect, raster );
+
+    int numThreads = 1;
+#if !defined(QT_NO_QFUTURE)
+    numThreads = QThread::idealThreadCount();
+    numThreads = qBound( 1, numThreads, grid.height - 1 );
+#endif
+
+    QVector<QwtContourJob> jobs( numThreads );
+
+    const int numRows = ( grid.height - 1 ) / numThreads;
+    for ( int i = 0; i < numThreads; i++ )
+    {
+        QwtContourJob &job = jobs[i];
+
+        job.grid = &grid;
+        job.levels = &sortedLevels;
+        job.ignoreOutOfRange = range.isValid() && ( flags & IgnoreOutOfRange );
+        job.range = range;
+        job.from = i * numRows;
+        job.to = ( i == numThreads - 1 ) ? grid.height - 1 : job.from + numRows;
+        job.segments.resize( sortedLevels.size() );
+    }
+
+    // sampling the values and tracing the cells
+
+    QwtContourSampleJob sampleJob( this, &grid, numThreads );
+    bool isComplete = QwtRenderScheduler::run( sampleJob, numThreads );
+
+    if ( isComplete )
+    {
+        QwtContourTraceJob traceJob( &jobs );
+        isComplete = QwtRenderScheduler::run( traceJob, numThreads );
+    }
+
+    that->discardRaster();
+
+    // the contour lines are not needed anymore
+    if ( !isComplete )
+        return contourLines;
+
+    // collecting the segments of the rows and joining them
+
+    QVector< QVector<QwtContourSegment> > segments( sortedLevels.size() );
+    for ( int l = 0; l < sortedLevels.size(); l++ )
+    {
+        for ( int i = 0; i < jobs.size(); i++ )
+            segments[l] += jobs[i].segments[l];
+    }
+
+    jobs.clear();
+
+    QVector< QList<QPolygonF> > polylines( sortedLevels.size() );
+
+    QwtContourJoinJob joinJob( &segments, &polylines );
+    if ( !QwtRenderScheduler::run( joinJob ) )
+        return contourLines;
+
+    for ( int l = 0; l < sortedLevels.size(); l++ )
+    {
+        if ( !polylines[l].isEmpty() )
+            contourLines.insert( sortedLevels[l], polylines[l] );
+    }
+
+    return contourLines;
+}
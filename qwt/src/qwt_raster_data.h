@@ -45,6 +45,9 @@ public:
     //! Contour lines
     typedef QMap<double, QPolygonF> ContourLines;
 
+    //! Contour lines, that are joined to polylines
+    typedef QMap< double, QList<QPolygonF> > ContourPolylines;
+
     /*!
       \brief Raster data attributes
 
@@ -111,10 +114,20 @@ public:
     */
     virtual double value( double x, double y ) const = 0;
 
+    virtual void values( const double *x, double y,
+        double *result, int count ) const;
+
+    virtual void blockValues( const double *x, int numX,
+        const double *y, int numY, double *result ) const;
+
     virtual ContourLines contourLines( const QRectF &rect,
         const QSize &raster, const QList<double> &levels,
         ConrecFlags ) const;
 
+    virtual ContourPolylines contourPolylines( const QRectF &rect,
+        const QSize &raster, const QList<double> &levels,
+        ConrecFlags ) const;
+
     class Contour3DPoint;
     class ContourPlane;
 
@@ -0,0 +1,419 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_render_scheduler.h"
+
+#include <qvector.h>
+#include <qatomic.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <qthreadstorage.h>
+#include <qrunnable.h>
+#include <qpointer.h>
+
+#include <algorithm>
+
+namespace
+{
+    class QwtRenderContext
+    {
+    public:
+        QwtRenderContext():
+            priority( QwtRenderScheduler::NormalPriority )
+        {
+        }
+
+        QwtRenderToken token;
+        int priority;
+    };
+
+    class QwtRenderSchedulerData
+    {
+    public:
+        QMutex mutex;
+        QPointer< QThreadPool > threadPool;
+    };
+
+    class QwtTilePriorityLessThan
+    {
+    public:
+        explicit QwtTilePriorityLessThan( const QVector< double > &priorities ):
+            d_priorities( priorities )
+        {
+        }
+
+        inline bool operator()( int index1, int index2 ) const
+        {
+            // higher priorities first
+            return d_priorities[ index1 ] > d_priorities[ index2 ];
+        }
+
+    private:
+        const QVector< double > &d_priorities;
+    };
+}
+
+Q_GLOBAL_STATIC( QwtRenderSchedulerData, qwtSchedulerData )
+Q_GLOBAL_STATIC( QThreadStorage< QwtRenderContext >, qwtRenderContexts )
+
+static inline QwtRenderContext &qwtRenderContext()
+{
+    return qwtRenderContexts()->localData();
+}
+
+class QwtRenderToken::PrivateData
+{
+public:
+    PrivateData():
+        cancelled( 0 )
+    {
+    }
+
+    QAtomicInt cancelled;
+};
+
+//! Constructor, initializing a token, that is not cancelled
+QwtRenderToken::QwtRenderToken():
+    d_data( new PrivateData() )
+{
+}
+
+/*!
+  \brief Cancel the jobs, that are using the token
+
+  All copies of the token are cancelled. Tiles, that are
+  already in progress, are finished, but all other tiles
+  are skipped.
+
+  \sa isCancelled()
+ */
+void QwtRenderToken::cancel()
+{
+#if QT_VERSION >= 0x050000
+    d_data->cancelled.storeRelease( 1 );
+#else
+    d_data->cancelled.fetchAndStoreRelease( 1 );
+#endif
+}
+
+/*!
+  \return True, when cancel() has been called for one of the copies
+  \sa cancel()
+ */
+bool QwtRenderToken::isCancelled() const
+{
+#if QT_VERSION >= 0x050000
+    return d_data->cancelled.loadAcquire() != 0;
+#else
+    return d_data->cancelled.fetchAndAddAcquire( 0 ) != 0;
+#endif
+}
+
+//! Constructor
+QwtRenderJob::QwtRenderJob()
+{
+}
+
+//! Destructor
+QwtRenderJob::~QwtRenderJob()
+{
+}
+
+/*!
+  \brief Priority of a tile
+
+  Tiles with a higher priority are started first. The default
+  implementation returns 0.0 for all tiles, what keeps the
+  order of the indices.
+
+  \param index Index of the tile
+  \return Priority of the tile
+ */
+double QwtRenderJob::tilePriority( int index ) const
+{
+    Q_UNUSED( index )
+    return 0.0;
+}
+
+#if !defined(QT_NO_QFUTURE)
+
+namespace
+{
+    /*
+        The tiles of a job, shared between the calling thread and the
+        runnables. A runnable might be started after the job has been
+        completed, when all tiles have been taken by other threads.
+        Then it finds no more tiles and never touches the job.
+     */
+    class QwtRenderBatch
+    {
+    public:
+        QwtRenderBatch( QwtRenderJob *job,
+                const QVector< int > &order, const QwtRenderContext &context ):
+            job( job ),
+            order( order ),
+            context( context ),
+            next( 0 ),
+            numDone( 0 ),
+            numSkipped( 0 )
+        {
+        }
+
+        void work()
+        {
+            const int count = order.size();
+
+            while ( true )
+            {
+                const int i = next.fetchAndAddRelaxed( 1 );
+                if ( i >= count )
+                    break;
+
+                const bool skip = context.token.isCancelled();
+                if ( !skip )
+                    job->renderTile( order[i] );
+
+                QMutexLocker locker( &mutex );
+
+                if ( skip )
+                    numSkipped++;
+
+                if ( ++numDone == count )
+                    done.wakeAll();
+            }
+        }
+
+        bool wait()
+        {
+            QMutexLocker locker( &mutex );
+
+            while ( numDone < order.size() )
+                done.wait( &mutex );
+
+            return numSkipped == 0;
+        }
+
+        QwtRenderJob *job;
+        const QVector< int > order;
+        const QwtRenderContext context;
+
+        QAtomicInt next;
+
+        QMutex mutex;
+        QWaitCondition done;
+        int numDone;
+        int numSkipped;
+    };
+
+    class QwtRenderRunnable: public QRunnable
+    {
+    public:
+        explicit QwtRenderRunnable( const QSharedPointer< QwtRenderBatch > &batch ):
+            d_batch( batch )
+        {
+        }
+
+        virtual void run() QWT_OVERRIDE
+        {
+            // nested jobs inherit the context of the batch
+
+            const QwtRenderScheduler::Scope scope(
+                d_batch->context.token, d_batch->context.priority );
+
+            d_batch->work();
+        }
+
+    private:
+        QSharedPointer< QwtRenderBatch > d_batch;
+    };
+}
+
+#endif
+
+/*!
+  \brief Constructor
+
+  Assigns a context to the current thread.
+
+  \param token Token for cancelling the jobs
+  \param priority Priority of the jobs ( see QwtRenderScheduler::Priority )
+ */
+QwtRenderScheduler::Scope::Scope( const QwtRenderToken &token, int priority )
+{
+    QwtRenderContext &context = qwtRenderContext();
+
+    d_token = context.token;
+    d_priority = context.priority;
+
+    context.token = token;
+    context.priority = priority;
+}
+
+//! Destructor, restoring the previous context of the thread
+QwtRenderScheduler::Scope::~Scope()
+{
+    QwtRenderContext &context = qwtRenderContext();
+
+    context.token = d_token;
+    context.priority = d_priority;
+}
+
+/*!
+  \brief Assign the thread pool for rendering tiles
+
+  The pool is not owned by the scheduler. When it gets
+  deleted the global thread pool is used again.
+
+  \param pool Thread pool, or NULL for QThreadPool::globalInstance()
+  \sa threadPool()
+ */
+void QwtRenderScheduler::setThreadPool( QThreadPool *pool )
+{
+    QwtRenderSchedulerData *data = qwtSchedulerData();
+
+    QMutexLocker locker( &data->mutex );
+    data->threadPool = pool;
+}
+
+/*!
+  \return Thread pool for rendering tiles
+  \sa setThreadPool()
+ */
+QThreadPool *QwtRenderScheduler::threadPool()
+{
+    QwtRenderSchedulerData *data = qwtSchedulerData();
+
+    QMutexLocker locker( &data->mutex );
+
+    QThreadPool *pool = data->threadPool;
+    if ( pool == NULL )
+        pool = QThreadPool::globalInstance();
+
+    return pool;
+}
+
+/*!
+  \brief Render the tiles of a job
+
+  The tiles are started in the order of QwtRenderJob::tilePriority()
+  with the priority and the token of the current context. The calling
+  thread renders tiles itself and returns, when all tiles
+  are done or skipped.
+
+  \param job Render job
+  \param numThreads Maximum number of threads, including the calling
+                    thread. 0 means QThread::idealThreadCount().
+
+  \return True, when all tiles have been rendered. False, when
+          tiles have been skipped, because the token of the
+          context has been cancelled.
+
+  \sa Scope, QwtPlotRasterItem::setRenderThreadCount()
+ */
+bool QwtRenderScheduler::run( QwtRenderJob &job, uint numThreads )
+{
+    const QwtRenderContext context = qwtRenderContext();
+
+    const int numTiles = job.numTiles();
+    if ( numTiles <= 0 )
+        return !context.token.isCancelled();
+
+    QVector< int > order( numTiles );
+    QVector< double > priorities( numTiles );
+
+    bool sorted = true;
+    for ( int i = 0; i < numTiles; i++ )
+    {
+        order[i] = i;
+        priorities[i] = job.tilePriority( i );
+
+        if ( i > 0 && priorities[i] > priorities[i - 1] )
+            sorted = false;
+    }
+
+    if ( !sorted )
+    {
+        std::stable_sort( order.begin(), order.end(),
+            QwtTilePriorityLessThan( priorities ) );
+    }
+
+#if !defined(QT_NO_QFUTURE)
+    if ( numThreads <= 0 )
+        numThreads = QThread::idealThreadCount();
+
+    if ( numThreads <= 0 )
+        numThreads = 1;
+
+    numThreads = qMin( numThreads, uint( numTiles ) );
+
+    QSharedPointer< QwtRenderBatch > batch(
+        new QwtRenderBatch( &job, order, context ) );
+
+    if ( numThreads > 1 )
+    {
+        QThreadPool *pool = threadPool();
+
+        for ( uint i = 1; i < numThreads; i++ )
+            pool->start( new QwtRenderRunnable( batch ), context.priority );
+    }
+
+    batch->work();
+    return batch->wait();
+#else
+    Q_UNUSED( numThreads )
+
+    bool isComplete = true;
+
+    for ( int i = 0; i < numTiles; i++ )
+    {
+        if ( context.token.isCancelled() )
+        {
+            isComplete = false;
+            break;
+        }
+
+        job.renderTile( order[i] );
+    }
+
+    return isComplete;
+#endif
+}
+
+/*!
+  \return Token of the current context
+  \sa Scope, isCancelled()
+ */
+QwtRenderToken QwtRenderScheduler::currentToken()
+{
+    return qwtRenderContext().token;
+}
+
+/*!
+  \return Priority of the current context
+  \sa Scope
+ */
+int QwtRenderScheduler::currentPriority()
+{
+    return qwtRenderContext().priority;
+}
+
+/*!
+  \brief Check if the token of the current context has been cancelled
+
+  Jobs with expensive tiles might call isCancelled() from
+  QwtRenderJob::renderTile() to abandon a tile early.
+
+  \return currentToken().isCancelled()
+ */
+bool QwtRenderScheduler::isCancelled()
+{
+    return qwtRenderContext().token.isCancelled();
+}
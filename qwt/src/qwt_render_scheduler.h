@@ -0,0 +1,156 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_RENDER_SCHEDULER_H
+#define QWT_RENDER_SCHEDULER_H
+
+#include "qwt_global.h"
+#include <qsharedpointer.h>
+
+class QThreadPool;
+
+/*!
+  \brief A flag for abandoning a render job
+
+  Copies of a token share the same flag. A token is passed to the
+  jobs of a render operation ( see QwtRenderScheduler::Scope ) and
+  cancelled, when the result of the operation is not needed anymore.
+  Tiles, that have not been started, are skipped then.
+
+  \sa QwtRenderScheduler
+*/
+class QWT_EXPORT QwtRenderToken
+{
+public:
+    QwtRenderToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    class PrivateData;
+    QSharedPointer< PrivateData > d_data;
+};
+
+/*!
+  \brief A render operation, that is split into tiles
+
+  renderTile() is called concurrently from several threads,
+  but never twice for the same index.
+
+  \sa QwtRenderScheduler::run()
+*/
+class QWT_EXPORT QwtRenderJob
+{
+public:
+    QwtRenderJob();
+    virtual ~QwtRenderJob();
+
+    //! \return Number of tiles
+    virtual int numTiles() const = 0;
+
+    //! Render a tile
+    virtual void renderTile( int index ) = 0;
+
+    virtual double tilePriority( int index ) const;
+};
+
+/*!
+  \brief Scheduler for the render jobs of all raster items
+
+  QwtPlotSpectrogram, QwtPolarSpectrogram and QwtPlotRasterItem
+  distribute their tiles to the threads of one thread pool, that
+  can be configured with setThreadPool().
+
+  - The tiles of a job are started in the order of their
+    priority, so that f.e. the tiles, that are visible, are
+    available first.
+
+  - Jobs are queued with the priority of the calling context. Images
+    for the screen are rendered with NormalPriority and overtake the
+    tiles of images, that are refined in the background with LowPriority.
+
+  - A job can be abandoned by cancelling the token of the calling
+    context. F.e. QwtPlotRasterItem cancels the refinement of an image,
+    as soon as the scales have changed. Jobs, that are started without
+    a Scope, can't be cancelled.
+
+  The calling thread always takes part in rendering its job. So
+  jobs can be nested and don't block, when all threads of the pool
+  are busy.
+
+  The context is assigned by a Scope, that is active until
+  it goes out of scope:
+
+  \code
+    QwtRenderToken token;
+    ...
+
+    {
+        QwtRenderScheduler::Scope scope( token, QwtRenderScheduler::LowPriority );
+        image = spectrogram->renderImage( xMap, yMap, area, size );
+    }
+
+    // from the GUI thread
+    token.cancel();
+  \endcode
+*/
+class QWT_EXPORT QwtRenderScheduler
+{
+public:
+    //! Priority of a render job
+    enum Priority
+    {
+        //! Images, that are refined in the background
+        LowPriority = 0,
+
+        //! Images, that are needed for the next frame
+        NormalPriority = 1,
+
+        //! Time critical images
+        HighPriority = 2
+    };
+
+    /*!
+      \brief Context of render jobs
+
+      A scope assigns a cancellation token and a priority to
+      all render jobs, that are started from the current thread
+      - including nested jobs started from the tiles - until
+      the scope is destroyed.
+     */
+    class QWT_EXPORT Scope
+    {
+    public:
+        Scope( const QwtRenderToken &, int priority = NormalPriority );
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        // the context, that is restored by the destructor
+        QwtRenderToken d_token;
+        int d_priority;
+    };
+
+    static void setThreadPool( QThreadPool * );
+    static QThreadPool *threadPool();
+
+    static bool run( QwtRenderJob &, uint numThreads = 0 );
+
+    static QwtRenderToken currentToken();
+    static int currentPriority();
+
+    static bool isCancelled();
+
+private:
+    QwtRenderScheduler();
+};
+
+#endif
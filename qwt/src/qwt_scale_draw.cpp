@@ -16,6 +16,7 @@
 
 #include <qpainter.h>
 #include <qpaintengine.h>
+#include <qimage.h>
 #include <qmath.h>
 
 static inline double qwtEffectivePenWidth( const QwtAbstractScaleDraw* scaleDraw )
@@ -775,6 +776,29 @@ void QwtScaleDraw::drawLabel( QPainter *painter, double value ) const
 
     const QTransform transform = labelTransformation( pos, labelSize );
 
+    if ( testLabelCacheAttribute( LabelImages ) )
+    {
+        const QTransform deviceTransform = transform * painter->worldTransform();
+
+        if ( deviceTransform.type() <= QTransform::TxTranslate
+            && painter->paintEngine()->type() == QPaintEngine::Raster )
+        {
+            const QImage image = tickLabelImage( painter, value );
+            if ( !image.isNull() )
+            {
+                const QPointF imagePos( qRound( deviceTransform.dx() ),
+                    qRound( deviceTransform.dy() ) );
+
+                painter->save();
+                painter->resetTransform();
+                painter->drawImage( imagePos, image );
+                painter->restore();
+
+                return;
+            }
+        }
+    }
+
     painter->save();
     painter->setWorldTransform( transform, true );
 
@@ -13,6 +13,72 @@
 #include <qrect.h>
 #include <qdebug.h>
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) \
+    || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define QWT_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/*
+    The linear part of the mapping:
+
+        result = offset + ( value - origin ) * factor;
+
+    The operations are the same as in QwtScaleMap::transform( double ),
+    so that the results of both implementations are identical.
+ */
+static void qwtMapLinear( const double *values, double *result,
+    size_t count, double origin, double factor, double offset )
+{
+    size_t i = 0;
+
+#if QWT_USE_SSE2
+    const __m128d o = _mm_set1_pd( origin );
+    const __m128d f = _mm_set1_pd( factor );
+    const __m128d p = _mm_set1_pd( offset );
+
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        const __m128d v1 = _mm_loadu_pd( values + i );
+        const __m128d v2 = _mm_loadu_pd( values + i + 2 );
+
+        _mm_storeu_pd( result + i,
+            _mm_add_pd( p, _mm_mul_pd( _mm_sub_pd( v1, o ), f ) ) );
+        _mm_storeu_pd( result + i + 2,
+            _mm_add_pd( p, _mm_mul_pd( _mm_sub_pd( v2, o ), f ) ) );
+    }
+#endif
+
+    for ( ; i < count; i++ )
+        result[i] = offset + ( values[i] - origin ) * factor;
+}
+
+static void qwtInvMapLinear( const double *values, double *result,
+    size_t count, double origin, double factor, double offset )
+{
+    size_t i = 0;
+
+#if QWT_USE_SSE2
+    const __m128d o = _mm_set1_pd( origin );
+    const __m128d f = _mm_set1_pd( factor );
+    const __m128d s = _mm_set1_pd( offset );
+
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        const __m128d v1 = _mm_loadu_pd( values + i );
+        const __m128d v2 = _mm_loadu_pd( values + i + 2 );
+
+        _mm_storeu_pd( result + i,
+            _mm_add_pd( s, _mm_div_pd( _mm_sub_pd( v1, o ), f ) ) );
+        _mm_storeu_pd( result + i + 2,
+            _mm_add_pd( s, _mm_div_pd( _mm_sub_pd( v2, o ), f ) ) );
+    }
+#endif
+
+    for ( ; i < count; i++ )
+        result[i] = offset + ( values[i] - origin ) / factor;
+}
+
 /*!
   \brief Constructor
 
@@ -140,6 +206,54 @@ void QwtScaleMap::updateFactor()
         d_cnv = ( d_p2 - d_p1 ) / ( ts2 - d_ts1 );
 }
 
+/*!
+  \brief Transform an array of values from scale to paint coordinates
+
+  The results are the same as calling transform( double ) for each value,
+  but the transformation is called once for all values and the linear
+  part of the mapping is done with SIMD instructions ( SSE2 ),
+  when available.
+
+  \param values Values relative to the coordinates of the scale
+  \param result Array for the transformed values,
+                might be the same as values
+  \param count Number of values
+
+  \sa invTransform(), QwtTransform::transformValues()
+*/
+void QwtScaleMap::transform( const double *values,
+    double *result, size_t count ) const
+{
+    if ( d_transform )
+    {
+        d_transform->transformValues( values, result, count );
+        values = result;
+    }
+
+    qwtMapLinear( values, result, count, d_ts1, d_cnv, d_p1 );
+}
+
+/*!
+  \brief Transform an array of values from paint to scale coordinates
+
+  The results are the same as calling invTransform( double ) for each value.
+
+  \param values Values relative to the coordinates of the paint device
+  \param result Array for the transformed values,
+                might be the same as values
+  \param count Number of values
+
+  \sa transform(), QwtTransform::invTransformValues()
+*/
+void QwtScaleMap::invTransform( const double *values,
+    double *result, size_t count ) const
+{
+    qwtInvMapLinear( values, result, count, d_p1, d_cnv, d_ts1 );
+
+    if ( d_transform )
+        d_transform->invTransformValues( result, result, count );
+}
+
 /*!
    Transform a rectangle from scale to paint coordinates
 
@@ -42,6 +42,12 @@ public:
     double transform( double s ) const;
     double invTransform( double p ) const;
 
+    void transform( const double *values,
+        double *result, size_t count ) const;
+
+    void invTransform( const double *values,
+        double *result, size_t count ) const;
+
     double p1() const;
     double p2() const;
 
@@ -271,6 +271,57 @@ QRectF QwtPointSeriesData::boundingRect() const
     return d_boundingRect;
 }
 
+/*!
+  \brief Contiguous arrays of x and y coordinates
+
+  Series, that store their coordinates in two separate arrays of doubles,
+  return them, so that QwtPointMapper can map the coordinates without
+  calling sample() for each point.
+
+  The default implementation returns false, as QwtPointSeriesData
+  stores an array of points.
+
+  \param xData Pointer, where to return the address of the x coordinates
+  \param yData Pointer, where to return the address of the y coordinates
+
+  \return True, when the coordinates are available as arrays of size()
+          values. Then sample( i ) has to return
+          QPointF( xData[i], yData[i] ).
+
+  \sa contiguousFloatData(), QwtPointArrayData, QwtCPointerData
+*/
+bool QwtPointSeriesData::contiguousDoubleData(
+    const double **xData, const double **yData ) const
+{
+    Q_UNUSED( xData )
+    Q_UNUSED( yData )
+
+    return false;
+}
+
+/*!
+  \brief Contiguous arrays of x and y coordinates
+
+  The same as contiguousDoubleData(), but for series
+  storing their coordinates as floats.
+
+  \param xData Pointer, where to return the address of the x coordinates
+  \param yData Pointer, where to return the address of the y coordinates
+
+  \return True, when the coordinates are available as arrays of size()
+          values.
+
+  \sa contiguousDoubleData()
+*/
+bool QwtPointSeriesData::contiguousFloatData(
+    const float **xData, const float **yData ) const
+{
+    Q_UNUSED( xData )
+    Q_UNUSED( yData )
+
+    return false;
+}
+
 /*!
    Constructor
    \param samples Samples
@@ -101,17 +101,67 @@ public:
     */
     virtual void setRectOfInterest( const QRectF &rect );
 
+    /*!
+       \brief Indicate, that the samples are sorted by their x coordinates
+
+       For series with increasing x values ( f.e. time series ) plot items
+       like QwtPlotCurve can find the range of visible samples by a
+       binary search instead of mapping all samples.
+
+       The series is not checked, it is the responsibility of the
+       application to set this flag only when the order is guaranteed.
+       The default setting is false.
+
+       \param on On/Off
+       \sa isXSorted()
+     */
+    void setXSorted( bool on );
+
+    /*!
+       \return True, when the samples are sorted by increasing x values
+       \sa setXSorted()
+     */
+    bool isXSorted() const;
+
+    /*!
+       \brief Revision of the samples
+
+       The revision is a counter, that is incremented, whenever the samples
+       of the series are modified in place - f.e. by appending samples to
+       a ring buffer or by calculating a different level of detail.
+       Plot items can compare it with a previous value to find out
+       if something they have calculated from the samples is outdated.
+
+       Implementations of series data, that modify their samples,
+       need to call incrementRevision().
+
+       \return Revision of the samples
+       \sa incrementRevision()
+     */
+    uint revision() const;
+
 protected:
+    /*!
+       \brief Indicate, that the samples have been modified
+       \sa revision()
+     */
+    void incrementRevision();
+
     //! Can be used to cache a calculated bounding rectangle
     mutable QRectF d_boundingRect;
 
 private:
     QwtSeriesData<T> &operator=( const QwtSeriesData<T> & );
+
+    bool d_xSorted;
+    uint d_revision;
 };
 
 template <typename T>
 QwtSeriesData<T>::QwtSeriesData():
-    d_boundingRect( 0.0, 0.0, -1.0, -1.0 )
+    d_boundingRect( 0.0, 0.0, -1.0, -1.0 ),
+    d_xSorted( false ),
+    d_revision( 0 )
 {
 }
 
@@ -125,6 +175,30 @@ void QwtSeriesData<T>::setRectOfInterest( const QRectF & )
 {
 }
 
+template <typename T>
+void QwtSeriesData<T>::setXSorted( bool on )
+{
+    d_xSorted = on;
+}
+
+template <typename T>
+bool QwtSeriesData<T>::isXSorted() const
+{
+    return d_xSorted;
+}
+
+template <typename T>
+uint QwtSeriesData<T>::revision() const
+{
+    return d_revision;
+}
+
+template <typename T>
+void QwtSeriesData<T>::incrementRevision()
+{
+    d_revision++;
+}
+
 /*!
   \brief Template class for data, that is organized as QVector
 
@@ -185,6 +259,8 @@ void QwtArraySeriesData<T>::setSamples( const QVector<T> &samples )
 {
     QwtSeriesData<T>::d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
     d_samples = samples;
+
+    QwtSeriesData<T>::incrementRevision();
 }
 
 template <typename T>
@@ -213,6 +289,12 @@ public:
         const QVector<QPointF> & = QVector<QPointF>() );
 
     virtual QRectF boundingRect() const QWT_OVERRIDE;
+
+    virtual bool contiguousDoubleData(
+        const double **xData, const double **yData ) const;
+
+    virtual bool contiguousFloatData(
+        const float **xData, const float **yData ) const;
 };
 
 //! Interface for iterating over an array of 3D points
@@ -0,0 +1,380 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_spatial_index.h"
+#include "qwt_series_data.h"
+#include "qwt_scale_map.h"
+#include "qwt_math.h"
+
+#include <qrect.h>
+
+#include <algorithm>
+
+namespace
+{
+    class QwtIndexEntry
+    {
+    public:
+        double x;
+        double y;
+        int index;
+    };
+
+    class QwtIndexNode
+    {
+    public:
+        double minX, maxX;
+        double minY, maxY;
+
+        // range of entries
+        int from;
+        int to;
+
+        // the second child is at child + 1, -1 for leaves
+        int child;
+    };
+
+    class QwtLessX
+    {
+    public:
+        inline bool operator()( const QwtIndexEntry &e1, const QwtIndexEntry &e2 ) const
+        {
+            return e1.x < e2.x;
+        }
+    };
+
+    class QwtLessY
+    {
+    public:
+        inline bool operator()( const QwtIndexEntry &e1, const QwtIndexEntry &e2 ) const
+        {
+            return e1.y < e2.y;
+        }
+    };
+}
+
+static inline double qwtDistance( double pos, double v1, double v2 )
+{
+    if ( v1 > v2 )
+        qSwap( v1, v2 );
+
+    if ( pos < v1 )
+        return v1 - pos;
+
+    if ( pos > v2 )
+        return pos - v2;
+
+    return 0.0;
+}
+
+class QwtSpatialIndex::PrivateData
+{
+public:
+    PrivateData():
+        size( 0 )
+    {
+    }
+
+    enum { LeafSize = 16 };
+
+    // the slot of the node has been allocated by the caller
+    void buildNode( int nodeIndex, int from, int to, double width, double height )
+    {
+        QwtIndexNode node;
+        node.from = from;
+        node.to = to;
+        node.child = -1;
+
+        const QwtIndexEntry *e = entries.constData();
+
+        node.minX = node.maxX = e[from].x;
+        node.minY = node.maxY = e[from].y;
+
+        for ( int i = from + 1; i < to; i++ )
+        {
+            node.minX = qMin( node.minX, e[i].x );
+            node.maxX = qMax( node.maxX, e[i].x );
+            node.minY = qMin( node.minY, e[i].y );
+            node.maxY = qMax( node.maxY, e[i].y );
+        }
+
+        if ( to - from <= LeafSize )
+        {
+            nodes[nodeIndex] = node;
+            return;
+        }
+
+        // splitting at the median of the relatively wider side
+
+        const int mid = from + ( to - from ) / 2;
+
+        QwtIndexEntry *first = entries.data() + from;
+        QwtIndexEntry *last = entries.data() + to;
+
+        const double dx = ( width > 0.0 ) ? ( node.maxX - node.minX ) / width : 0.0;
+        const double dy = ( height > 0.0 ) ? ( node.maxY - node.minY ) / height : 0.0;
+
+        if ( dx >= dy )
+            std::nth_element( first, entries.data() + mid, last, QwtLessX() );
+        else
+            std::nth_element( first, entries.data() + mid, last, QwtLessY() );
+
+        node.child = nodes.size();
+        nodes.resize( node.child + 2 );
+
+        nodes[nodeIndex] = node;
+
+        buildNode( node.child, from, mid, width, height );
+        buildNode( node.child + 1, mid, to, width, height );
+    }
+
+    inline double bound( const QwtIndexNode &node,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QPointF &pos ) const
+    {
+        const double dx = qwtDistance( pos.x(),
+            xMap.transform( node.minX ), xMap.transform( node.maxX ) );
+
+        const double dy = qwtDistance( pos.y(),
+            yMap.transform( node.minY ), yMap.transform( node.maxY ) );
+
+        return qwtSqr( dx ) + qwtSqr( dy );
+    }
+
+    void findClosest( int nodeIndex,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QPointF &pos,
+        int &index, double &dmin ) const
+    {
+        const QwtIndexNode &node = nodes[nodeIndex];
+
+        if ( node.child < 0 )
+        {
+            const QwtIndexEntry *e = entries.constData();
+
+            for ( int i = node.from; i < node.to; i++ )
+            {
+                const double cx = xMap.transform( e[i].x ) - pos.x();
+                const double cy = yMap.transform( e[i].y ) - pos.y();
+
+                const double f = qwtSqr( cx ) + qwtSqr( cy );
+
+                // the lowest index wins, like when iterating over all samples
+                if ( f < dmin || ( f == dmin && e[i].index < index ) )
+                {
+                    index = e[i].index;
+                    dmin = f;
+                }
+            }
+
+            return;
+        }
+
+        int child1 = node.child;
+        int child2 = node.child + 1;
+
+        double bound1 = bound( nodes[child1], xMap, yMap, pos );
+        double bound2 = bound( nodes[child2], xMap, yMap, pos );
+
+        if ( bound2 < bound1 )
+        {
+            qSwap( child1, child2 );
+            qSwap( bound1, bound2 );
+        }
+
+        // NaN bounds ( f.e. negative values on log scales ) never prune
+
+        if ( !( bound1 > dmin ) )
+            findClosest( child1, xMap, yMap, pos, index, dmin );
+
+        if ( !( bound2 > dmin ) )
+            findClosest( child2, xMap, yMap, pos, index, dmin );
+    }
+
+    void findIndices( int nodeIndex, const QRectF &rect, QVector<int> &indices ) const
+    {
+        const QwtIndexNode &node = nodes[nodeIndex];
+
+        if ( node.maxX < rect.left() || node.minX > rect.right()
+            || node.maxY < rect.top() || node.minY > rect.bottom() )
+        {
+            return;
+        }
+
+        const QwtIndexEntry *e = entries.constData();
+
+        const bool isInside = node.minX >= rect.left() && node.maxX <= rect.right()
+            && node.minY >= rect.top() && node.maxY <= rect.bottom();
+
+        if ( isInside )
+        {
+            for ( int i = node.from; i < node.to; i++ )
+                indices += e[i].index;
+
+            return;
+        }
+
+        if ( node.child < 0 )
+        {
+            for ( int i = node.from; i < node.to; i++ )
+            {
+                if ( e[i].x >= rect.left() && e[i].x <= rect.right()
+                    && e[i].y >= rect.top() && e[i].y <= rect.bottom() )
+                {
+                    indices += e[i].index;
+                }
+            }
+
+            return;
+        }
+
+        findIndices( node.child, rect, indices );
+        findIndices( node.child + 1, rect, indices );
+    }
+
+    size_t size;
+
+    QVector<QwtIndexEntry> entries;
+    QVector<QwtIndexNode> nodes;
+};
+
+//! Constructor
+QwtSpatialIndex::QwtSpatialIndex()
+{
+    d_data = new PrivateData();
+}
+
+//! Destructor
+QwtSpatialIndex::~QwtSpatialIndex()
+{
+    delete d_data;
+}
+
+/*!
+  \brief Build the index for the samples of a series
+
+  Building the index is an O(n * log(n)) operation.
+
+  \param series Series
+  \sa clear()
+*/
+void QwtSpatialIndex::build( const QwtSeriesData<QPointF> *series )
+{
+    clear();
+
+    if ( series == NULL )
+        return;
+
+    const int numSamples = static_cast<int>( series->size() );
+
+    d_data->size = series->size();
+    d_data->entries.reserve( numSamples );
+
+    QRectF rect( 1.0, 1.0, -2.0, -2.0 ); // invalid
+
+    for ( int i = 0; i < numSamples; i++ )
+    {
+        const QPointF sample = series->sample( i );
+        if ( sample.x() == sample.x() && sample.y() == sample.y() ) // no NaNs
+        {
+            QwtIndexEntry entry;
+            entry.x = sample.x();
+            entry.y = sample.y();
+            entry.index = i;
+
+            d_data->entries += entry;
+
+            if ( rect.width() < 0.0 )
+            {
+                rect = QRectF( sample.x(), sample.y(), 0.0, 0.0 );
+            }
+            else
+            {
+                rect.setLeft( qMin( rect.left(), sample.x() ) );
+                rect.setRight( qMax( rect.right(), sample.x() ) );
+                rect.setTop( qMin( rect.top(), sample.y() ) );
+                rect.setBottom( qMax( rect.bottom(), sample.y() ) );
+            }
+        }
+    }
+
+    if ( d_data->entries.isEmpty() )
+        return;
+
+    d_data->nodes.reserve( 4 * d_data->entries.size() / PrivateData::LeafSize + 1 );
+    d_data->nodes.resize( 1 );
+
+    d_data->buildNode( 0, 0, d_data->entries.size(), rect.width(), rect.height() );
+}
+
+//! Remove all samples from the index
+void QwtSpatialIndex::clear()
+{
+    d_data->size = 0;
+    d_data->entries.clear();
+    d_data->nodes.clear();
+}
+
+/*!
+  \return Number of samples of the series, when the index has been built
+  \note Samples with NaN coordinates are included, even if they
+        are not indexed
+*/
+size_t QwtSpatialIndex::size() const
+{
+    return d_data->size;
+}
+
+/*!
+  \brief Find the closest sample for a position in paint device coordinates
+
+  The result is the same as iterating over all samples
+  like QwtPlotCurve::closestPoint() does.
+
+  \param xMap Maps x-values into paint device coordinates
+  \param yMap Maps y-values into paint device coordinates
+  \param pos Position in paint device coordinates
+  \param dist If dist != NULL, closestPoint() returns the distance between
+              the position and the closest point
+
+  \return Index of the closest sample, or -1 if none can be found
+*/
+int QwtSpatialIndex::closestPoint(
+    const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+    const QPointF &pos, double *dist ) const
+{
+    int index = -1;
+    double dmin = 1.0e10;
+
+    if ( !d_data->nodes.isEmpty() )
+        d_data->findClosest( 0, xMap, yMap, pos, index, dmin );
+
+    if ( dist )
+        *dist = std::sqrt( dmin );
+
+    return index;
+}
+
+/*!
+  \brief Find the samples inside of a rectangle
+
+  \param rect Rectangle in scale coordinates
+  \return Indices of the samples inside of the rectangle in increasing order
+*/
+QVector<int> QwtSpatialIndex::indices( const QRectF &rect ) const
+{
+    QVector<int> indices;
+
+    if ( !d_data->nodes.isEmpty() )
+    {
+        d_data->findIndices( 0, rect.normalized(), indices );
+        std::sort( indices.begin(), indices.end() );
+    }
+
+    return indices;
+}
@@ -0,0 +1,62 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_SPATIAL_INDEX_H
+#define QWT_SPATIAL_INDEX_H
+
+#include "qwt_global.h"
+#include <qvector.h>
+
+class QwtScaleMap;
+class QPointF;
+class QRectF;
+template <typename T> class QwtSeriesData;
+
+/*!
+  \brief A spatial index for a series of points
+
+  QwtSpatialIndex is a k-d tree of the samples of a series in scale
+  coordinates. It finds the closest sample to a position or the samples
+  inside of a rectangle without iterating over all samples.
+
+  As the scale maps are separable and monotonic, the bounding
+  rectangles of the nodes can be mapped to paint device coordinates.
+  So the same tree can be used for finding the closest point
+  in widget coordinates for any scale maps - f.e. after zooming.
+
+  Samples with NaN coordinates are not indexed.
+
+  \note The index is a snapshot of the samples. When the series
+        has been modified it needs to be rebuilt.
+  \sa QwtPlotCurve::setSpatialIndexEnabled()
+*/
+class QWT_EXPORT QwtSpatialIndex
+{
+public:
+    QwtSpatialIndex();
+    ~QwtSpatialIndex();
+
+    void build( const QwtSeriesData<QPointF> * );
+    void clear();
+
+    size_t size() const;
+
+    int closestPoint( const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QPointF &pos, double *dist = NULL ) const;
+
+    QVector<int> indices( const QRectF & ) const;
+
+private:
+    Q_DISABLE_COPY(QwtSpatialIndex)
+
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
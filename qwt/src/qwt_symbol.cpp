@@ -11,11 +11,17 @@
 #include "qwt_painter.h"
 #include "qwt_graphic.h"
 #include "qwt_math.h"
+#include "qwt_pixel_matrix.h"
+#include "qwt_render_scheduler.h"
 
 #include <qpainter.h>
 #include <qpainterpath.h>
 #include <qpixmap.h>
+#include <qimage.h>
+#include <qvector.h>
 #include <qpaintengine.h>
+#include <qpaintdevice.h>
+#include <qthread.h>
 #ifndef QWT_NO_SVG
 #include <qsvgrenderer.h>
 #endif
@@ -767,6 +773,235 @@ static inline void qwtDrawHexagonSymbols( QPainter *painter,
     }
 }
 
+namespace
+{
+    /*
+        A symbol prerendered into a premultiplied image together
+        with the range of the pixels with alpha != 0 for each row.
+     */
+    class QwtSymbolStamp
+    {
+    public:
+        QwtSymbolStamp()
+        {
+        }
+
+        explicit QwtSymbolStamp( const QImage &stampImage ):
+            image( stampImage ),
+            firstColumn( stampImage.height() ),
+            lastColumn( stampImage.height() )
+        {
+            for ( int y = 0; y < image.height(); y++ )
+            {
+                const QRgb *line =
+                    reinterpret_cast< const QRgb * >( image.constScanLine( y ) );
+
+                int x1 = 0;
+                while ( x1 < image.width() && qAlpha( line[x1] ) == 0 )
+                    x1++;
+
+                int x2 = image.width() - 1;
+                while ( x2 > x1 && qAlpha( line[x2] ) == 0 )
+                    x2--;
+
+                firstColumn[y] = x1;
+                lastColumn[y] = x2;
+            }
+        }
+
+        QImage image;
+        QVector< int > firstColumn;
+        QVector< int > lastColumn;
+    };
+
+    // top/left position of a stamp in device coordinates
+    class QwtStampPosition
+    {
+    public:
+        int x;
+        int y;
+        int variant;
+    };
+}
+
+// number of sub-pixel positions in each direction
+static const int qwtSubPixels = 4;
+
+// don't distribute batches with less symbols to threads
+static const int qwtMinParallelStamps = 5000;
+
+static inline int qwtFloorDiv( int value, int divisor )
+{
+    int q = value / divisor;
+    if ( ( value % divisor != 0 ) && ( value < 0 ) )
+        q--;
+
+    return q;
+}
+
+// the same as BYTE_MUL in the Qt raster engine
+static inline uint qwtByteMul( uint x, uint a )
+{
+    uint t = ( x & 0xff00ff ) * a;
+    t = ( t + ( ( t >> 8 ) & 0xff00ff ) + 0x800080 ) >> 8;
+    t &= 0xff00ff;
+
+    x = ( ( x >> 8 ) & 0xff00ff ) * a;
+    x = ( x + ( ( x >> 8 ) & 0xff00ff ) + 0x800080 );
+    x &= 0xff00ff00;
+
+    return x | t;
+}
+
+/*
+    Composite a stamp with QPainter::CompositionMode_SourceOver
+    into an image with a premultiplied ( or opaque ) 32 bit format.
+ */
+static void qwtBlendStamp( const QwtSymbolStamp &stamp,
+    int x0, int y0, const QRect &clipRect, uchar *bits, int bytesPerLine )
+{
+    const QImage &image = stamp.image;
+
+    const int row1 = qMax( clipRect.top() - y0, 0 );
+    const int row2 = qMin( clipRect.bottom() - y0, image.height() - 1 );
+
+    const int col1 = clipRect.left() - x0;
+    const int col2 = clipRect.right() - x0;
+
+    for ( int row = row1; row <= row2; row++ )
+    {
+        const int c1 = qMax( stamp.firstColumn[row], col1 );
+        const int c2 = qMin( stamp.lastColumn[row], col2 );
+
+        if ( c1 > c2 )
+            continue;
+
+        const QRgb *src =
+            reinterpret_cast< const QRgb * >( image.constScanLine( row ) );
+
+        QRgb *dst = reinterpret_cast< QRgb * >(
+            bits + ( y0 + row ) * bytesPerLine ) + x0;
+
+        for ( int col = c1; col <= c2; col++ )
+        {
+            const QRgb s = src[col];
+            const uint alpha = qAlpha( s );
+
+            if ( alpha == 255 )
+                dst[col] = s;
+            else if ( alpha != 0 )
+                dst[col] = s + qwtByteMul( dst[col], 255 - alpha );
+        }
+    }
+}
+
+/*
+    The image of the paint device, when symbols can be
+    composited directly into its pixels
+ */
+static QImage *qwtRasterImage( const QPainter *painter )
+{
+    QPaintDevice *device = painter->device();
+    if ( device == NULL || device->devType() != QInternal::Image )
+        return NULL;
+
+    QImage *image = static_cast< QImage * >( device );
+
+    if ( image->format() != QImage::Format_ARGB32_Premultiplied
+        && image->format() != QImage::Format_RGB32 )
+    {
+        return NULL;
+    }
+
+#if QT_VERSION >= 0x050000
+    if ( image->devicePixelRatio() != 1.0 )
+        return NULL;
+#endif
+
+    if ( painter->compositionMode() != QPainter::CompositionMode_SourceOver
+        || painter->opacity() < 1.0 )
+    {
+        return NULL;
+    }
+
+    if ( painter->deviceTransform().type() > QTransform::TxTranslate )
+        return NULL;
+
+    return image;
+}
+
+namespace
+{
+    // compositing the stamps in horizontal bands of the image
+    class QwtStampJob: public QwtRenderJob
+    {
+    public:
+        QwtStampJob( const QVector< QwtSymbolStamp > &stamps,
+                const QVector< QwtStampPosition > &positions,
+                const QRect &clipRect, int numBands, QImage *image ):
+            d_stamps( stamps ),
+            d_positions( positions ),
+            d_bits( image->bits() ),
+            d_bytesPerLine( image->bytesPerLine() )
+        {
+            const int bandHeight = qMax(
+                qwtCeil( double( clipRect.height() ) / numBands ), 1 );
+
+            for ( int y = clipRect.top(); y <= clipRect.bottom(); y += bandHeight )
+            {
+                d_bandRects += QRect( clipRect.left(), y, clipRect.width(),
+                    qMin( bandHeight, clipRect.bottom() - y + 1 ) );
+            }
+
+            d_bands.resize( d_bandRects.size() );
+
+            for ( int i = 0; i < positions.size(); i++ )
+            {
+                const QwtStampPosition &pos = positions[i];
+                const int h = stamps[ pos.variant ].image.height();
+
+                const int y1 = qMax( pos.y, clipRect.top() );
+                const int y2 = qMin( pos.y + h - 1, clipRect.bottom() );
+
+                const int band1 = ( y1 - clipRect.top() ) / bandHeight;
+                const int band2 = ( y2 - clipRect.top() ) / bandHeight;
+
+                for ( int band = band1; band <= band2; band++ )
+                    d_bands[band] += i;
+            }
+        }
+
+        virtual int numTiles() const QWT_OVERRIDE
+        {
+            return d_bands.size();
+        }
+
+        virtual void renderTile( int index ) QWT_OVERRIDE
+        {
+            const QVector< int > &band = d_bands[index];
+            const QRect &bandRect = d_bandRects[index];
+
+            for ( int i = 0; i < band.size(); i++ )
+            {
+                const QwtStampPosition &pos = d_positions[ band[i] ];
+
+                qwtBlendStamp( d_stamps[ pos.variant ], pos.x, pos.y,
+                    bandRect, d_bits, d_bytesPerLine );
+            }
+        }
+
+    private:
+        const QVector< QwtSymbolStamp > &d_stamps;
+        const QVector< QwtStampPosition > &d_positions;
+
+        uchar *d_bits;
+        const int d_bytesPerLine;
+
+        QVector< QRect > d_bandRects;
+        QVector< QVector< int > > d_bands;
+    };
+}
+
 class QwtSymbol::PrivateData
 {
 public:
@@ -776,9 +1011,12 @@ public:
         size( sz ),
         brush( br ),
         pen( pn ),
-        isPinPointEnabled( false )
+        isPinPointEnabled( false ),
+        renderThreadCount( 1 )
     {
         cache.policy = QwtSymbol::AutoCache;
+        cache.subPixels = 0;
+        cache.pixelMatrix = NULL;
 #ifndef QWT_NO_SVG
         svg.renderer = NULL;
 #endif
@@ -789,6 +1027,7 @@ public:
 #ifndef QWT_NO_SVG
         delete svg.renderer;
 #endif
+        delete cache.pixelMatrix;
     }
 
     Style style;
@@ -799,6 +1038,8 @@ public:
     bool isPinPointEnabled;
     QPointF pinPoint;
 
+    uint renderThreadCount;
+
     struct Path
     {
         QPainterPath path;
@@ -830,6 +1071,16 @@ public:
         QwtSymbol::CachePolicy policy;
         QPixmap pixmap;
 
+        /*
+            Stamps for compositing into images: one for each
+            sub-pixel position ( subPixels x subPixels ), created on demand
+         */
+        QVector< QwtSymbolStamp > stamps;
+        int subPixels;
+
+        // for filtering duplicates, all bits are cleared after each batch
+        QwtPixelMatrix *pixelMatrix;
+
     } cache;
 };
 
@@ -915,6 +1166,35 @@ QwtSymbol::CachePolicy QwtSymbol::cachePolicy() const
     return d_data->cache.policy;
 }
 
+/*!
+   \brief Set the number of threads for compositing symbols
+
+   When symbols are composited into the pixels of a QImage
+   ( see drawSymbols() ) large batches can be split into horizontal
+   bands, that are processed by the threads of QwtRenderScheduler.
+
+   \param numThreads Number of threads to be used for rendering.
+                     If numThreads is set to 0, the system specific
+                     ideal thread count is used.
+
+   The default thread count is 1 ( = no additional threads )
+
+   \sa renderThreadCount(), QwtPlotItem::setRenderThreadCount()
+*/
+void QwtSymbol::setRenderThreadCount( uint numThreads )
+{
+    d_data->renderThreadCount = numThreads;
+}
+
+/*!
+   \return Number of threads to be used for compositing symbols.
+   \sa setRenderThreadCount()
+*/
+uint QwtSymbol::renderThreadCount() const
+{
+    return d_data->renderThreadCount;
+}
+
 /*!
   \brief Set a painter path as symbol
 
@@ -1301,9 +1581,18 @@ bool QwtSymbol::isPinPointEnabled() const
   one by one, as a couple of layout calculations and setting of pen/brush
   can be done once for the complete array.
 
+  When the symbol is cached and painted to a QImage with a
+  premultiplied ( or opaque ) 32 bit format, the symbol is
+  prerendered into a stamp, that is composited directly into the
+  pixels of the image. For antialiased symbols there are stamps
+  for 4x4 sub-pixel positions. Symbols, that would be composited
+  with the same stamp at the same position, are drawn only once.
+
   \param painter Painter
   \param points Array of points
   \param numPoints Number of points
+
+  \sa setCachePolicy(), setRenderThreadCount()
 */
 void QwtSymbol::drawSymbols( QPainter *painter,
     const QPointF *points, int numPoints ) const
@@ -1384,6 +1673,9 @@ void QwtSymbol::drawSymbols( QPainter *painter,
         }
     }
 
+    if ( useCache && blitSymbols( painter, points, numPoints ) )
+        return;
+
     if ( useCache )
     {
         const QRect br = boundingRect();
@@ -1420,6 +1712,173 @@ void QwtSymbol::drawSymbols( QPainter *painter,
     }
 }
 
+/*
+  Composite the symbols into the pixels of the image, the painter
+  is operating on. Returns false, when the paint device or the
+  state of the painter don't allow it.
+ */
+bool QwtSymbol::blitSymbols( QPainter *painter,
+    const QPointF *points, int numPoints ) const
+{
+    QImage *image = qwtRasterImage( painter );
+    if ( image == NULL )
+        return false;
+
+    const QTransform transform = painter->deviceTransform();
+
+    QRect clipRect = image->rect();
+    if ( painter->hasClipping() )
+    {
+        const QRegion clipRegion = transform.map( painter->clipRegion() );
+        if ( clipRegion.rectCount() > 1 )
+            return false;
+
+        clipRect &= clipRegion.boundingRect();
+    }
+
+    if ( clipRect.isEmpty() )
+        return true;
+
+    PrivateData::PaintCache &cache = d_data->cache;
+
+    if ( cache.subPixels == 0 )
+    {
+        // sub-pixel positions make a difference for antialiased symbols only
+
+        cache.subPixels = painter->testRenderHint( QPainter::Antialiasing )
+            ? qwtSubPixels : 1;
+
+        cache.stamps.resize( cache.subPixels * cache.subPixels );
+    }
+
+    const int subPixels = cache.subPixels;
+
+    const QRect br = boundingRect();
+
+    QSize stampSize = br.size();
+    if ( subPixels > 1 )
+        stampSize += QSize( 1, 1 );
+
+    /*
+        The positions of the stamps, that intersect with the clip rectangle,
+        in a grid of sub-pixels. Each grid point corresponds to a position
+        and a stamp.
+     */
+
+    const QRect gridRect(
+        ( clipRect.left() - stampSize.width() + 1 ) * subPixels,
+        ( clipRect.top() - stampSize.height() + 1 ) * subPixels,
+        ( clipRect.width() + stampSize.width() - 1 ) * subPixels,
+        ( clipRect.height() + stampSize.height() - 1 ) * subPixels );
+
+    QwtPixelMatrix *matrix = NULL;
+
+    if ( double( gridRect.width() ) * gridRect.height() <= ( 1 << 27 ) )
+    {
+        if ( cache.pixelMatrix == NULL )
+            cache.pixelMatrix = new QwtPixelMatrix( gridRect );
+        else if ( cache.pixelMatrix->rect() != gridRect )
+            cache.pixelMatrix->setRect( gridRect );
+
+        matrix = cache.pixelMatrix;
+    }
+
+    const double dx = ( transform.dx() + br.left() ) * subPixels + 0.5;
+    const double dy = ( transform.dy() + br.top() ) * subPixels + 0.5;
+
+    const double x1 = gridRect.left();
+    const double x2 = gridRect.right() + 1;
+    const double y1 = gridRect.top();
+    const double y2 = gridRect.bottom() + 1;
+
+    QVector< QwtStampPosition > positions;
+    positions.reserve( numPoints );
+
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        const double x = points[i].x() * subPixels + dx;
+        const double y = points[i].y() * subPixels + dy;
+
+        // also NaNs
+        if ( !( x >= x1 && x < x2 && y >= y1 && y < y2 ) )
+            continue;
+
+        const int gx = qwtFloor( x );
+        const int gy = qwtFloor( y );
+
+        if ( matrix && matrix->testAndSetPixel( gx, gy, true ) )
+            continue;
+
+        QwtStampPosition pos;
+        pos.x = qwtFloorDiv( gx, subPixels );
+        pos.y = qwtFloorDiv( gy, subPixels );
+        pos.variant = ( gy - pos.y * subPixels ) * subPixels
+            + ( gx - pos.x * subPixels );
+
+        QwtSymbolStamp &stamp = cache.stamps[ pos.variant ];
+        if ( stamp.image.isNull() )
+        {
+            QImage stampImage( stampSize, QImage::Format_ARGB32_Premultiplied );
+            stampImage.fill( Qt::transparent );
+
+            const QPointF center(
+                -br.left() + double( pos.variant % subPixels ) / subPixels,
+                -br.top() + double( pos.variant / subPixels ) / subPixels );
+
+            QPainter p( &stampImage );
+            p.setRenderHints( painter->renderHints() );
+            renderSymbols( &p, &center, 1 );
+            p.end();
+
+            stamp = QwtSymbolStamp( stampImage );
+        }
+
+        positions += pos;
+    }
+
+    int numThreads = int( d_data->renderThreadCount );
+    if ( numThreads <= 0 )
+        numThreads = QThread::idealThreadCount();
+
+    if ( numThreads > 1 && positions.size() >= qwtMinParallelStamps )
+    {
+        QwtStampJob job( cache.stamps, positions,
+            clipRect, 4 * numThreads, image );
+
+        QwtRenderScheduler::run( job, numThreads );
+    }
+    else
+    {
+        uchar *bits = image->bits();
+        const int bytesPerLine = image->bytesPerLine();
+
+        for ( int i = 0; i < positions.size(); i++ )
+        {
+            const QwtStampPosition &pos = positions[i];
+
+            qwtBlendStamp( cache.stamps[ pos.variant ], pos.x, pos.y,
+                clipRect, bits, bytesPerLine );
+        }
+    }
+
+    if ( matrix )
+    {
+        // resetting the bits for the next batch
+
+        for ( int i = 0; i < positions.size(); i++ )
+        {
+            const QwtStampPosition &pos = positions[i];
+
+            const int gx = pos.x * subPixels + pos.variant % subPixels;
+            const int gy = pos.y * subPixels + pos.variant / subPixels;
+
+            matrix->clearBit( matrix->index( gx, gy ) );
+        }
+    }
+
+    return true;
+}
+
 /*!
   \brief Draw the symbol into a rectangle
 
@@ -1772,6 +2231,9 @@ void QwtSymbol::invalidateCache()
 {
     if ( !d_data->cache.pixmap.isNull() )
         d_data->cache.pixmap = QPixmap();
+
+    d_data->cache.stamps.clear();
+    d_data->cache.subPixels = 0;
 }
 
 /*!
@@ -138,6 +138,9 @@ public:
       But the opposite can be expected for graphic pipelines
       that can make use of hardware acceleration.
 
+      When painting to a QImage the cached symbol is composited
+      directly into the pixels of the image ( see drawSymbols() ).
+
       The default setting is AutoCache
 
       \sa setCachePolicy(), cachePolicy()
@@ -174,6 +177,9 @@ public:
     void setCachePolicy( CachePolicy );
     CachePolicy cachePolicy() const;
 
+    void setRenderThreadCount( uint numThreads );
+    uint renderThreadCount() const;
+
     void setSize( const QSize & );
     void setSize( int width, int height = -1 );
     const QSize &size() const;
@@ -225,6 +231,8 @@ protected:
 private:
     Q_DISABLE_COPY(QwtSymbol)
 
+    bool blitSymbols( QPainter *, const QPointF *, int numPoints ) const;
+
     class PrivateData;
     PrivateData *d_data;
 };
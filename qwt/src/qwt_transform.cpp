@@ -10,6 +10,8 @@
 #include "qwt_transform.h"
 #include "qwt_math.h"
 
+#include <cstring>
+
 //! Smallest allowed value for logarithmic scales: 1.0e-150
 const double QwtLogTransform::LogMin = 1.0e-150;
 
@@ -35,6 +37,44 @@ double QwtTransform::bounded( double value ) const
     return value;
 }
 
+/*!
+  \brief Transform an array of values
+
+  The default implementation calls transform() for each value.
+
+  \param values Values to be transformed
+  \param result Array for the transformed values,
+                might be the same as values
+  \param count Number of values
+
+  \sa invTransformValues(), QwtScaleMap::transform()
+ */
+void QwtTransform::transformValues( const double *values,
+    double *result, size_t count ) const
+{
+    for ( size_t i = 0; i < count; i++ )
+        result[i] = transform( values[i] );
+}
+
+/*!
+  \brief Inverse transform an array of values
+
+  The default implementation calls invTransform() for each value.
+
+  \param values Values to be transformed
+  \param result Array for the transformed values,
+                might be the same as values
+  \param count Number of values
+
+  \sa transformValues(), QwtScaleMap::invTransform()
+ */
+void QwtTransform::invTransformValues( const double *values,
+    double *result, size_t count ) const
+{
+    for ( size_t i = 0; i < count; i++ )
+        result[i] = invTransform( values[i] );
+}
+
 //! Constructor
 QwtNullTransform::QwtNullTransform():
     QwtTransform()
@@ -64,6 +104,30 @@ double QwtNullTransform::invTransform( double value ) const
     return value;
 }
 
+/*!
+  \param values Values to be transformed
+  \param result Array for the unmodified values
+  \param count Number of values
+ */
+void QwtNullTransform::transformValues( const double *values,
+    double *result, size_t count ) const
+{
+    if ( result != values )
+        std::memmove( result, values, count * sizeof( double ) );
+}
+
+/*!
+  \param values Values to be transformed
+  \param result Array for the unmodified values
+  \param count Number of values
+ */
+void QwtNullTransform::invTransformValues( const double *values,
+    double *result, size_t count ) const
+{
+    if ( result != values )
+        std::memmove( result, values, count * sizeof( double ) );
+}
+
 //! \return Clone of the transformation
 QwtTransform *QwtNullTransform::copy() const
 {
@@ -99,6 +163,30 @@ double QwtLogTransform::invTransform( double value ) const
     return std::exp( value );
 }
 
+/*!
+  \param values Values to be transformed
+  \param result Array for log( value )
+  \param count Number of values
+ */
+void QwtLogTransform::transformValues( const double *values,
+    double *result, size_t count ) const
+{
+    for ( size_t i = 0; i < count; i++ )
+        result[i] = std::log( values[i] );
+}
+
+/*!
+  \param values Values to be transformed
+  \param result Array for exp( value )
+  \param count Number of values
+ */
+void QwtLogTransform::invTransformValues( const double *values,
+    double *result, size_t count ) const
+{
+    for ( size_t i = 0; i < count; i++ )
+        result[i] = std::exp( values[i] );
+}
+
 /*!
   \param value Value to be bounded
   \return qBound( LogMin, value, LogMax )
@@ -154,6 +242,46 @@ double QwtPowerTransform::invTransform( double value ) const
         return std::pow( value, d_exponent );
 }
 
+/*!
+  \param values Values to be transformed
+  \param result Array for the exponentiations preserving the sign
+  \param count Number of values
+ */
+void QwtPowerTransform::transformValues( const double *values,
+    double *result, size_t count ) const
+{
+    const double exponent = 1.0 / d_exponent;
+
+    for ( size_t i = 0; i < count; i++ )
+    {
+        const double value = values[i];
+        if ( value < 0.0 )
+            result[i] = -std::pow( -value, exponent );
+        else
+            result[i] = std::pow( value, exponent );
+    }
+}
+
+/*!
+  \param values Values to be transformed
+  \param result Array for the inverse exponentiations preserving the sign
+  \param count Number of values
+ */
+void QwtPowerTransform::invTransformValues( const double *values,
+    double *result, size_t count ) const
+{
+    const double exponent = d_exponent;
+
+    for ( size_t i = 0; i < count; i++ )
+    {
+        const double value = values[i];
+        if ( value < 0.0 )
+            result[i] = -std::pow( -value, exponent );
+        else
+            result[i] = std::pow( value, exponent );
+    }
+}
+
 //! \return Clone of the transformation
 QwtTransform *QwtPowerTransform::copy() const
 {
@@ -31,6 +31,20 @@
 
    - p = p1 + ( p2 - p1 ) * ( T( s ) - T( s1 ) / ( T( s2 ) - T( s1 ) );
    - s = invT ( T( s1 ) + ( T( s2 ) - T( s1 ) ) * ( p - p1 ) / ( p2 - p1 ) );
+
+   For mapping arrays of values QwtScaleMap uses transformValues()
+   and invTransformValues(). Their default implementations
+   call transform()/invTransform() for each value, but
+   derived classes should overload them without the costs of
+   a virtual call per value.
+
+   The results of transformValues()/invTransformValues() have to be
+   the same as calling transform()/invTransform() for each value.
+   So a class, that reimplements transform() or invTransform()
+   of a base class with optimized array versions - like QwtLogTransform -,
+   has to reimplement transformValues() and invTransformValues() as well.
+   F.e. by calling QwtTransform::transformValues() and
+   QwtTransform::invTransformValues(), that map the values one by one.
 */
 class QWT_EXPORT QwtTransform
 {
@@ -50,7 +64,10 @@ public:
         \param value Value
         \return Modified value
 
-        \sa invTransform()
+        \note A derived class, that reimplements transform(),
+              has to reimplement transformValues() as well.
+
+        \sa invTransform(), transformValues()
      */
     virtual double transform( double value ) const = 0;
 
@@ -60,10 +77,19 @@ public:
         \param value Value
         \return Modified value
 
-        \sa transform()
+        \note A derived class, that reimplements invTransform(),
+              has to reimplement invTransformValues() as well.
+
+        \sa transform(), invTransformValues()
      */
     virtual double invTransform( double value ) const = 0;
 
+    virtual void transformValues( const double *values,
+        double *result, size_t count ) const;
+
+    virtual void invTransformValues( const double *values,
+        double *result, size_t count ) const;
+
     //! Virtualized copy operation
     virtual QwtTransform *copy() const = 0;
 
@@ -86,6 +112,12 @@ public:
     virtual double transform( double value ) const QWT_OVERRIDE;
     virtual double invTransform( double value ) const QWT_OVERRIDE;
 
+    virtual void transformValues( const double *values,
+        double *result, size_t count ) const QWT_OVERRIDE;
+
+    virtual void invTransformValues( const double *values,
+        double *result, size_t count ) const QWT_OVERRIDE;
+
     virtual QwtTransform *copy() const QWT_OVERRIDE;
 };
 /*!
@@ -106,6 +138,12 @@ public:
     virtual double transform( double value ) const QWT_OVERRIDE;
     virtual double invTransform( double value ) const QWT_OVERRIDE;
 
+    virtual void transformValues( const double *values,
+        double *result, size_t count ) const QWT_OVERRIDE;
+
+    virtual void invTransformValues( const double *values,
+        double *result, size_t count ) const QWT_OVERRIDE;
+
     virtual double bounded( double value ) const QWT_OVERRIDE;
 
     virtual QwtTransform *copy() const QWT_OVERRIDE;
@@ -131,6 +169,12 @@ public:
     virtual double transform( double value ) const QWT_OVERRIDE;
     virtual double invTransform( double value ) const QWT_OVERRIDE;
 
+    virtual void transformValues( const double *values,
+        double *result, size_t count ) const QWT_OVERRIDE;
+
+    virtual void invTransformValues( const double *values,
+        double *result, size_t count ) const QWT_OVERRIDE;
+
     virtual QwtTransform *copy() const QWT_OVERRIDE;
 
 private:
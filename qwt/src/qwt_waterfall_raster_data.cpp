@@ -0,0 +1,418 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#include "qwt_waterfall_raster_data.h"
+#include "qwt_interval.h"
+
+#include <qvector.h>
+#include <qrect.h>
+#include <qnumeric.h>
+#include <qmath.h>
+
+#include <cstring>
+
+class QwtWaterfallRasterData::PrivateData
+{
+public:
+    PrivateData():
+        numColumns( 0 ),
+        maxRows( 0 ),
+        rowStep( 1.0 ),
+        numRows( 0 ),
+        numAppendedRows( 0 )
+    {
+    }
+
+    inline const double *row( qint64 index ) const
+    {
+        const int slot = int( index % maxRows );
+        return buffer.constData() + slot * numColumns;
+    }
+
+    // the row of a Y coordinate, or -1, when there is none
+    inline qint64 rowIndex( double y ) const
+    {
+        if ( numRows == 0 || qIsNaN( y ) )
+            return -1;
+
+        const qint64 first = numAppendedRows - numRows;
+
+        const double pos = y / rowStep;
+        if ( pos < first || pos >= numAppendedRows )
+            return -1;
+
+        return qint64( std::floor( pos ) );
+    }
+
+    inline int column( double x ) const
+    {
+        const double dx = xInterval.width() / numColumns;
+
+        int col = int( ( x - xInterval.minValue() ) / dx );
+        if ( col >= numColumns )
+            col = numColumns - 1;
+
+        return col;
+    }
+
+    int numColumns;
+    int maxRows;
+    double rowStep;
+
+    QwtInterval xInterval;
+    QwtInterval zInterval;
+
+    // ring buffer of maxRows rows
+    QVector<double> buffer;
+
+    int numRows;
+    qint64 numAppendedRows;
+};
+
+/*!
+  \brief Constructor
+
+  \param numColumns Number of values of a row
+  \param maxRows Maximum number of rows
+
+  \sa setNumColumns(), setMaxRows()
+ */
+QwtWaterfallRasterData::QwtWaterfallRasterData( int numColumns, int maxRows )
+{
+    d_data = new PrivateData();
+
+    d_data->numColumns = qMax( numColumns, 0 );
+    d_data->maxRows = qMax( maxRows, 0 );
+    d_data->buffer.resize( d_data->numColumns * d_data->maxRows );
+}
+
+//! Destructor
+QwtWaterfallRasterData::~QwtWaterfallRasterData()
+{
+    delete d_data;
+}
+
+/*!
+  \brief Set the number of values of a row
+
+  All rows are removed, when the number of columns changes.
+
+  \param numColumns Number of columns
+  \sa numColumns(), clear()
+ */
+void QwtWaterfallRasterData::setNumColumns( int numColumns )
+{
+    numColumns = qMax( numColumns, 0 );
+    if ( numColumns != d_data->numColumns )
+    {
+        d_data->numColumns = numColumns;
+
+        d_data->buffer.clear();
+        d_data->buffer.resize( d_data->numColumns * d_data->maxRows );
+
+        d_data->numRows = 0;
+    }
+}
+
+//! \return Number of values of a row
+int QwtWaterfallRasterData::numColumns() const
+{
+    return d_data->numColumns;
+}
+
+/*!
+  \brief Set the capacity of the ring buffer
+
+  The most recent rows are kept, when the number of
+  rows is reduced.
+
+  \param maxRows Maximum number of rows
+  \sa maxRows(), appendRow()
+ */
+void QwtWaterfallRasterData::setMaxRows( int maxRows )
+{
+    maxRows = qMax( maxRows, 0 );
+    if ( maxRows == d_data->maxRows )
+        return;
+
+    const int numRows = qMin( d_data->numRows, maxRows );
+    const int numColumns = d_data->numColumns;
+
+    QVector<double> buffer( numColumns * maxRows );
+
+    for ( qint64 i = d_data->numAppendedRows - numRows;
+        i < d_data->numAppendedRows; i++ )
+    {
+        const int slot = int( i % maxRows );
+
+        std::memcpy( buffer.data() + slot * numColumns,
+            d_data->row( i ), numColumns * sizeof( double ) );
+    }
+
+    d_data->buffer = buffer;
+    d_data->maxRows = maxRows;
+    d_data->numRows = numRows;
+}
+
+//! \return Maximum number of rows
+int QwtWaterfallRasterData::maxRows() const
+{
+    return d_data->maxRows;
+}
+
+/*!
+  \brief Set the distance between two rows in Y direction
+
+  F.e. the time between two spectra. The default setting is 1.0.
+
+  \param step Distance between two rows
+  \sa rowStep(), interval()
+ */
+void QwtWaterfallRasterData::setRowStep( double step )
+{
+    if ( step > 0.0 )
+        d_data->rowStep = step;
+}
+
+/*!
+  \return Distance between two rows in Y direction
+  \sa setRowStep()
+ */
+double QwtWaterfallRasterData::rowStep() const
+{
+    return d_data->rowStep;
+}
+
+/*!
+  \brief Assign the bounding interval for the X or Z axis
+
+  The interval of the Y axis is calculated from the
+  rows in the buffer and can't be set.
+
+  \param axis X or Z axis
+  \param interval Interval
+
+  \sa interval()
+*/
+void QwtWaterfallRasterData::setInterval(
+    Qt::Axis axis, const QwtInterval &interval )
+{
+    if ( axis == Qt::XAxis )
+        d_data->xInterval = interval;
+    else if ( axis == Qt::ZAxis )
+        d_data->zInterval = interval;
+}
+
+/*!
+  \return Bounding interval for an axis
+
+  The interval of the Y axis starts at the oldest row in
+  the buffer and ends after the most recent one.
+
+  \sa setInterval(), rowStep()
+ */
+QwtInterval QwtWaterfallRasterData::interval( Qt::Axis axis ) const
+{
+    switch( axis )
+    {
+        case Qt::XAxis:
+            return d_data->xInterval;
+
+        case Qt::YAxis:
+        {
+            if ( d_data->numRows == 0 )
+                return QwtInterval();
+
+            const qint64 first = d_data->numAppendedRows - d_data->numRows;
+
+            // the upper border is the beginning of the next row
+            return QwtInterval( first * d_data->rowStep,
+                d_data->numAppendedRows * d_data->rowStep,
+                QwtInterval::ExcludeMaximum );
+        }
+
+        case Qt::ZAxis:
+            return d_data->zInterval;
+    }
+
+    return QwtInterval();
+}
+
+/*!
+  \brief Append a row
+
+  When the buffer is full, the oldest row is overwritten.
+
+  \param values numColumns() values
+  \sa numRows(), maxRows()
+ */
+void QwtWaterfallRasterData::appendRow( const double *values )
+{
+    if ( d_data->maxRows == 0 )
+        return;
+
+    const int slot = int( d_data->numAppendedRows % d_data->maxRows );
+
+    std::memcpy( d_data->buffer.data() + slot * d_data->numColumns,
+        values, d_data->numColumns * sizeof( double ) );
+
+    d_data->numAppendedRows++;
+    d_data->numRows = qMin( d_data->numRows + 1, d_data->maxRows );
+}
+
+/*!
+  \brief Append a row
+
+  Missing values are filled with NaN, additional
+  values are ignored.
+
+  \param values Values of the row
+  \sa numRows(), maxRows()
+ */
+void QwtWaterfallRasterData::appendRow( const QVector<double> &values )
+{
+    if ( values.size() >= d_data->numColumns )
+    {
+        appendRow( values.constData() );
+    }
+    else
+    {
+        QVector<double> row = values;
+        row.resize( d_data->numColumns );
+
+        for ( int i = values.size(); i < row.size(); i++ )
+            row[i] = qQNaN();
+
+        appendRow( row.constData() );
+    }
+}
+
+/*!
+  \brief Remove all rows
+
+  The numbering of rows starts again with 0.
+  \sa appendRow()
+ */
+void QwtWaterfallRasterData::clear()
+{
+    d_data->numRows = 0;
+    d_data->numAppendedRows = 0;
+}
+
+//! \return Number of rows in the buffer
+int QwtWaterfallRasterData::numRows() const
+{
+    return d_data->numRows;
+}
+
+/*!
+  \return Number of rows, that have been appended since
+          the last clear(), including the ones, that have
+          already been overwritten.
+ */
+qint64 QwtWaterfallRasterData::numAppendedRows() const
+{
+    return d_data->numAppendedRows;
+}
+
+/*!
+  \param index Number of the row
+  \return Values of the row, or NULL when the row is not in the buffer
+ */
+const double *QwtWaterfallRasterData::row( qint64 index ) const
+{
+    if ( index < d_data->numAppendedRows - d_data->numRows
+        || index >= d_data->numAppendedRows )
+    {
+        return NULL;
+    }
+
+    return d_data->row( index );
+}
+
+/*!
+   \brief Pixel hint
+
+   The geometry of a value of the matrix.
+
+   \param area Requested area, ignored
+   \return Calculated hint
+
+   \sa QwtRasterData::pixelHint()
+*/
+QRectF QwtWaterfallRasterData::pixelHint( const QRectF &area ) const
+{
+    Q_UNUSED( area )
+
+    const QwtInterval &xInterval = d_data->xInterval;
+
+    if ( d_data->numColumns == 0 || !xInterval.isValid() )
+        return QRectF();
+
+    return QRectF( xInterval.minValue(), 0.0,
+        xInterval.width() / d_data->numColumns, d_data->rowStep );
+}
+
+/*!
+   \return the value at a raster position
+   \param x X value in plot coordinates
+   \param y Y value in plot coordinates
+
+   \sa values()
+*/
+double QwtWaterfallRasterData::value( double x, double y ) const
+{
+    const qint64 index = d_data->rowIndex( y );
+
+    if ( index < 0 || d_data->numColumns == 0
+        || !d_data->xInterval.contains( x ) )
+    {
+        return qQNaN();
+    }
+
+    return d_data->row( index )[ d_data->column( x ) ];
+}
+
+/*!
+   \brief Find the values for a row of raster positions
+
+   The row of the ring buffer is looked up once, what
+   makes each value a simple array access.
+
+   \param x Array of x values in plot coordinates
+   \param y y value in plot coordinates
+   \param result Array, where to store the values
+   \param count Number of values
+
+   \sa value()
+*/
+void QwtWaterfallRasterData::values( const double *x, double y,
+    double *result, int count ) const
+{
+    const qint64 index = d_data->rowIndex( y );
+
+    if ( index < 0 || d_data->numColumns == 0 )
+    {
+        for ( int i = 0; i < count; i++ )
+            result[i] = qQNaN();
+
+        return;
+    }
+
+    const double *row = d_data->row( index );
+    const QwtInterval &xInterval = d_data->xInterval;
+
+    for ( int i = 0; i < count; i++ )
+    {
+        if ( xInterval.contains( x[i] ) )
+            result[i] = row[ d_data->column( x[i] ) ];
+        else
+            result[i] = qQNaN();
+    }
+}
@@ -0,0 +1,98 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * Qwt Widget Library
+ * Copyright (C) 1997   Josef Wilgen
+ * Copyright (C) 2002   Uwe Rathmann
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the Qwt License, Version 1.0
+ *****************************************************************************/
+
+#ifndef QWT_WATERFALL_RASTER_DATA_H
+#define QWT_WATERFALL_RASTER_DATA_H
+
+#include "qwt_global.h"
+#include "qwt_raster_data.h"
+
+#if QT_VERSION < 0x060000
+template <typename T> class QVector;
+#endif
+
+/*!
+  \brief Raster data for waterfall displays
+
+  QwtWaterfallRasterData stores the most recent rows of values
+  ( f.e. the spectra of a FFT ) in a ring buffer. Appending a row
+  overwrites the oldest one, when the buffer is full, what is
+  done in O(numColumns()) - independent of the number of rows.
+
+  The rows are numbered from 0 in the order they have been appended.
+  The Y coordinate of a row is its number multiplied by rowStep(),
+  so that a row keeps its position, while the following rows are
+  appended. When the scale of the Y axis follows interval( Qt::YAxis ),
+  a QwtPlotSpectrogram with QwtPlotRasterItem::ScrollingCache
+  scrolls its cached image and renders the new rows only.
+
+  \code
+    QwtWaterfallRasterData *data = new QwtWaterfallRasterData( 1024, 500 );
+    data->setInterval( Qt::XAxis, QwtInterval( 0.0, sampleRate / 2 ) );
+    data->setInterval( Qt::ZAxis, QwtInterval( -120.0, 0.0 ) );
+
+    spectrogram->setData( data );
+    spectrogram->setCachePolicy( QwtPlotRasterItem::ScrollingCache );
+
+    ...
+
+    data->appendRow( spectrum );
+
+    const QwtInterval rows = data->interval( Qt::YAxis );
+    plot->setAxisScale( QwtPlot::yLeft, rows.maxValue(), rows.minValue() );
+    plot->replot();
+  \endcode
+
+  The values are resampled by nearest neighbour.
+
+  \note Like for all other raster data rows must not be appended,
+        while a plot item is rendering the data in a background thread.
+  \sa QwtMatrixRasterData, QwtPlotRasterItem::setCachePolicy()
+*/
+class QWT_EXPORT QwtWaterfallRasterData: public QwtRasterData
+{
+public:
+    explicit QwtWaterfallRasterData( int numColumns = 0, int maxRows = 0 );
+    virtual ~QwtWaterfallRasterData();
+
+    void setNumColumns( int );
+    int numColumns() const;
+
+    void setMaxRows( int );
+    int maxRows() const;
+
+    void setRowStep( double );
+    double rowStep() const;
+
+    void setInterval( Qt::Axis, const QwtInterval & );
+    virtual QwtInterval interval( Qt::Axis ) const QWT_OVERRIDE;
+
+    void appendRow( const double *values );
+    void appendRow( const QVector<double> & );
+
+    void clear();
+
+    int numRows() const;
+    qint64 numAppendedRows() const;
+
+    const double *row( qint64 index ) const;
+
+    virtual QRectF pixelHint( const QRectF & ) const QWT_OVERRIDE;
+
+    virtual double value( double x, double y ) const QWT_OVERRIDE;
+
+    virtual void values( const double *x, double y,
+        double *result, int count ) const QWT_OVERRIDE;
+
+private:
+    class PrivateData;
+    PrivateData *d_data;
+};
+
+#endif
@@ -34,6 +34,7 @@ HEADERS += \
     qwt_pixel_matrix.h \
     qwt_point_3d.h \
     qwt_point_polar.h \
+    qwt_render_scheduler.h \
     qwt_round_scale_draw.h \
     qwt_scale_div.h \
     qwt_scale_draw.h \
@@ -80,6 +81,7 @@ SOURCES += \
     qwt_pixel_matrix.cpp \
     qwt_point_3d.cpp \
     qwt_point_polar.cpp \
+    qwt_render_scheduler.cpp \
     qwt_round_scale_draw.cpp \
     qwt_scale_div.cpp \
     qwt_scale_draw.cpp \
@@ -144,15 +146,22 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_plot_zoomer.h \
         qwt_plot_magnifier.h \
         qwt_plot_rescaler.h \
+        qwt_plot_replot_scheduler.h \
         qwt_point_mapper.h \
         qwt_raster_data.h \
         qwt_matrix_raster_data.h \
+        qwt_waterfall_raster_data.h \
         qwt_vectorfield_symbol.h \
         qwt_sampling_thread.h \
         qwt_samples.h \
         qwt_series_data.h \
         qwt_series_store.h \
         qwt_point_data.h \
+        qwt_appendable_point_data.h \
+        qwt_lock_free_point_data.h \
+        qwt_pyramid_point_data.h \
+        qwt_mapped_data.h \
+        qwt_spatial_index.h \
         qwt_scale_widget.h 
 
     SOURCES += \
@@ -198,13 +207,20 @@ contains(QWT_CONFIG, QwtPlot) {
         qwt_plot_zoomer.cpp \
         qwt_plot_magnifier.cpp \
         qwt_plot_rescaler.cpp \
+        qwt_plot_replot_scheduler.cpp \
         qwt_point_mapper.cpp \
         qwt_raster_data.cpp \
         qwt_matrix_raster_data.cpp \
+        qwt_waterfall_raster_data.cpp \
         qwt_vectorfield_symbol.cpp \
         qwt_sampling_thread.cpp \
         qwt_series_data.cpp \
         qwt_point_data.cpp \
+        qwt_appendable_point_data.cpp \
+        qwt_lock_free_point_data.cpp \
+        qwt_pyramid_point_data.cpp \
+        qwt_mapped_data.cpp \
+        qwt_spatial_index.cpp \
         qwt_scale_widget.cpp
 
     contains(QWT_CONFIG, QwtOpenGL) {
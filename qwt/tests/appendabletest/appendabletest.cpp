@@ -0,0 +1,229 @@
+#include <qwt_appendable_point_data.h>
+
+#include <qvector.h>
+#include <qpoint.h>
+#include <qrect.h>
+#include <qnumeric.h>
+#include <qdebug.h>
+
+static int numErrors = 0;
+
+// deterministic pseudo random numbers in [0.0, 1.0[
+static double random01()
+{
+    static quint32 seed = 4711;
+    seed = seed * 1664525u + 1013904223u;
+
+    return ( seed >> 8 ) / double( 1 << 24 );
+}
+
+// random points with a few gaps
+static QPointF randomPoint()
+{
+    const double x = 2000.0 * random01() - 1000.0;
+    const double y = 2000.0 * random01() - 1000.0;
+
+    if ( random01() < 0.02 )
+        return QPointF( x, qQNaN() );
+
+    return QPointF( x, y );
+}
+
+/*
+   The bounding rectangle of the samples, calculated by iterating over
+   all of them. In opposite to qwtBoundingRect() samples with NaN
+   coordinates are gaps, that are ignored.
+ */
+static bool isBoundingRect( const QRectF &rect, const QwtSeriesData<QPointF> &series )
+{
+    double minX = 0.0, maxX = -1.0, minY = 0.0, maxY = -1.0;
+    bool isEmpty = true;
+
+    for ( size_t i = 0; i < series.size(); i++ )
+    {
+        const QPointF pos = series.sample( i );
+        if ( qIsNaN( pos.x() ) || qIsNaN( pos.y() ) )
+            continue;
+
+        if ( isEmpty )
+        {
+            minX = maxX = pos.x();
+            minY = maxY = pos.y();
+            isEmpty = false;
+        }
+        else
+        {
+            minX = qMin( minX, pos.x() );
+            maxX = qMax( maxX, pos.x() );
+            minY = qMin( minY, pos.y() );
+            maxY = qMax( maxY, pos.y() );
+        }
+    }
+
+    if ( isEmpty )
+        return rect.width() < 0.0 || rect.height() < 0.0;
+
+    const double eps = 1e-9;
+
+    return qAbs( rect.left() - minX ) < eps && qAbs( rect.right() - maxX ) < eps
+        && qAbs( rect.top() - minY ) < eps && qAbs( rect.bottom() - maxY ) < eps;
+}
+
+static bool isEqual( const QPointF &pos1, const QPointF &pos2 )
+{
+    // QPointF::operator==() is fuzzy and fails for NaNs
+
+    const bool xOk = ( pos1.x() == pos2.x() )
+        || ( qIsNaN( pos1.x() ) && qIsNaN( pos2.x() ) );
+    const bool yOk = ( pos1.y() == pos2.y() )
+        || ( qIsNaN( pos1.y() ) && qIsNaN( pos2.y() ) );
+
+    return xOk && yOk;
+}
+
+/*
+   Compares the series with the most recent capacity() points
+   of all points, that have been appended, and the bounding rectangle
+   with the one, that is calculated by iterating over the samples.
+ */
+static bool verifySeries( const QwtSeriesData<QPointF> &series,
+    size_t capacity, const QVector<QPointF> &points, const char *prompt )
+{
+    size_t expectedSize = points.size();
+    if ( capacity > 0 && expectedSize > capacity )
+        expectedSize = capacity;
+
+    if ( series.size() != expectedSize )
+    {
+        qDebug() << prompt << "capacity" << int( capacity ) << ": size"
+            << int( series.size() ) << "!=" << int( expectedSize );
+
+        numErrors++;
+        return false;
+    }
+
+    const int offset = points.size() - int( expectedSize );
+    for ( size_t i = 0; i < expectedSize; i++ )
+    {
+        if ( !isEqual( series.sample( i ), points[ offset + int( i ) ] ) )
+        {
+            qDebug() << prompt << "capacity" << int( capacity ) << ": sample"
+                << int( i ) << "is wrong";
+
+            numErrors++;
+            return false;
+        }
+    }
+
+    if ( !isBoundingRect( series.boundingRect(), series ) )
+    {
+        qDebug() << prompt << "capacity" << int( capacity ) << ": bounding rectangle"
+            << "after" << points.size() << "points is wrong";
+
+        numErrors++;
+        return false;
+    }
+
+    return true;
+}
+
+static void testAppendable( size_t capacity )
+{
+    const char *prompt = "QwtAppendablePointData";
+
+    QwtAppendablePointData data( capacity );
+    QVector<QPointF> points;
+
+    if ( !verifySeries( data, capacity, points, prompt ) )
+        return;
+
+    // single points, passing the wrap around several times
+
+    const int numPoints = int( 3 * capacity ) + 50;
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        const QPointF pos = randomPoint();
+
+        data.append( pos );
+        points += pos;
+
+        if ( !verifySeries( data, capacity, points, prompt ) )
+            return;
+    }
+
+    // blocks of different sizes, also larger than the capacity
+
+    const int blockSizes[] = { 2, 7, int( capacity ) + 3, 1 };
+    for ( size_t k = 0; k < sizeof( blockSizes ) / sizeof( blockSizes[0] ); k++ )
+    {
+        QVector<QPointF> block;
+        for ( int i = 0; i < blockSizes[k]; i++ )
+            block += randomPoint();
+
+        data.append( block );
+        points += block;
+
+        if ( !verifySeries( data, capacity, points, prompt ) )
+            return;
+    }
+
+    // the extremes leaving the buffer one by one
+
+    const QPointF extremes[] =
+    {
+        QPointF( -5000.0, 0.0 ), QPointF( 5000.0, 0.0 ),
+        QPointF( 0.0, -5000.0 ), QPointF( 0.0, 5000.0 )
+    };
+
+    for ( int i = 0; i < 4; i++ )
+    {
+        data.append( extremes[i] );
+        points += extremes[i];
+    }
+
+    for ( size_t i = 0; i < capacity + 4; i++ )
+    {
+        const QPointF pos = randomPoint();
+
+        data.append( pos );
+        points += pos;
+
+        if ( !verifySeries( data, capacity, points, prompt ) )
+            return;
+    }
+
+    // changing the capacity keeps the most recent points
+
+    const size_t capacities[] = { capacity / 2 + 1, capacity + 5, 0 };
+    for ( int i = 0; i < 3; i++ )
+    {
+        data.setCapacity( capacities[i] );
+
+        if ( capacities[i] > 0 && size_t( points.size() ) > capacities[i] )
+            points.erase( points.begin(), points.end() - int( capacities[i] ) );
+
+        if ( !verifySeries( data, capacities[i], points, prompt ) )
+            return;
+    }
+
+    data.clear();
+    points.clear();
+
+    verifySeries( data, 0, points, prompt );
+}
+
+int main()
+{
+    const size_t capacities[] = { 0, 1, 2, 7, 64, 100 };
+
+    for ( size_t i = 0; i < sizeof( capacities ) / sizeof( capacities[0] ); i++ )
+        testAppendable( capacities[i] );
+
+    if ( numErrors > 0 )
+    {
+        qDebug() << numErrors << "tests failed.";
+        return 1;
+    }
+
+    return 0;
+}
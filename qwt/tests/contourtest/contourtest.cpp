@@ -0,0 +1,188 @@
+#include <qwt_raster_data.h>
+#include <qwt_interval.h>
+
+#include <qpolygon.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <qlist.h>
+#include <qmap.h>
+#include <qnumeric.h>
+#include <qmath.h>
+#include <qdebug.h>
+
+#include <cmath>
+
+static int numErrors = 0;
+
+static void reportError( const char *algorithm, double level, const char *txt )
+{
+    qDebug() << algorithm << "level" << level << ":" << txt;
+    numErrors++;
+}
+
+/*
+   A cone, where the contour lines are circles around the origin
+   with the level as radius. The values inside of the hole
+   are undefined.
+ */
+class ConeData: public QwtRasterData
+{
+public:
+    explicit ConeData( double hole ):
+        d_hole( hole )
+    {
+    }
+
+    virtual QwtInterval interval( Qt::Axis axis ) const QWT_OVERRIDE
+    {
+        if ( axis == Qt::ZAxis )
+            return QwtInterval( 0.0, 15.0 );
+
+        return QwtInterval( -10.0, 10.0 );
+    }
+
+    virtual double value( double x, double y ) const QWT_OVERRIDE
+    {
+        const double r = std::sqrt( x * x + y * y );
+        return ( r < d_hole ) ? qQNaN() : r;
+    }
+
+private:
+    const double d_hole;
+};
+
+static inline double distance( const QPointF &p1, const QPointF &p2 )
+{
+    const double dx = p2.x() - p1.x();
+    const double dy = p2.y() - p1.y();
+
+    return std::sqrt( dx * dx + dy * dy );
+}
+
+static bool isOnCircle( const QPointF &pos, double radius, double tolerance )
+{
+    const double r = std::sqrt( pos.x() * pos.x() + pos.y() * pos.y() );
+    return std::fabs( r - radius ) <= tolerance;
+}
+
+/*
+   Conrec returns pairs of points for each line segment, while
+   the marching squares algorithm joins the segments to polylines.
+   Both have to find the same circles with the same lengths.
+ */
+static void testCone( double hole, const QList<double> &levels )
+{
+    const ConeData data( hole );
+
+    const QRectF rect( -10.0, -10.0, 20.0, 20.0 );
+    const QSize raster( 100, 100 );
+
+    // distance between the interpolated points and the exact circle
+    const double tolerance = 0.02;
+
+    const QwtRasterData::ContourLines conrec =
+        data.contourLines( rect, raster, levels, QwtRasterData::ConrecFlags() );
+
+    const QwtRasterData::ContourPolylines polylines =
+        data.contourPolylines( rect, raster, levels, QwtRasterData::ConrecFlags() );
+
+    for ( int l = 0; l < levels.size(); l++ )
+    {
+        const double level = levels[l];
+        const double circumference = 2.0 * M_PI * level;
+
+        const bool isVisible = level > hole;
+
+        // Conrec
+
+        const QPolygonF lines = conrec.value( level );
+        if ( !isVisible )
+        {
+            if ( !lines.isEmpty() )
+                reportError( "Conrec", level, "lines in an undefined area" );
+        }
+        else if ( lines.size() % 2 != 0 )
+        {
+            reportError( "Conrec", level, "odd number of points" );
+        }
+        else
+        {
+            double length = 0.0;
+            for ( int i = 0; i < lines.size(); i += 2 )
+            {
+                if ( !isOnCircle( lines[i], level, tolerance )
+                    || !isOnCircle( lines[i + 1], level, tolerance ) )
+                {
+                    reportError( "Conrec", level, "point not on the circle" );
+                    break;
+                }
+
+                length += distance( lines[i], lines[i + 1] );
+            }
+
+            if ( std::fabs( length - circumference ) > 0.01 * circumference )
+                reportError( "Conrec", level, "wrong length" );
+        }
+
+        // marching squares
+
+        const QList<QPolygonF> lineList = polylines.value( level );
+        if ( !isVisible )
+        {
+            if ( !lineList.isEmpty() )
+                reportError( "Marching Squares", level, "lines in an undefined area" );
+
+            continue;
+        }
+
+        if ( lineList.size() != 1 )
+        {
+            reportError( "Marching Squares", level, "circle not joined to one polyline" );
+            continue;
+        }
+
+        const QPolygonF &polyline = lineList.first();
+        if ( polyline.size() < 4 || polyline.first() != polyline.last() )
+        {
+            reportError( "Marching Squares", level, "polyline not closed" );
+            continue;
+        }
+
+        double length = 0.0;
+        for ( int i = 0; i < polyline.size(); i++ )
+        {
+            if ( !isOnCircle( polyline[i], level, tolerance ) )
+            {
+                reportError( "Marching Squares", level, "point not on the circle" );
+                break;
+            }
+
+            if ( i > 0 )
+                length += distance( polyline[i - 1], polyline[i] );
+        }
+
+        if ( std::fabs( length - circumference ) > 0.01 * circumference )
+            reportError( "Marching Squares", level, "wrong length" );
+    }
+}
+
+int main()
+{
+    QList<double> levels;
+    levels << 2.0 << 4.5 << 7.25 << 9.5;
+
+    testCone( 0.0, levels );
+
+    // a level, that is completely inside of the undefined area
+    levels.prepend( 0.5 );
+
+    testCone( 1.0, levels );
+
+    if ( numErrors > 0 )
+    {
+        qDebug() << numErrors << "tests failed.";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,289 @@
+#include <qwt_lock_free_point_data.h>
+
+#include <qvector.h>
+#include <qpoint.h>
+#include <qrect.h>
+#include <qnumeric.h>
+#include <qthread.h>
+#include <qdebug.h>
+
+static int numErrors = 0;
+
+// deterministic pseudo random numbers in [0.0, 1.0[
+static double random01()
+{
+    static quint32 seed = 4711;
+    seed = seed * 1664525u + 1013904223u;
+
+    return ( seed >> 8 ) / double( 1 << 24 );
+}
+
+// random points with a few gaps
+static QPointF randomPoint()
+{
+    const double x = 2000.0 * random01() - 1000.0;
+    const double y = 2000.0 * random01() - 1000.0;
+
+    if ( random01() < 0.02 )
+        return QPointF( x, qQNaN() );
+
+    return QPointF( x, y );
+}
+
+/*
+   The bounding rectangle of the samples, calculated by iterating over
+   all of them. In opposite to qwtBoundingRect() samples with NaN
+   coordinates are gaps, that are ignored.
+ */
+static bool isBoundingRect( const QRectF &rect, const QwtSeriesData<QPointF> &series )
+{
+    double minX = 0.0, maxX = -1.0, minY = 0.0, maxY = -1.0;
+    bool isEmpty = true;
+
+    for ( size_t i = 0; i < series.size(); i++ )
+    {
+        const QPointF pos = series.sample( i );
+        if ( qIsNaN( pos.x() ) || qIsNaN( pos.y() ) )
+            continue;
+
+        if ( isEmpty )
+        {
+            minX = maxX = pos.x();
+            minY = maxY = pos.y();
+            isEmpty = false;
+        }
+        else
+        {
+            minX = qMin( minX, pos.x() );
+            maxX = qMax( maxX, pos.x() );
+            minY = qMin( minY, pos.y() );
+            maxY = qMax( maxY, pos.y() );
+        }
+    }
+
+    if ( isEmpty )
+        return rect.width() < 0.0 || rect.height() < 0.0;
+
+    const double eps = 1e-9;
+
+    return qAbs( rect.left() - minX ) < eps && qAbs( rect.right() - maxX ) < eps
+        && qAbs( rect.top() - minY ) < eps && qAbs( rect.bottom() - maxY ) < eps;
+}
+
+static bool isEqual( const QPointF &pos1, const QPointF &pos2 )
+{
+    // QPointF::operator==() is fuzzy and fails for NaNs
+
+    const bool xOk = ( pos1.x() == pos2.x() )
+        || ( qIsNaN( pos1.x() ) && qIsNaN( pos2.x() ) );
+    const bool yOk = ( pos1.y() == pos2.y() )
+        || ( qIsNaN( pos1.y() ) && qIsNaN( pos2.y() ) );
+
+    return xOk && yOk;
+}
+
+/*
+   Compares the series with the most recent capacity() points
+   of all points, that have been appended, and the bounding rectangle
+   with the one, that is calculated by iterating over the samples.
+ */
+static bool verifySeries( const QwtSeriesData<QPointF> &series,
+    size_t capacity, const QVector<QPointF> &points, const char *prompt )
+{
+    size_t expectedSize = points.size();
+    if ( capacity > 0 && expectedSize > capacity )
+        expectedSize = capacity;
+
+    if ( series.size() != expectedSize )
+    {
+        qDebug() << prompt << "capacity" << int( capacity ) << ": size"
+            << int( series.size() ) << "!=" << int( expectedSize );
+
+        numErrors++;
+        return false;
+    }
+
+    const int offset = points.size() - int( expectedSize );
+    for ( size_t i = 0; i < expectedSize; i++ )
+    {
+        if ( !isEqual( series.sample( i ), points[ offset + int( i ) ] ) )
+        {
+            qDebug() << prompt << "capacity" << int( capacity ) << ": sample"
+                << int( i ) << "is wrong";
+
+            numErrors++;
+            return false;
+        }
+    }
+
+    if ( !isBoundingRect( series.boundingRect(), series ) )
+    {
+        qDebug() << prompt << "capacity" << int( capacity ) << ": bounding rectangle"
+            << "after" << points.size() << "points is wrong";
+
+        numErrors++;
+        return false;
+    }
+
+    return true;
+}
+
+static void testLockFree( size_t capacity )
+{
+    const char *prompt = "QwtLockFreePointData";
+
+    QwtLockFreePointData data( capacity, 16 );
+    QVector<QPointF> points;
+
+    // filling the ring buffer between the snapshots in different amounts
+
+    const int numPending[] = { 1, 5, 16, 3, 15, 16, 2 };
+    for ( int round = 0; round < 3; round++ )
+    {
+        for ( size_t k = 0; k < sizeof( numPending ) / sizeof( numPending[0] ); k++ )
+        {
+            for ( int i = 0; i < numPending[k]; i++ )
+            {
+                const QPointF pos = randomPoint();
+                if ( !data.append( pos ) )
+                {
+                    qDebug() << prompt << ": sample dropped before the buffer is full";
+                    numErrors++;
+                    return;
+                }
+
+                points += pos;
+            }
+
+            if ( data.updateSnapshot() != size_t( numPending[k] ) )
+            {
+                qDebug() << prompt << ": wrong number of new samples";
+                numErrors++;
+                return;
+            }
+
+            if ( !verifySeries( data, capacity, points, prompt ) )
+                return;
+        }
+    }
+
+    // overflow: the samples, that don't fit into the ring buffer are dropped
+
+    QVector<QPointF> block;
+    for ( int i = 0; i < 20; i++ )
+        block += randomPoint();
+
+    const size_t numAppended = data.append( block.constData(), block.size() );
+    const bool appended = data.append( randomPoint() );
+
+    if ( numAppended != 16 || appended || data.numDroppedSamples() != 5 )
+    {
+        qDebug() << prompt << ": wrong handling of a full ring buffer";
+        numErrors++;
+        return;
+    }
+
+    points += block.mid( 0, 16 );
+
+    data.updateSnapshot();
+    verifySeries( data, capacity, points, prompt );
+}
+
+namespace
+{
+    class Producer: public QThread
+    {
+    public:
+        Producer( QwtLockFreePointData *data, int numPoints ):
+            d_data( data ),
+            d_numPoints( numPoints ),
+            d_numAppended( 0 )
+        {
+        }
+
+        int numAppended() const
+        {
+            return d_numAppended;
+        }
+
+    protected:
+        virtual void run() QWT_OVERRIDE
+        {
+            for ( int i = 0; i < d_numPoints; i++ )
+            {
+                if ( d_data->append( QPointF( i, -i ) ) )
+                    d_numAppended++;
+            }
+        }
+
+    private:
+        QwtLockFreePointData *d_data;
+        const int d_numPoints;
+        int d_numAppended;
+    };
+}
+
+/*
+   A producer thread appending while the snapshots are collected.
+   Dropped samples are gaps in the sequence, but the samples, that
+   arrive, have to be complete and in order.
+ */
+static void testProducer()
+{
+    const char *prompt = "QwtLockFreePointData ( thread )";
+
+    QwtLockFreePointData data( 0, 64 );
+
+    Producer producer( &data, 100000 );
+    producer.start();
+
+    while ( !producer.isFinished() )
+        data.updateSnapshot();
+
+    producer.wait();
+    data.updateSnapshot();
+
+    if ( int( data.size() ) != producer.numAppended()
+        || int( data.size() ) + data.numDroppedSamples() != 100000 )
+    {
+        qDebug() << prompt << ": samples lost";
+        numErrors++;
+        return;
+    }
+
+    for ( size_t i = 0; i < data.size(); i++ )
+    {
+        const QPointF pos = data.sample( i );
+
+        if ( pos.y() != -pos.x() || ( i > 0 && pos.x() <= data.sample( i - 1 ).x() ) )
+        {
+            qDebug() << prompt << ": corrupted sample" << int( i );
+            numErrors++;
+            return;
+        }
+    }
+
+    if ( !isBoundingRect( data.boundingRect(), data ) )
+    {
+        qDebug() << prompt << ": bounding rectangle is wrong";
+        numErrors++;
+    }
+}
+
+int main()
+{
+    const size_t capacities[] = { 0, 1, 2, 7, 64, 100 };
+
+    for ( size_t i = 0; i < sizeof( capacities ) / sizeof( capacities[0] ); i++ )
+        testLockFree( capacities[i] );
+
+    testProducer();
+
+    if ( numErrors > 0 )
+    {
+        qDebug() << numErrors << "tests failed.";
+        return 1;
+    }
+
+    return 0;
+}
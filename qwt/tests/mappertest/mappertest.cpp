@@ -0,0 +1,248 @@
+#include <qwt_point_mapper.h>
+#include <qwt_scale_map.h>
+#include <qwt_series_data.h>
+
+#include <qvector.h>
+#include <qpolygon.h>
+#include <qnumeric.h>
+#include <qdebug.h>
+
+#include <cmath>
+
+static int numErrors = 0;
+
+// deterministic pseudo random numbers in [0.0, 1.0[
+static double random01()
+{
+    static quint32 seed = 4711;
+    seed = seed * 1664525u + 1013904223u;
+
+    return ( seed >> 8 ) / double( 1 << 24 );
+}
+
+static inline bool isGap( const QPointF &pos )
+{
+    return qIsNaN( pos.x() ) || qIsNaN( pos.y() );
+}
+
+static inline bool isEqual( const QPointF &pos1, const QPointF &pos2 )
+{
+    return pos1.x() == pos2.x() && pos1.y() == pos2.y();
+}
+
+// the same rounding as QwtPointMapper
+static inline double roundValue( double value )
+{
+    return ( value >= 0.0 ) ? std::floor( value + 0.5 ) : std::ceil( value - 0.5 );
+}
+
+/*
+   A polyline, where one coordinate is increasing with the index, while
+   the other one is a random walk. Some samples are interrupted by gaps.
+ */
+static QVector<QPointF> createSamples( bool columns, int numPoints )
+{
+    QVector<QPointF> samples( numPoints );
+
+    double value = 0.0;
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        const double key = 1000.0 * i / numPoints;
+
+        value += 2.0 * random01() - 1.0;
+        value = qBound( -100.0, value, 100.0 );
+
+        double v = value;
+        if ( ( i / 1000 ) % 7 == 3 && i % 1000 < 50 )
+            v = qQNaN();
+
+        samples[i] = columns ? QPointF( key, v ) : QPointF( v, key );
+    }
+
+    return samples;
+}
+
+/*
+   The aggregated polyline has to be a subsequence of the mapped polyline,
+   where each sequence of points being mapped to the same pixel column ( row )
+   is reduced to 4 points at most, including its first and last point and
+   the points with the minimum and maximum values. Then the lines cover
+   exactly the same pixels as the lines between all points.
+ */
+static void verifyM4( bool columns, const QVector<QPointF> &mapped,
+    const QPolygonF &polyline, const char *prompt )
+{
+    int j = 0; // index in polyline
+    bool inGap = false;
+
+    int i = 0;
+    while ( i < mapped.size() )
+    {
+        if ( isGap( mapped[i] ) )
+        {
+            if ( !inGap )
+            {
+                if ( j >= polyline.size() || !isGap( polyline[j] ) )
+                {
+                    qDebug() << prompt << ": missing gap at" << i;
+                    numErrors++;
+                    return;
+                }
+
+                j++;
+                inGap = true;
+            }
+
+            i++;
+            continue;
+        }
+
+        inGap = false;
+
+        // the sequence of points in the same pixel column/row
+
+        const double key = roundValue( columns ? mapped[i].x() : mapped[i].y() );
+
+        int end = i + 1;
+        while ( end < mapped.size() && !isGap( mapped[end] )
+            && roundValue( columns ? mapped[end].x() : mapped[end].y() ) == key )
+        {
+            end++;
+        }
+
+        double min = qInf();
+        double max = -qInf();
+
+        for ( int k = i; k < end; k++ )
+        {
+            const double v = columns ? mapped[k].y() : mapped[k].x();
+
+            min = qMin( min, v );
+            max = qMax( max, v );
+        }
+
+        // the points of the sequence, that have been kept
+
+        QVector<QPointF> kept;
+        for ( int k = i; k < end && j < polyline.size(); k++ )
+        {
+            if ( isEqual( mapped[k], polyline[j] ) )
+            {
+                kept += polyline[j];
+                j++;
+            }
+        }
+
+        double keptMin = qInf();
+        double keptMax = -qInf();
+
+        for ( int k = 0; k < kept.size(); k++ )
+        {
+            const double v = columns ? kept[k].y() : kept[k].x();
+
+            keptMin = qMin( keptMin, v );
+            keptMax = qMax( keptMax, v );
+        }
+
+        if ( kept.isEmpty() || kept.size() > 4
+            || !isEqual( kept.first(), mapped[i] )
+            || !isEqual( kept.last(), mapped[end - 1] )
+            || keptMin != min || keptMax != max )
+        {
+            qDebug() << prompt << ": wrong aggregation of the points" << i << "-" << end - 1;
+            numErrors++;
+            return;
+        }
+
+        i = end;
+    }
+
+    if ( j != polyline.size() )
+    {
+        qDebug() << prompt << ": unexpected points at the end";
+        numErrors++;
+    }
+}
+
+static void testM4( bool columns, uint numThreads )
+{
+    const char *prompt = columns ? "AggregateColumns" : "AggregateRows";
+
+    const int numPoints = 100000;
+    const QwtPointSeriesData series( createSamples( columns, numPoints ) );
+
+    // 200 points per pixel
+
+    QwtScaleMap keyMap;
+    keyMap.setScaleInterval( 0.0, 1000.0 );
+    keyMap.setPaintInterval( 0.0, 500.0 );
+
+    QwtScaleMap valueMap;
+    valueMap.setScaleInterval( -100.0, 100.0 );
+    valueMap.setPaintInterval( 300.0, 0.0 );
+
+    const QwtScaleMap &xMap = columns ? keyMap : valueMap;
+    const QwtScaleMap &yMap = columns ? valueMap : keyMap;
+
+    // the points mapped the same way as QwtPointMapper does
+
+    QVector<double> x( numPoints );
+    QVector<double> y( numPoints );
+
+    for ( int i = 0; i < numPoints; i++ )
+    {
+        x[i] = series.sample( i ).x();
+        y[i] = series.sample( i ).y();
+    }
+
+    xMap.transform( x.constData(), x.data(), numPoints );
+    yMap.transform( y.constData(), y.data(), numPoints );
+
+    QVector<QPointF> mapped( numPoints );
+    for ( int i = 0; i < numPoints; i++ )
+        mapped[i] = QPointF( x[i], y[i] );
+
+    QwtPointMapper mapper;
+    mapper.setFlag( columns ? QwtPointMapper::AggregateColumns
+        : QwtPointMapper::AggregateRows );
+    mapper.setThreadCount( numThreads );
+
+    const QPolygonF polyline = mapper.toPolygonF(
+        xMap, yMap, &series, 0, numPoints - 1 );
+
+    verifyM4( columns, mapped, polyline, prompt );
+
+    int numGaps = 0;
+    for ( int i = 0; i < polyline.size(); i++ )
+    {
+        if ( isGap( polyline[i] ) )
+            numGaps++;
+    }
+
+    if ( mapper.numEliminatedPoints() != numPoints - ( polyline.size() - numGaps ) )
+    {
+        qDebug() << prompt << ": wrong number of eliminated points";
+        numErrors++;
+    }
+}
+
+int main()
+{
+    // also verifying, that the chunks of parallel threads are merged
+
+    const uint threadCounts[] = { 1, 4 };
+
+    for ( int i = 0; i < 2; i++ )
+    {
+        testM4( true, threadCounts[i] );
+        testM4( false, threadCounts[i] );
+    }
+
+    if ( numErrors > 0 )
+    {
+        qDebug() << numErrors << "tests failed.";
+        return 1;
+    }
+
+    return 0;
+}
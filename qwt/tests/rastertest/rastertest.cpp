@@ -0,0 +1,279 @@
+#include <qwt_matrix_raster_data.h>
+#include <qwt_interval.h>
+
+#include <qvector.h>
+#include <qsize.h>
+#include <qstring.h>
+#include <qnumeric.h>
+#include <qdebug.h>
+
+#include <cmath>
+
+static int numErrors = 0;
+
+// deterministic pseudo random numbers in [0.0, 1.0[
+static double random01()
+{
+    static quint32 seed = 4711;
+    seed = seed * 1664525u + 1013904223u;
+
+    return ( seed >> 8 ) / double( 1 << 24 );
+}
+
+static inline bool isEqual( double v1, double v2, double tolerance )
+{
+    if ( qIsNaN( v1 ) || qIsNaN( v2 ) )
+        return qIsNaN( v1 ) && qIsNaN( v2 );
+
+    return std::fabs( v1 - v2 ) <= tolerance;
+}
+
+static const char *modeName( QwtMatrixRasterData::ResampleMode mode )
+{
+    switch( mode )
+    {
+        case QwtMatrixRasterData::BilinearInterpolation:
+            return "Bilinear";
+        case QwtMatrixRasterData::BicubicInterpolation:
+            return "Bicubic";
+        default:
+            return "NearestNeighbour";
+    }
+}
+
+static const char *typeName( QwtMatrixRasterData::ValueType type )
+{
+    switch( type )
+    {
+        case QwtMatrixRasterData::Float:
+            return "Float";
+        case QwtMatrixRasterData::Int16:
+            return "Int16";
+        case QwtMatrixRasterData::UInt16:
+            return "UInt16";
+        default:
+            return "Double";
+    }
+}
+
+/*
+   A class reimplementing value() has to reimplement values()
+   and blockValues() too. Here the implementations of QwtRasterData
+   are used, that call value() for each position.
+ */
+class OffsetRasterData: public QwtMatrixRasterData
+{
+public:
+    virtual double value( double x, double y ) const QWT_OVERRIDE
+    {
+        return QwtMatrixRasterData::value( x, y ) + 1.0;
+    }
+
+    virtual void values( const double *x, double y,
+        double *result, int count ) const QWT_OVERRIDE
+    {
+        QwtRasterData::values( x, y, result, count );
+    }
+
+    virtual void blockValues( const double *x, int numX,
+        const double *y, int numY, double *result ) const QWT_OVERRIDE
+    {
+        QwtRasterData::blockValues( x, numX, y, numY, result );
+    }
+};
+
+/*
+   Positions on and between the matrix points, on the borders
+   and outside of the intervals
+ */
+static QVector<double> positions( const QwtInterval &interval, int numPoints )
+{
+    const double step = interval.width() / numPoints;
+
+    QVector<double> pos;
+    pos += interval.minValue() - step;
+    pos += interval.minValue() - 1e-9;
+
+    for ( int i = 0; i <= 4 * numPoints; i++ )
+        pos += interval.minValue() + 0.25 * i * step;
+
+    for ( int i = 0; i < 100; i++ )
+        pos += interval.minValue() + random01() * interval.width();
+
+    pos += interval.maxValue() + 1e-9;
+    pos += interval.maxValue() + step;
+
+    return pos;
+}
+
+static void setValues( QwtMatrixRasterData &data,
+    QwtMatrixRasterData::ValueType type, int numColumns, int numRows )
+{
+    QVector<double> values( numColumns * numRows );
+    for ( int i = 0; i < values.size(); i++ )
+        values[i] = qRound( 30000.0 * random01() ) - 15000;
+
+    switch( type )
+    {
+        case QwtMatrixRasterData::Float:
+        {
+            QVector<float> v( values.size() );
+            for ( int i = 0; i < v.size(); i++ )
+                v[i] = float( values[i] ) + 0.5f;
+
+            data.setValueMatrix( v, numColumns );
+            break;
+        }
+        case QwtMatrixRasterData::Int16:
+        {
+            QVector<qint16> v( values.size() );
+            for ( int i = 0; i < v.size(); i++ )
+                v[i] = qint16( values[i] );
+
+            data.setValueMatrix( v, numColumns );
+            break;
+        }
+        case QwtMatrixRasterData::UInt16:
+        {
+            QVector<quint16> v( values.size() );
+            for ( int i = 0; i < v.size(); i++ )
+                v[i] = quint16( values[i] + 15000 );
+
+            data.setValueMatrix( v, numColumns );
+            break;
+        }
+        default:
+        {
+            for ( int i = 0; i < values.size(); i++ )
+                values[i] += random01();
+
+            data.setValueMatrix( values, numColumns );
+        }
+    }
+}
+
+static void testBatch( const QwtMatrixRasterData &data, const QString &prompt )
+{
+    const int numColumns = data.numColumns();
+    const int numRows = data.numRows();
+
+    const QVector<double> x = positions( data.interval( Qt::XAxis ), numColumns );
+    const QVector<double> y = positions( data.interval( Qt::YAxis ), numRows );
+
+    // the values are in [-15000, 45000]
+    const double tolerance = 1e-9;
+
+    QVector<double> rowValues( x.size() );
+    for ( int j = 0; j < y.size(); j++ )
+    {
+        data.values( x.constData(), y[j], rowValues.data(), x.size() );
+
+        for ( int i = 0; i < x.size(); i++ )
+        {
+            const double v = data.value( x[i], y[j] );
+            if ( !isEqual( rowValues[i], v, tolerance ) )
+            {
+                qDebug() << qPrintable( prompt ) << "values()"
+                    << x[i] << y[j] << ":" << rowValues[i] << "!=" << v;
+
+                numErrors++;
+                return;
+            }
+        }
+    }
+
+    // blocks of different heights, also splitting the rows
+
+    const int blockSizes[] = { 1, 3, 16, y.size() };
+
+    for ( size_t k = 0; k < sizeof( blockSizes ) / sizeof( blockSizes[0] ); k++ )
+    {
+        for ( int j0 = 0; j0 < y.size(); j0 += blockSizes[k] )
+        {
+            const int numY = qMin( blockSizes[k], y.size() - j0 );
+
+            QVector<double> blockValues( numY * x.size() );
+            data.blockValues( x.constData(), x.size(),
+                y.constData() + j0, numY, blockValues.data() );
+
+            for ( int j = 0; j < numY; j++ )
+            {
+                for ( int i = 0; i < x.size(); i++ )
+                {
+                    const double v1 = blockValues[ j * x.size() + i ];
+                    const double v2 = data.value( x[i], y[j0 + j] );
+
+                    if ( !isEqual( v1, v2, tolerance ) )
+                    {
+                        qDebug() << qPrintable( prompt ) << "blockValues()"
+                            << blockSizes[k] << x[i] << y[j0 + j] << ":"
+                            << v1 << "!=" << v2;
+
+                        numErrors++;
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void testMatrix( QwtMatrixRasterData &data, const char *className )
+{
+    const QwtMatrixRasterData::ResampleMode modes[] =
+    {
+        QwtMatrixRasterData::NearestNeighbour,
+        QwtMatrixRasterData::BilinearInterpolation,
+        QwtMatrixRasterData::BicubicInterpolation
+    };
+
+    const QwtMatrixRasterData::ValueType types[] =
+    {
+        QwtMatrixRasterData::Double,
+        QwtMatrixRasterData::Float,
+        QwtMatrixRasterData::Int16,
+        QwtMatrixRasterData::UInt16
+    };
+
+    // including matrices, that are too small for bicubic interpolation
+    const QSize sizes[] = { QSize( 1, 1 ), QSize( 2, 3 ), QSize( 17, 11 ) };
+
+    for ( int m = 0; m < 3; m++ )
+    {
+        for ( int t = 0; t < 4; t++ )
+        {
+            for ( int s = 0; s < 3; s++ )
+            {
+                setValues( data, types[t], sizes[s].width(), sizes[s].height() );
+
+                data.setInterval( Qt::XAxis, QwtInterval( -3.0, 5.0 ) );
+                data.setInterval( Qt::YAxis, QwtInterval( 10.0, 12.5 ) );
+                data.setResampleMode( modes[m] );
+
+                const QString prompt = QString( "%1 %2 %3 %4x%5" )
+                    .arg( className ).arg( modeName( modes[m] ) )
+                    .arg( typeName( types[t] ) )
+                    .arg( sizes[s].width() ).arg( sizes[s].height() );
+
+                testBatch( data, prompt );
+            }
+        }
+    }
+}
+
+int main()
+{
+    QwtMatrixRasterData data;
+    testMatrix( data, "QwtMatrixRasterData" );
+
+    OffsetRasterData offsetData;
+    testMatrix( offsetData, "OffsetRasterData" );
+
+    if ( numErrors > 0 )
+    {
+        qDebug() << numErrors << "tests failed.";
+        return 1;
+    }
+
+    return 0;
+}
@@ -13,4 +13,9 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     splinetest \
-    splineprof
+    splineprof \
+    rastertest \
+    appendabletest \
+    lockfreetest \
+    mappertest \
+    contourtest